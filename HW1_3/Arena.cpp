@@ -0,0 +1,169 @@
+/**
+* File:		Arena.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for an Arena class, a monotonic memory resource, and for ArenaScope,
+*			that sets the current arena of a thread.
+*/
+
+#include "Arena.hpp"
+#include <cstdint>
+
+// the current arena of each thread
+static thread_local Arena* currentArena = nullptr;
+
+// no blocks until the first allocation
+Arena::Arena() : m_policy(), m_next(nullptr), m_nextBlockSize(INITIAL_BLOCK_SIZE), m_allocated(0), m_reserved(0) {
+
+}
+
+// no blocks until the first allocation, then mapped with the policy
+Arena::Arena(const PageAllocator::Policy& policy) :
+	m_policy(policy),
+	m_next(nullptr),
+	m_nextBlockSize(initialBlockSize()),
+	m_allocated(0),
+	m_reserved(0) {
+
+}
+
+// release all blocks
+Arena::~Arena() {
+	release();
+}
+
+// bump allocate from the last block, reserving a new block when it is full
+void* Arena::allocate(size_t size, size_t alignment) {
+	if (!m_blocks.empty()) {
+		std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_next);
+		std::uintptr_t aligned = (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+		char* result = reinterpret_cast<char*>(aligned);
+
+		if (result + size <= m_blocks.back().end && result >= m_next) {
+			m_next = result + size;
+			m_allocated += size;
+			return result;
+		}
+	}
+
+	// new block, large enough for this request even if it is bigger than the block size
+	size_t blockSize = m_nextBlockSize;
+	if (blockSize < size + alignment) {
+		blockSize = size + alignment;
+	}
+
+	// mapped blocks are whole huge pages, the pages are not touched until they are allocated from
+	Block block;
+	block.mapped = m_policy.mapped();
+	if (block.mapped) {
+		blockSize = PageAllocator::roundUp(blockSize);
+	}
+
+	// the block is charged to the current budget before it is taken, and refunded when it is released
+	block.budget = Budget::current();
+	if (block.budget != nullptr) {
+		block.budget->charge(blockSize);
+	}
+
+	try {
+		if (block.mapped) {
+			block.begin = static_cast<char*>(PageAllocator::allocate(blockSize, m_policy));
+		}
+		else {
+			block.begin = static_cast<char*>(::operator new(blockSize));
+		}
+	}
+	catch (...) {
+		if (block.budget != nullptr) {
+			block.budget->refund(blockSize);
+		}
+		throw;
+	}
+	block.end = block.begin + blockSize;
+	m_blocks.push_back(block);
+	m_reserved += blockSize;
+
+	if (m_nextBlockSize < MAXIMUM_BLOCK_SIZE) {
+		m_nextBlockSize *= 2;
+	}
+
+	std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block.begin);
+	std::uintptr_t aligned = (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+	char* result = reinterpret_cast<char*>(aligned);
+
+	m_next = result + size;
+	m_allocated += size;
+	return result;
+}
+
+// return every block to the heap, or unmap it, and refund its budget
+void Arena::release() {
+	for (size_t i = 0; i < m_blocks.size(); i++) {
+		size_t blockSize = static_cast<size_t>(m_blocks[i].end - m_blocks[i].begin);
+
+		if (m_blocks[i].mapped) {
+			PageAllocator::release(m_blocks[i].begin, blockSize);
+		}
+		else {
+			::operator delete(m_blocks[i].begin);
+		}
+
+		if (m_blocks[i].budget != nullptr) {
+			m_blocks[i].budget->refund(blockSize);
+		}
+	}
+
+	m_blocks.clear();
+	m_next = nullptr;
+	m_nextBlockSize = initialBlockSize();
+	m_allocated = 0;
+	m_reserved = 0;
+}
+
+// search the blocks for the pointer, blocks grow geometrically so there are few of them
+bool Arena::owns(const void* pointer) const {
+	const char* p = static_cast<const char*>(pointer);
+
+	for (size_t i = 0; i < m_blocks.size(); i++) {
+		if (p >= m_blocks[i].begin && p < m_blocks[i].end) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// bytes handed out
+size_t Arena::bytesAllocated() const {
+	return m_allocated;
+}
+
+// bytes reserved in blocks
+size_t Arena::bytesReserved() const {
+	return m_reserved;
+}
+
+// pages and placement of the blocks
+const PageAllocator::Policy& Arena::policy() const {
+	return m_policy;
+}
+
+// current arena of the calling thread
+Arena* Arena::current() {
+	return currentArena;
+}
+
+// a huge page is the least a mapped block can be
+size_t Arena::initialBlockSize() const {
+	return m_policy.mapped() ? PageAllocator::HUGE_PAGE_SIZE : INITIAL_BLOCK_SIZE;
+}
+
+// make the arena current, remembering the previous one
+ArenaScope::ArenaScope(Arena& arena) : m_previous(currentArena) {
+	currentArena = &arena;
+}
+
+// restore the previous arena
+ArenaScope::~ArenaScope() {
+	currentArena = m_previous;
+}
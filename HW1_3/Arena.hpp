@@ -0,0 +1,242 @@
+/**
+* File:		Arena.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for an Arena class, a monotonic memory resource that hands out memory
+*			from large blocks and releases everything at once, and for ArenaAllocator, the allocator used by File.
+*
+*			Each thread has a current arena, set with an ArenaScope. An ArenaAllocator takes the current arena of
+*			the thread that creates it, or the global heap when there is none, so a whole run (the File, the copies
+*			made while printing, the C-string arrays) can be placed in one arena without changing any signatures.
+*			The words themselves stay std::string with the standard allocator: the arena holds each word's
+*			string object, with the characters of short words inline, but the characters of a word longer than
+*			the small string buffer are on the heap.
+*			An arena is not shared between threads: give each worker thread its own, which is what removes the
+*			contention on the global heap when many Files are processed at once.
+*
+*			An arena given a PageAllocator policy maps its blocks, each a whole number of huge pages, instead of
+*			taking them from the heap, so a large File can sit on huge pages or be interleaved over NUMA nodes.
+*
+*			Memory is charged to the current Budget, if any: an arena charges each block as it reserves it and
+*			refunds it when it is released, and an ArenaAllocator using the heap charges what it allocates to
+*			the budget current when it was created, refunding it as it is freed. The allocator also charges the
+*			characters of each word it constructs that are held on the heap, by the word's own std::string, and
+*			refunds them when the word is destroyed. A word moved within a container keeps its charge.
+*/
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+// includes
+#include "Budget.hpp"
+#include "PageAllocator.hpp"
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// class definition
+class Arena {
+public:
+	// size of the first block, later blocks double in size up to the maximum
+	static const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+	static const size_t MAXIMUM_BLOCK_SIZE = 16 * 1024 * 1024;
+
+	// constructor/destructor, the destructor releases all memory
+	Arena();
+	// blocks are mapped with the policy's pages and placement when it asks for any
+	explicit Arena(const PageAllocator::Policy& policy);
+	virtual ~Arena();
+
+	// allocate size bytes with the given alignment, never returns null, throws std::bad_alloc
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// release all memory allocated from this arena
+	void release();
+
+	// true if the pointer was allocated from this arena
+	bool owns(const void* pointer) const;
+
+	// bytes handed out by allocate since construction or the last release
+	size_t bytesAllocated() const;
+	// bytes reserved from the heap for blocks
+	size_t bytesReserved() const;
+
+	// how blocks are obtained
+	const PageAllocator::Policy& policy() const;
+
+	// the current arena of the calling thread, or null
+	static Arena* current();
+
+private:
+	// not copyable
+	Arena(const Arena&);
+	Arena& operator=(const Arena&);
+
+	// a block of memory obtained from the heap, or mapped
+	struct Block {
+		char* begin;
+		char* end;
+		bool mapped;
+		// budget charged for the block, or null
+		Budget* budget;
+	};
+
+	// size of the first block, a huge page when blocks are mapped
+	size_t initialBlockSize() const;
+
+	// how blocks are obtained
+	PageAllocator::Policy m_policy;
+
+	// blocks, the last one is being allocated from
+	std::vector<Block> m_blocks;
+	// next free byte in the last block
+	char* m_next;
+	// size of the next block to reserve
+	size_t m_nextBlockSize;
+	size_t m_allocated;
+	size_t m_reserved;
+}; // end class Arena
+
+// makes an arena the current arena of the calling thread for the lifetime of the scope
+class ArenaScope {
+public:
+	explicit ArenaScope(Arena& arena);
+	virtual ~ArenaScope();
+
+private:
+	// not copyable
+	ArenaScope(const ArenaScope&);
+	ArenaScope& operator=(const ArenaScope&);
+
+	// arena that was current before this scope
+	Arena* m_previous;
+}; // end class ArenaScope
+
+// allocator that allocates from the arena current when it was created, or the heap if there was none
+// heap memory is charged to the budget current when it was created, arena memory is charged by the arena
+// deallocation of arena memory does nothing, the memory is reclaimed when the arena is released
+template <class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	// copies made by containers pick up the current arena of the copying thread
+	typedef std::false_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	// takes the current arena and budget of the calling thread
+	ArenaAllocator() : m_arena(Arena::current()), m_budget(Budget::current()) {
+	}
+
+	// allocate from the specified arena, or the heap if null, charging the specified budget, if any
+	explicit ArenaAllocator(Arena* arena, Budget* budget = nullptr) : m_arena(arena), m_budget(budget) {
+	}
+
+	// rebinding copy
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.arena()), m_budget(other.budget()) {
+	}
+
+	// allocate storage for n objects, heap memory is charged first so a job over budget allocates nothing
+	T* allocate(size_t n) {
+		if (m_arena != nullptr) {
+			return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+		}
+		if (m_budget != nullptr) {
+			m_budget->charge(n * sizeof(T));
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	// release storage, a no-op for arena memory
+	void deallocate(T* pointer, size_t n) {
+		if (m_arena == nullptr) {
+			if (m_budget != nullptr) {
+				m_budget->refund(n * sizeof(T));
+			}
+			::operator delete(pointer);
+		}
+	}
+
+	// construct an object, charging the characters it holds on the heap
+	template <class U, class... Args>
+	void construct(U* pointer, Args&&... args) {
+		::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+
+		if (m_budget != nullptr) {
+			size_t bytes = heapBytes(*pointer);
+			if (bytes > 0) {
+				try {
+					m_budget->charge(bytes);
+				}
+				catch (...) {
+					pointer->~U();
+					throw;
+				}
+			}
+		}
+	}
+
+	// a word moved from another element takes its characters, and their charge, with it
+	void construct(std::string* pointer, std::string&& word) {
+		::new (static_cast<void*>(pointer)) std::string(std::move(word));
+	}
+
+	// destroy an object, refunding the characters it held on the heap
+	template <class U>
+	void destroy(U* pointer) {
+		if (m_budget != nullptr) {
+			m_budget->refund(heapBytes(*pointer));
+		}
+		pointer->~U();
+	}
+
+	// container copies allocate from the arena current at the time of the copy
+	ArenaAllocator select_on_container_copy_construction() const {
+		return ArenaAllocator();
+	}
+
+	// arena allocated from, null for the heap
+	Arena* arena() const {
+		return m_arena;
+	}
+
+	// budget charged, null for none
+	Budget* budget() const {
+		return m_budget;
+	}
+
+private:
+	// characters a word holds on the heap, nothing for other objects
+	static size_t heapBytes(const std::string& word) {
+		return Budget::heapBytes(word);
+	}
+	template <class V>
+	static size_t heapBytes(const std::pair<const std::string, V>& entry) {
+		return Budget::heapBytes(entry.first);
+	}
+	template <class U>
+	static size_t heapBytes(const U&) {
+		return 0;
+	}
+
+	Arena* m_arena;
+	Budget* m_budget;
+}; // end class ArenaAllocator
+
+// allocators are interchangeable when they use the same arena and charge the same budget
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+	return a.arena() == b.arena() && a.budget() == b.budget();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+	return !(a == b);
+}
+
+#endif
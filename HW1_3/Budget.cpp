@@ -0,0 +1,139 @@
+/**
+* File:		Budget.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a Budget class, the time and memory limits of a job, and for
+*			BudgetScope, that sets the current budget of a thread.
+*/
+
+#include "Budget.hpp"
+#include <algorithm>
+
+// the current budget of each thread
+static thread_local Budget* currentBudget = nullptr;
+
+// pass the message on
+BudgetExceeded::BudgetExceeded(const std::string& message) : std::runtime_error(message) {
+
+}
+
+// no limits
+Budget::Budget() : m_cancelled(false), m_hasDeadline(false), m_deadline(), m_memoryLimit(UNLIMITED), m_charged(0), m_peak(0) {
+
+}
+
+// empty
+Budget::~Budget() {
+
+}
+
+// deadline from now
+void Budget::setTimeout(std::chrono::milliseconds timeout) {
+	m_deadline = std::chrono::steady_clock::now() + timeout;
+	m_hasDeadline = true;
+}
+
+// memory limit
+void Budget::setMemoryLimit(size_t bytes) {
+	m_memoryLimit = bytes;
+}
+
+// set the flag, a lock free atomic store is safe in a signal handler
+void Budget::cancel() {
+	m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+// flag
+bool Budget::cancelled() const {
+	return m_cancelled.load(std::memory_order_relaxed);
+}
+
+// the flag first, it costs less than reading the clock
+void Budget::check() const {
+	if (cancelled()) {
+		throw BudgetExceeded("Cancelled");
+	}
+	if (m_hasDeadline && std::chrono::steady_clock::now() > m_deadline) {
+		throw BudgetExceeded("Deadline exceeded");
+	}
+}
+
+// add the bytes, taking them back if they went over the limit
+void Budget::charge(size_t bytes) {
+	size_t charged = m_charged.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	if (charged > m_memoryLimit || charged < bytes) {
+		m_charged.fetch_sub(bytes, std::memory_order_relaxed);
+		throw BudgetExceeded("Memory budget of " + std::to_string(m_memoryLimit / 1024) + " KB exceeded");
+	}
+
+	size_t peak = m_peak.load(std::memory_order_relaxed);
+	while (charged > peak && !m_peak.compare_exchange_weak(peak, charged, std::memory_order_relaxed)) {
+		// peak reloaded, try again
+	}
+}
+
+// subtract the bytes, a word that grew in place after it was charged can refund more than was charged, which
+// leaves nothing charged rather than wrapping around
+void Budget::refund(size_t bytes) {
+	size_t charged = m_charged.load(std::memory_order_relaxed);
+	while (!m_charged.compare_exchange_weak(charged, charged - std::min(charged, bytes), std::memory_order_relaxed)) {
+		// charged reloaded, try again
+	}
+}
+
+// room left
+bool Budget::fits(size_t bytes) const {
+	return bytes <= m_memoryLimit - std::min(m_memoryLimit, bytesCharged());
+}
+
+// a word in the inline buffer has its characters inside the object
+size_t Budget::heapBytes(const std::string& word) {
+	const char* data = word.data();
+	const char* object = reinterpret_cast<const char*>(&word);
+	if (data >= object && data < object + sizeof(std::string)) {
+		return 0;
+	}
+	return word.capacity() + 1;
+}
+
+// bytes charged now
+size_t Budget::bytesCharged() const {
+	return m_charged.load(std::memory_order_relaxed);
+}
+
+// most bytes charged at once
+size_t Budget::peakBytes() const {
+	return m_peak.load(std::memory_order_relaxed);
+}
+
+// limit
+size_t Budget::memoryLimit() const {
+	return m_memoryLimit;
+}
+
+// current budget of the calling thread
+Budget* Budget::current() {
+	return currentBudget;
+}
+
+// nothing to check without a budget
+void Budget::checkpoint() {
+	if (currentBudget != nullptr) {
+		currentBudget->check();
+	}
+}
+
+// anything fits without a budget
+bool Budget::allows(size_t bytes) {
+	return currentBudget == nullptr || currentBudget->fits(bytes);
+}
+
+// make the budget current, remembering the previous one
+BudgetScope::BudgetScope(Budget* budget) : m_previous(currentBudget) {
+	currentBudget = budget;
+}
+
+// restore the previous budget
+BudgetScope::~BudgetScope() {
+	currentBudget = m_previous;
+}
@@ -0,0 +1,114 @@
+/**
+* File:		Budget.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a Budget class, the limits a job runs under: a deadline, the
+*			most memory it may hold, and a cancellation flag any thread can set. Work checks its budget
+*			cooperatively, and a job over budget stops with a BudgetExceeded exception instead of running to
+*			completion.
+*
+*			Like an arena, a budget is made current on a thread with a BudgetScope. Ingestion checks it at each
+*			block or line read, and every print mode at each batch of words its WordEmitter writes, so a job
+*			that is cancelled or out of time stops within a block or a batch. Memory is charged through
+*			ArenaAllocator and Arena, see Arena.hpp, which covers the storage of every File layout, the
+*			characters of words too long for std::string's inline buffer, and the copies made while printing.
+*			The ARRAY backend has no allocator, so its words' characters are charged as they are stored and
+*			stay charged. A charge that would go over the limit throws before the memory is taken, and C-string
+*			arrays, which are not charged, are refused before they are allocated if they would not fit.
+*
+*			Work that can be done in less memory asks first with allows, as the FORWARD_LIST backward print
+*			modes do: when their reversed copy would not fit they walk the list a chunk at a time instead.
+*/
+
+#ifndef BUDGET_HPP
+#define BUDGET_HPP
+
+// includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+// thrown when a job is cancelled, runs out of time or would go over its memory limit
+class BudgetExceeded : public std::runtime_error {
+public:
+	explicit BudgetExceeded(const std::string& message);
+}; // end class BudgetExceeded
+
+// class definition
+class Budget {
+public:
+	// no memory limit
+	static const size_t UNLIMITED = static_cast<size_t>(-1);
+
+	// constructor/destructor, no deadline, no memory limit and not cancelled
+	Budget();
+	virtual ~Budget();
+
+	// the job must be done within timeout of now
+	void setTimeout(std::chrono::milliseconds timeout);
+	// the job may hold at most bytes
+	void setMemoryLimit(size_t bytes);
+
+	// ask the job to stop at its next check, safe to call from any thread or a signal handler
+	void cancel();
+	// true once cancel was called
+	bool cancelled() const;
+
+	// throws BudgetExceeded if the job was cancelled or its deadline has passed
+	void check() const;
+
+	// account for bytes about to be allocated, throws BudgetExceeded, charging nothing, if they go over the limit
+	void charge(size_t bytes);
+	// account for bytes freed, never below nothing charged
+	void refund(size_t bytes);
+	// true if bytes more can be charged
+	bool fits(size_t bytes) const;
+
+	// bytes the word holds on the heap, outside the std::string itself, 0 for a word in the inline buffer
+	static size_t heapBytes(const std::string& word);
+
+	// bytes charged now, and the most ever charged at once
+	size_t bytesCharged() const;
+	size_t peakBytes() const;
+	// the memory limit, UNLIMITED if there is none
+	size_t memoryLimit() const;
+
+	// the current budget of the calling thread, or null
+	static Budget* current();
+	// check the current budget of the calling thread, if there is one
+	static void checkpoint();
+	// true if the current budget of the calling thread, if there is one, can take bytes more
+	static bool allows(size_t bytes);
+
+private:
+	// not copyable
+	Budget(const Budget&);
+	Budget& operator=(const Budget&);
+
+	std::atomic<bool> m_cancelled;
+	bool m_hasDeadline;
+	std::chrono::steady_clock::time_point m_deadline;
+	size_t m_memoryLimit;
+	std::atomic<size_t> m_charged;
+	std::atomic<size_t> m_peak;
+}; // end class Budget
+
+// makes a budget the current budget of the calling thread for the lifetime of the scope
+class BudgetScope {
+public:
+	// a null budget leaves the thread without one
+	explicit BudgetScope(Budget* budget);
+	virtual ~BudgetScope();
+
+private:
+	// not copyable
+	BudgetScope(const BudgetScope&);
+	BudgetScope& operator=(const BudgetScope&);
+
+	// budget that was current before this scope
+	Budget* m_previous;
+}; // end class BudgetScope
+
+#endif
@@ -0,0 +1,587 @@
+/**
+* File:		CompressedReader.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a CompressedReader class, that decompresses gzip and zstd input
+*			streams on a background thread and hands decompressed blocks to the caller through a bounded queue.
+*			zstd frames that fit in the frame window, and whose headers record a decompressed size of at most
+*			the frame output limit, are decompressed in parallel by a pool of workers; the memory they take is
+*			charged to the caller's budget until they are delivered. Any other frame is streamed through a
+*			single decompression context, so memory use stays bounded whatever a frame header claims.
+*/
+
+#include "CompressedReader.hpp"
+#include "Budget.hpp"
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#ifdef FILEFACTORY_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef FILEFACTORY_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// bounded queue of decompressed blocks, between the decompressing thread and the consumer
+// buffers handed back by the consumer are recycled to the producer, so blocks are not reallocated
+class BlockQueue {
+public:
+	explicit BlockQueue(size_t capacity) : m_capacity(capacity), m_finished(false), m_cancelled(false) {
+	}
+
+	// move block into the queue, block receives a recycled buffer, returns false if the consumer has stopped
+	bool push(std::string& block) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_notFull.wait(lock, [this]() { return m_blocks.size() < m_capacity || m_cancelled; });
+
+		if (m_cancelled) {
+			return false;
+		}
+
+		m_blocks.push_back(std::string());
+		m_blocks.back().swap(block);
+
+		if (!m_free.empty()) {
+			block.swap(m_free.back());
+			m_free.pop_back();
+		}
+
+		block.clear();
+
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	// move the next block into block, recycling its previous buffer, returns false when no blocks remain
+	bool pop(std::string& block) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (block.capacity() > 0) {
+			m_free.push_back(std::string());
+			m_free.back().swap(block);
+		}
+
+		m_notEmpty.wait(lock, [this]() { return !m_blocks.empty() || m_finished; });
+
+		if (m_blocks.empty()) {
+			return false;
+		}
+
+		block.swap(m_blocks.front());
+		m_blocks.pop_front();
+
+		m_notFull.notify_one();
+		return true;
+	}
+
+	// producer has pushed its last block
+	void finish() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finished = true;
+		m_notEmpty.notify_all();
+	}
+
+	// consumer has stopped, release a waiting producer
+	void cancel() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cancelled = true;
+		m_notFull.notify_all();
+	}
+
+private:
+	size_t m_capacity;
+	bool m_finished;
+	bool m_cancelled;
+	std::deque<std::string> m_blocks;
+	std::vector<std::string> m_free;
+	std::mutex m_mutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+}; // end class BlockQueue
+
+// empty
+CompressedReader::CompressedReader() {
+
+}
+
+// empty
+CompressedReader::~CompressedReader() {
+
+}
+
+// determine the format from the magic number at the start of the input
+CompressedReader::Format CompressedReader::detectFormat(const char* header, size_t length) {
+	const unsigned char* magic = reinterpret_cast<const unsigned char*>(header);
+
+	// gzip: 1f 8b
+	if (length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+		return GZIP;
+	}
+
+	// zstd: 28 b5 2f fd, little endian 0xFD2FB528
+	if (length >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+		return ZSTD;
+	}
+
+	return PLAIN;
+}
+
+// decompress on a producer thread, hand blocks to the handler on this thread
+void CompressedReader::read(std::istream& stream, const BlockHandler& handler, unsigned threads) {
+	// read enough of the input to recognize the format
+	std::string head(4, '\0');
+	stream.read(&head[0], head.size());
+	head.resize(static_cast<size_t>(stream.gcount()));
+
+	Format format = detectFormat(head.data(), head.size());
+
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+
+	// a few blocks in flight are enough to keep both sides busy
+	BlockQueue queue(4);
+	std::exception_ptr error;
+	// the producer works within the caller's budget
+	Budget* budget = Budget::current();
+
+	std::thread producer([&]() {
+		BudgetScope budgetScope(budget);
+		BlockPush push = [&queue](std::string& block) {
+			return queue.push(block);
+		};
+
+		try {
+			switch (format) {
+			case PLAIN:
+				readPlain(stream, head, push);
+				break;
+			case GZIP:
+				readGzip(stream, head, push);
+				break;
+			case ZSTD:
+				readZstd(stream, head, push, threads);
+				break;
+			}
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		queue.finish();
+	});
+
+	std::string block;
+
+	try {
+		// the caller's budget is checked before each block, a job stopped here stops the producer too
+		while (queue.pop(block)) {
+			Budget::checkpoint();
+			handler(block.data(), block.size());
+		}
+	}
+	catch (...) {
+		// stop the producer before leaving
+		queue.cancel();
+		producer.join();
+		throw;
+	}
+
+	producer.join();
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// pass uncompressed input through, in blocks
+void CompressedReader::readPlain(std::istream& stream, std::string& head, const BlockPush& push) {
+	std::string block;
+	block.swap(head);
+
+	while (stream) {
+		size_t used = block.size();
+		block.resize(BLOCK_SIZE);
+		stream.read(&block[used], BLOCK_SIZE - used);
+		block.resize(used + static_cast<size_t>(stream.gcount()));
+
+		if (block.size() == BLOCK_SIZE && !push(block)) {
+			return;
+		}
+	}
+
+	if (!block.empty()) {
+		push(block);
+	}
+}
+
+#ifdef FILEFACTORY_HAVE_ZLIB
+
+// inflate gzip input, member by member
+void CompressedReader::readGzip(std::istream& stream, std::string& head, const BlockPush& push) {
+	z_stream zs;
+	zs.zalloc = Z_NULL;
+	zs.zfree = Z_NULL;
+	zs.opaque = Z_NULL;
+	zs.next_in = Z_NULL;
+	zs.avail_in = 0;
+
+	// 15 bit window, gzip wrapper only
+	if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+		throw std::runtime_error("Unable to initialize gzip decompression");
+	}
+
+	std::vector<char> input(BLOCK_SIZE);
+	std::string block(BLOCK_SIZE, '\0');
+
+	zs.next_out = reinterpret_cast<Bytef*>(&block[0]);
+	zs.avail_out = static_cast<uInt>(block.size());
+
+	bool eof = false;
+	bool memberEnd = false;
+
+	try {
+		// the header bytes already read from the stream come first
+		memcpy(&input[0], head.data(), head.size());
+		zs.next_in = reinterpret_cast<Bytef*>(&input[0]);
+		zs.avail_in = static_cast<uInt>(head.size());
+
+		for (;;) {
+			// refill the input buffer
+			if (zs.avail_in == 0 && !eof) {
+				stream.read(&input[0], input.size());
+				zs.next_in = reinterpret_cast<Bytef*>(&input[0]);
+				zs.avail_in = static_cast<uInt>(stream.gcount());
+				eof = zs.avail_in == 0;
+			}
+
+			if (zs.avail_in == 0 && eof) {
+				// input may only end between members
+				if (!memberEnd) {
+					throw std::runtime_error("Truncated gzip input");
+				}
+				break;
+			}
+
+			// more input after the end of a member is the next member, except zero bytes, which are padding
+			// to a block size as tar and tape writers leave it, and are skipped as gzip does
+			if (memberEnd) {
+				while (zs.avail_in > 0 && *zs.next_in == 0) {
+					zs.next_in++;
+					zs.avail_in--;
+				}
+				if (zs.avail_in == 0) {
+					continue;
+				}
+				inflateReset(&zs);
+				memberEnd = false;
+			}
+
+			int ret = inflate(&zs, Z_NO_FLUSH);
+
+			if (ret == Z_STREAM_END) {
+				memberEnd = true;
+			}
+			else if (ret != Z_OK) {
+				throw std::runtime_error("Corrupt gzip input");
+			}
+
+			// hand over a full block
+			if (zs.avail_out == 0) {
+				if (!push(block)) {
+					inflateEnd(&zs);
+					return;
+				}
+
+				block.resize(BLOCK_SIZE);
+				zs.next_out = reinterpret_cast<Bytef*>(&block[0]);
+				zs.avail_out = static_cast<uInt>(block.size());
+			}
+		}
+	}
+	catch (...) {
+		inflateEnd(&zs);
+		throw;
+	}
+
+	inflateEnd(&zs);
+
+	// hand over the last partial block
+	block.resize(BLOCK_SIZE - zs.avail_out);
+	if (!block.empty()) {
+		push(block);
+	}
+}
+
+#else
+
+// gzip support not compiled in
+void CompressedReader::readGzip(std::istream&, std::string&, const BlockPush&) {
+	throw std::runtime_error("gzip input is not supported, build with FILEFACTORY_HAVE_ZLIB");
+}
+
+#endif
+
+#ifdef FILEFACTORY_HAVE_ZSTD
+
+// decompress zstd input
+// complete frames are found in the buffered input and decompressed in parallel, results are pushed in frame order
+// a frame that does not fit in the frame window, or whose header does not record a decompressed size within the
+// frame output limit, is streamed on this thread instead, with bounded memory
+void CompressedReader::readZstd(std::istream& stream, std::string& head, const BlockPush& push, unsigned threads) {
+	// largest compressed frame handed to a worker
+	const size_t FRAME_WINDOW = 8 * 1024 * 1024;
+	// largest decompressed frame handed to a worker
+	const size_t FRAME_OUTPUT_LIMIT = 32 * 1024 * 1024;
+
+	// shared worker state
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable resultReady;
+	std::deque<std::pair<size_t, std::string> > jobs;
+	std::map<size_t, std::string> results;
+	std::map<size_t, std::string> errors;
+	bool stopping = false;
+
+	// decompress whole frames taken from the job queue
+	std::vector<std::thread> workers;
+	for (unsigned w = 0; w < threads; w++) {
+		workers.push_back(std::thread([&]() {
+			ZSTD_DCtx* context = ZSTD_createDCtx();
+
+			for (;;) {
+				std::pair<size_t, std::string> job;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					jobReady.wait(lock, [&]() { return !jobs.empty() || stopping; });
+					if (stopping) {
+						break;
+					}
+					job.first = jobs.front().first;
+					job.second.swap(jobs.front().second);
+					jobs.pop_front();
+				}
+
+				std::string output;
+				std::string error;
+
+				if (context == NULL) {
+					error = "Unable to initialize zstd decompression";
+				}
+				else {
+					// size recorded in the frame header and within the limit, decompress in one call
+					output.resize(static_cast<size_t>(ZSTD_getFrameContentSize(job.second.data(), job.second.size())));
+					size_t ret = ZSTD_decompressDCtx(context, output.empty() ? NULL : &output[0], output.size(),
+						job.second.data(), job.second.size());
+					if (ZSTD_isError(ret)) {
+						error = ZSTD_getErrorName(ret);
+					}
+					output.resize(ZSTD_isError(ret) ? 0 : ret);
+				}
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (error.empty()) {
+					results[job.first].swap(output);
+				}
+				else {
+					errors[job.first] = error;
+					results[job.first] = std::string();
+				}
+				resultReady.notify_all();
+			}
+
+			ZSTD_freeDCtx(context);
+		}));
+	}
+
+	// decompressed sizes of the frames submitted and not yet delivered, charged to the budget
+	Budget* budget = Budget::current();
+	std::deque<size_t> charged;
+
+	// stop and join the workers, refunding the frames they will not deliver
+	auto stopWorkers = [&]() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			jobReady.notify_all();
+		}
+		for (size_t w = 0; w < workers.size(); w++) {
+			workers[w].join();
+		}
+		for (; !charged.empty(); charged.pop_front()) {
+			budget->refund(charged.front());
+		}
+	};
+
+	size_t submitted = 0;
+	size_t delivered = 0;
+	const size_t maxInFlight = 2 * static_cast<size_t>(threads);
+
+	std::string input;
+	input.swap(head);
+	size_t pos = 0;
+	bool eof = false;
+
+	// push the next finished frame, in order, returns false if the consumer has stopped
+	auto deliver = [&]() -> bool {
+		std::string output;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			resultReady.wait(lock, [&]() { return results.count(delivered) != 0; });
+			if (errors.count(delivered) != 0) {
+				throw std::runtime_error(errors[delivered]);
+			}
+			output.swap(results[delivered]);
+			results.erase(delivered);
+		}
+		delivered++;
+		if (budget != nullptr) {
+			budget->refund(charged.front());
+			charged.pop_front();
+		}
+		return output.empty() || push(output);
+	};
+
+	try {
+		for (;;) {
+			size_t frameSize = ZSTD_findFrameCompressedSize(input.data() + pos, input.size() - pos);
+
+			if (!ZSTD_isError(frameSize)) {
+				// a complete frame is buffered, hand it to a worker if its header records a size within the limit,
+				// ZSTD_CONTENTSIZE_UNKNOWN and ZSTD_CONTENTSIZE_ERROR are both larger than any limit
+				unsigned long long contentSize = ZSTD_getFrameContentSize(input.data() + pos, frameSize);
+				if (contentSize <= FRAME_OUTPUT_LIMIT) {
+					if (submitted - delivered >= maxInFlight && !deliver()) {
+						break;
+					}
+
+					if (budget != nullptr) {
+						budget->charge(static_cast<size_t>(contentSize));
+						charged.push_back(static_cast<size_t>(contentSize));
+					}
+
+					std::lock_guard<std::mutex> lock(mutex);
+					jobs.push_back(std::make_pair(submitted++, input.substr(pos, frameSize)));
+					pos += frameSize;
+					jobReady.notify_one();
+					continue;
+				}
+			}
+			else if (eof) {
+				if (pos != input.size()) {
+					throw std::runtime_error("Truncated or corrupt zstd input");
+				}
+				break;
+			}
+			else if (input.size() - pos < FRAME_WINDOW) {
+				// frame incomplete, read more input
+				input.erase(0, pos);
+				pos = 0;
+				size_t used = input.size();
+				input.resize(used + BLOCK_SIZE);
+				stream.read(&input[used], BLOCK_SIZE);
+				input.resize(used + static_cast<size_t>(stream.gcount()));
+				eof = stream.gcount() == 0;
+				continue;
+			}
+
+			// frame too large for a worker, finish the parallel frames before it then stream it here
+			while (delivered < submitted) {
+				if (!deliver()) {
+					stopWorkers();
+					return;
+				}
+			}
+
+			ZSTD_DStream* dstream = ZSTD_createDStream();
+			if (dstream == NULL) {
+				throw std::runtime_error("Unable to initialize zstd decompression");
+			}
+			ZSTD_initDStream(dstream);
+
+			std::string block(BLOCK_SIZE, '\0');
+			ZSTD_outBuffer out = { &block[0], block.size(), 0 };
+			size_t ret = 1;
+			bool stopped = false;
+
+			while (ret != 0) {
+				if (pos == input.size()) {
+					input.resize(BLOCK_SIZE);
+					stream.read(&input[0], BLOCK_SIZE);
+					input.resize(static_cast<size_t>(stream.gcount()));
+					pos = 0;
+					if (input.empty()) {
+						ZSTD_freeDStream(dstream);
+						throw std::runtime_error("Truncated zstd input");
+					}
+				}
+
+				ZSTD_inBuffer in = { input.data(), input.size(), pos };
+				ret = ZSTD_decompressStream(dstream, &out, &in);
+				pos = in.pos;
+
+				if (ZSTD_isError(ret)) {
+					ZSTD_freeDStream(dstream);
+					throw std::runtime_error(ZSTD_getErrorName(ret));
+				}
+
+				// hand over a full block, or the last part of the frame
+				if (out.pos == out.size || (ret == 0 && out.pos > 0)) {
+					block.resize(out.pos);
+					if (!push(block)) {
+						stopped = true;
+						break;
+					}
+					block.resize(BLOCK_SIZE);
+					out.dst = &block[0];
+					out.size = block.size();
+					out.pos = 0;
+				}
+			}
+
+			ZSTD_freeDStream(dstream);
+
+			if (stopped) {
+				stopWorkers();
+				return;
+			}
+		}
+
+		// push the remaining frames
+		while (delivered < submitted) {
+			if (!deliver()) {
+				break;
+			}
+		}
+	}
+	catch (...) {
+		stopWorkers();
+		throw;
+	}
+
+	stopWorkers();
+}
+
+#else
+
+// zstd support not compiled in
+void CompressedReader::readZstd(std::istream&, std::string&, const BlockPush&, unsigned) {
+	throw std::runtime_error("zstd input is not supported, build with FILEFACTORY_HAVE_ZSTD");
+}
+
+#endif
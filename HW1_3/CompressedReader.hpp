@@ -0,0 +1,61 @@
+/**
+* File:		CompressedReader.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a CompressedReader class, that decompresses gzip and zstd input
+*			streams natively and hands the decompressed data to a caller in blocks. Decompression runs on a
+*			separate thread from the caller so the two are pipelined, and zstd input made of several frames is
+*			decompressed in parallel across cores. Uncompressed input is passed through in blocks unchanged.
+*
+*			gzip support is compiled in when FILEFACTORY_HAVE_ZLIB is defined (link with zlib), and zstd support
+*			when FILEFACTORY_HAVE_ZSTD is defined (link with libzstd).
+*/
+
+#ifndef COMPRESSED_READER_HPP
+#define COMPRESSED_READER_HPP
+
+// includes
+#include <iostream>
+#include <functional>
+#include <string>
+#include <cstddef>
+
+// class definition
+class CompressedReader {
+public:
+	// input format enum
+	enum Format {
+		PLAIN, GZIP, ZSTD
+	};
+
+	// block handler, called with each decompressed block in order
+	typedef std::function<void(const char*, size_t)> BlockHandler;
+
+	// size of the blocks handed to the block handler
+	static const size_t BLOCK_SIZE = 256 * 1024;
+
+	// constructor/destructor
+	CompressedReader();
+	virtual ~CompressedReader();
+
+	// determine the format of the input from its first bytes
+	static Format detectFormat(const char* header, size_t length);
+
+	// decompress the stream, calling handler on the calling thread with each decompressed block, in order
+	// threads is the number of zstd frame decompression workers, 0 uses the number of hardware threads
+	// throws std::runtime_error on corrupt input or a format that is not compiled in
+	static void read(std::istream& stream, const BlockHandler& handler, unsigned threads = 0);
+
+private:
+	// producer function type, pushes decompressed blocks, push returns false if the consumer has stopped
+	typedef std::function<bool(std::string&)> BlockPush;
+
+	// pass plain input through in blocks
+	static void readPlain(std::istream& stream, std::string& head, const BlockPush& push);
+	// inflate gzip input, including files made of several gzip members
+	static void readGzip(std::istream& stream, std::string& head, const BlockPush& push);
+	// decompress zstd input, frames are decompressed in parallel
+	static void readZstd(std::istream& stream, std::string& head, const BlockPush& push, unsigned threads);
+}; // end class CompressedReader
+
+#endif
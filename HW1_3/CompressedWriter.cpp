@@ -0,0 +1,626 @@
+/**
+* File:		CompressedWriter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a CompressedWriter class, that writes sections as seekable gzip
+*			members. A section is cut into parts as it is rendered, and a full part is queued for a free worker
+*			only while fewer parts are queued than there are other workers to take them; otherwise the worker
+*			rendering it compresses it itself. So only a few uncompressed parts per worker are held at once.
+*
+*			Member layout:
+*				1f 8b 08 04, mtime 0, xfl 0, os 255, XLEN
+*				subfield "FF", LEN, then: version (1 byte), section (2 bytes), member size (8 bytes),
+*				uncompressed size (8 bytes), title length (2 bytes), title
+*				raw deflate data, CRC32, ISIZE
+*			All integers are little endian, as in the rest of the gzip format.
+*/
+
+#include "CompressedWriter.hpp"
+#include "Arena.hpp"
+#include "PageAllocator.hpp"
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <streambuf>
+#include <deque>
+#include <algorithm>
+
+#ifdef FILEFACTORY_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// gzip extra subfield version written by this class
+static const unsigned char SECTION_FORMAT_VERSION = 1;
+// fixed gzip header size, up to and including XLEN
+static const size_t GZIP_HEADER_SIZE = 12;
+// fixed part of the "FF" subfield payload, before the title
+static const size_t SECTION_FIELD_SIZE = 1 + 2 + 8 + 8 + 2;
+
+// read an unsigned integer of the given width, little endian
+static std::uint64_t getLittleEndian(const unsigned char* in, size_t bytes) {
+	std::uint64_t value = 0;
+	for (size_t i = 0; i < bytes; i++) {
+		value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+	}
+	return value;
+}
+
+#ifdef FILEFACTORY_HAVE_ZLIB
+
+// append an unsigned integer of the given width, little endian
+static void putLittleEndian(std::string& out, std::uint64_t value, size_t bytes) {
+	for (size_t i = 0; i < bytes; i++) {
+		out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+}
+
+// stream buffer that deflates everything written to it, appending raw deflate data to a string
+// sync() does not flush the compressor, so std::endl does not cost a deflate block per line
+class DeflateStreamBuf : public std::streambuf {
+public:
+	explicit DeflateStreamBuf(std::string& output) : m_output(output), m_buffer(64 * 1024), m_crc(0), m_size(0) {
+		m_zs.zalloc = Z_NULL;
+		m_zs.zfree = Z_NULL;
+		m_zs.opaque = Z_NULL;
+
+		// raw deflate, the gzip wrapper is written by hand
+		if (deflateInit2(&m_zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			throw std::runtime_error("Unable to initialize gzip compression");
+		}
+
+		m_crc = crc32(0L, Z_NULL, 0);
+		setp(&m_buffer[0], &m_buffer[0] + m_buffer.size());
+	}
+
+	virtual ~DeflateStreamBuf() {
+		deflateEnd(&m_zs);
+	}
+
+	// compress the remaining data and end the deflate stream
+	void finish() {
+		compress(Z_FINISH);
+	}
+
+	// CRC32 of the uncompressed data
+	uLong crc() const {
+		return m_crc;
+	}
+
+	// number of uncompressed bytes
+	std::uint64_t size() const {
+		return m_size;
+	}
+
+protected:
+	// put area full, compress it
+	virtual int_type overflow(int_type ch) {
+		compress(Z_NO_FLUSH);
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(ch);
+	}
+
+	// nothing to do, data is compressed when the buffer fills or the section ends
+	virtual int sync() {
+		return 0;
+	}
+
+private:
+	// compress the contents of the put area
+	void compress(int flush) {
+		size_t length = static_cast<size_t>(pptr() - pbase());
+
+		m_crc = crc32(m_crc, reinterpret_cast<const Bytef*>(pbase()), static_cast<uInt>(length));
+		m_size += length;
+
+		m_zs.next_in = reinterpret_cast<Bytef*>(pbase());
+		m_zs.avail_in = static_cast<uInt>(length);
+
+		unsigned char out[64 * 1024];
+		int ret;
+		do {
+			m_zs.next_out = out;
+			m_zs.avail_out = sizeof(out);
+			ret = deflate(&m_zs, flush);
+			if (ret == Z_STREAM_ERROR) {
+				throw std::runtime_error("gzip compression failed");
+			}
+			m_output.append(reinterpret_cast<const char*>(out), sizeof(out) - m_zs.avail_out);
+		} while (m_zs.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+		setp(&m_buffer[0], &m_buffer[0] + m_buffer.size());
+	}
+
+	std::string& m_output;
+	std::vector<char> m_buffer;
+	z_stream m_zs;
+	uLong m_crc;
+	std::uint64_t m_size;
+}; // end class DeflateStreamBuf
+
+#endif
+
+// stream buffer that collects what is written to it into parts of a fixed size, handing each part on as it fills
+class PartStreamBuf : public std::streambuf {
+public:
+	// receives a full part, and may take its contents
+	typedef std::function<void(std::string&)> PartHandler;
+
+	PartStreamBuf(size_t partSize, const PartHandler& handler) : m_partSize(partSize), m_handler(handler), m_parts(0) {
+		start();
+	}
+
+	// empty
+	virtual ~PartStreamBuf() {
+
+	}
+
+	// hand on the last part, an empty section still has one
+	void finish() {
+		m_part.resize(static_cast<size_t>(pptr() - pbase()));
+		if (!m_part.empty() || m_parts == 0) {
+			handOn();
+		}
+		start();
+	}
+
+protected:
+	// part full, hand it on
+	virtual int_type overflow(int_type ch) {
+		handOn();
+		start();
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(ch);
+	}
+
+private:
+	// give the part to the handler
+	void handOn() {
+		m_parts++;
+		m_handler(m_part);
+	}
+
+	// a new empty part as the put area
+	void start() {
+		m_part.clear();
+		m_part.resize(m_partSize);
+		setp(&m_part[0], &m_part[0] + m_part.size());
+	}
+
+	size_t m_partSize;
+	PartHandler m_handler;
+	std::string m_part;
+	size_t m_parts;
+}; // end class PartStreamBuf
+
+// empty
+CompressedWriter::CompressedWriter() {
+
+}
+
+// empty
+CompressedWriter::~CompressedWriter() {
+
+}
+
+// render the sections on a pool of workers, which also compress the parts the sections are cut into, and write the
+// members in order as they complete
+void CompressedWriter::write(std::ostream& stream,
+	const std::vector<std::string>& titles,
+	const std::vector<SectionRenderer>& renderers,
+	unsigned threads) {
+
+	if (titles.size() != renderers.size()) {
+		throw std::invalid_argument("Every section needs a title and a renderer");
+	}
+
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+
+	// a compressed part of a section
+	struct Member {
+		std::string data;
+		bool ready;
+	};
+	// a part of a section waiting to be compressed
+	struct Job {
+		size_t section;
+		size_t part;
+		std::string text;
+	};
+
+	// the members of each section as it is cut, in order, and whether the section is fully rendered
+	std::vector<std::deque<Member> > members(renderers.size());
+	std::vector<bool> rendered(renderers.size(), false);
+	std::deque<Job> jobs;
+	size_t nextSection = 0;
+	size_t rendering = 0;
+	std::exception_ptr error;
+	std::mutex mutex;
+	std::condition_variable changed;
+
+	// a caller whose arena maps its blocks gets workers with arenas of their own, mapped the same way
+	Arena* callerArena = Arena::current();
+	PageAllocator::Policy policy = callerArena != nullptr ? callerArena->policy() : PageAllocator::Policy();
+	// and every worker works within the caller's budget
+	Budget* budget = Budget::current();
+
+	// store a compressed member in its place
+	auto store = [&](size_t section, size_t part, std::string& data) {
+		std::lock_guard<std::mutex> lock(mutex);
+		members[section][part].data.swap(data);
+		members[section][part].ready = true;
+		changed.notify_all();
+	};
+
+	// a full part of a section is queued for a free worker, or compressed here when the queue already holds a
+	// part for every other worker
+	auto handOn = [&](size_t section, std::string& text) {
+		std::unique_lock<std::mutex> lock(mutex);
+		size_t part = members[section].size();
+		members[section].push_back(Member());
+		members[section].back().ready = false;
+
+		if (jobs.size() + 1 < threads) {
+			jobs.push_back(Job());
+			jobs.back().section = section;
+			jobs.back().part = part;
+			jobs.back().text.swap(text);
+			changed.notify_all();
+			return;
+		}
+		lock.unlock();
+
+		std::string member = compressMember(section, titles[section], text.data(), text.size());
+		store(section, part, member);
+	};
+
+	// render a section, a renderer that fails to write is an error even if nothing was thrown
+	auto render = [&](size_t section) {
+		PartStreamBuf buffer(PART_SIZE, [&](std::string& text) { handOn(section, text); });
+		std::ostream out(&buffer);
+		out.exceptions(std::ios::badbit);
+
+		renderers[section](out);
+		if (!out) {
+			throw std::runtime_error("Unable to render section " + titles[section]);
+		}
+		buffer.finish();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		rendered[section] = true;
+		rendering--;
+		changed.notify_all();
+	};
+
+	// each worker compresses a queued part if there is one, or else renders the next section not yet started,
+	// on a host with several NUMA nodes the workers are spread over them, and what a worker renders and
+	// compresses is first touched on its own node
+	std::vector<std::thread> workers;
+	for (unsigned w = 0; w < threads; w++) {
+		workers.push_back(std::thread([&, w]() {
+			PageAllocator::bindWorker(w);
+			BudgetScope budgetScope(budget);
+
+			std::unique_ptr<Arena> arena;
+			std::unique_ptr<ArenaScope> scope;
+			if (policy.mapped()) {
+				arena.reset(new Arena(policy));
+				scope.reset(new ArenaScope(*arena));
+			}
+
+			for (;;) {
+				Job job;
+				size_t section = 0;
+				bool compress = false;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&]() {
+						return error || !jobs.empty() || nextSection < renderers.size() || rendering == 0;
+					});
+					if (error) {
+						break;
+					}
+					if (!jobs.empty()) {
+						job.section = jobs.front().section;
+						job.part = jobs.front().part;
+						job.text.swap(jobs.front().text);
+						jobs.pop_front();
+						compress = true;
+					}
+					else if (nextSection < renderers.size()) {
+						section = nextSection++;
+						rendering++;
+					}
+					else {
+						// nothing queued and nothing left to render
+						break;
+					}
+				}
+
+				try {
+					if (compress) {
+						std::string member = compressMember(job.section, titles[job.section], job.text.data(), job.text.size());
+						store(job.section, job.part, member);
+					}
+					else {
+						render(section);
+					}
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!error) {
+						error = std::current_exception();
+					}
+					changed.notify_all();
+				}
+			}
+		}));
+	}
+
+	// write completed members in order, releasing each as soon as it is written
+	bool failed = false;
+	for (size_t section = 0; section < renderers.size() && !failed; section++) {
+		for (size_t part = 0;; part++) {
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&]() {
+				return error || (part < members[section].size() && members[section][part].ready) ||
+					(rendered[section] && part == members[section].size());
+			});
+			if (error) {
+				failed = true;
+				break;
+			}
+			if (part == members[section].size()) {
+				break;
+			}
+
+			std::string member;
+			member.swap(members[section][part].data);
+			lock.unlock();
+
+			stream.write(member.data(), member.size());
+		}
+	}
+
+	for (size_t w = 0; w < workers.size(); w++) {
+		workers[w].join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	stream.flush();
+	if (!stream) {
+		throw std::runtime_error("Unable to write the compressed report");
+	}
+}
+
+// read the member headers, hopping from one member to the next
+std::vector<CompressedWriter::SectionInfo> CompressedWriter::index(std::istream& stream) {
+	std::vector<SectionInfo> sections;
+	std::uint64_t offset = 0;
+
+	stream.clear();
+	stream.seekg(0);
+
+	for (;;) {
+		unsigned char header[GZIP_HEADER_SIZE];
+		stream.read(reinterpret_cast<char*>(header), sizeof(header));
+
+		if (stream.gcount() == 0) {
+			break;
+		}
+		if (static_cast<size_t>(stream.gcount()) != sizeof(header) || header[0] != 0x1f || header[1] != 0x8b) {
+			throw std::runtime_error("Not a gzip member");
+		}
+		if ((header[3] & 0x04) == 0) {
+			throw std::runtime_error("gzip member has no section information");
+		}
+
+		// search the extra field for the "FF" subfield
+		size_t extraLength = static_cast<size_t>(getLittleEndian(header + 10, 2));
+		std::vector<unsigned char> extra(extraLength);
+		stream.read(reinterpret_cast<char*>(extra.data()), extraLength);
+		if (static_cast<size_t>(stream.gcount()) != extraLength) {
+			throw std::runtime_error("Truncated gzip header");
+		}
+
+		bool found = false;
+		size_t pos = 0;
+		while (pos + 4 <= extraLength) {
+			size_t fieldLength = static_cast<size_t>(getLittleEndian(&extra[pos + 2], 2));
+			const unsigned char* field = &extra[pos + 4];
+
+			if (extra[pos] == 'F' && extra[pos + 1] == 'F' && fieldLength >= SECTION_FIELD_SIZE &&
+				pos + 4 + fieldLength <= extraLength && field[0] == SECTION_FORMAT_VERSION) {
+
+				SectionInfo info;
+				info.section = static_cast<size_t>(getLittleEndian(field + 1, 2));
+				info.memberSize = getLittleEndian(field + 3, 8);
+				info.size = getLittleEndian(field + 11, 8);
+				size_t titleLength = static_cast<size_t>(getLittleEndian(field + 19, 2));
+				if (SECTION_FIELD_SIZE + titleLength > fieldLength) {
+					throw std::runtime_error("Corrupt section information");
+				}
+				info.title.assign(reinterpret_cast<const char*>(field + SECTION_FIELD_SIZE), titleLength);
+				info.offset = offset;
+
+				sections.push_back(info);
+				found = true;
+				break;
+			}
+
+			pos += 4 + fieldLength;
+		}
+
+		if (!found) {
+			throw std::runtime_error("gzip member has no section information");
+		}
+
+		// skip to the next member
+		offset += sections.back().memberSize;
+		stream.seekg(static_cast<std::streamoff>(offset));
+		if (!stream) {
+			throw std::runtime_error("Truncated compressed file");
+		}
+	}
+
+	stream.clear();
+	return sections;
+}
+
+#ifdef FILEFACTORY_HAVE_ZLIB
+
+// find the section's members and inflate only those
+void CompressedWriter::extractSection(std::istream& stream, size_t section, std::ostream& output) {
+	std::vector<SectionInfo> sections = index(stream);
+
+	bool found = false;
+	for (std::vector<SectionInfo>::const_iterator itr = sections.begin(); itr != sections.end(); ++itr) {
+		if (itr->section == section) {
+			inflateMember(stream, *itr, output);
+			found = true;
+		}
+	}
+	if (!found) {
+		throw std::out_of_range("No such section in compressed file");
+	}
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// feed the member to the inflater a block at a time, so a member of any size is read in bounded memory
+void CompressedWriter::inflateMember(std::istream& stream, const SectionInfo& member, std::ostream& output) {
+	stream.clear();
+	stream.seekg(static_cast<std::streamoff>(member.offset));
+
+	z_stream zs;
+	zs.zalloc = Z_NULL;
+	zs.zfree = Z_NULL;
+	zs.opaque = Z_NULL;
+	zs.next_in = Z_NULL;
+	zs.avail_in = 0;
+
+	// gzip wrapper, checks the CRC
+	if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+		throw std::runtime_error("Unable to initialize gzip decompression");
+	}
+
+	std::vector<char> in(64 * 1024);
+	char out[64 * 1024];
+	std::uint64_t remaining = member.memberSize;
+	int ret = Z_OK;
+	while (ret != Z_STREAM_END) {
+		if (zs.avail_in == 0) {
+			if (remaining == 0) {
+				inflateEnd(&zs);
+				throw std::runtime_error("Corrupt compressed section");
+			}
+
+			size_t length = static_cast<size_t>(std::min<std::uint64_t>(in.size(), remaining));
+			stream.read(in.data(), static_cast<std::streamsize>(length));
+			if (static_cast<size_t>(stream.gcount()) != length) {
+				inflateEnd(&zs);
+				throw std::runtime_error("Truncated compressed file");
+			}
+			remaining -= length;
+			zs.next_in = reinterpret_cast<Bytef*>(in.data());
+			zs.avail_in = static_cast<uInt>(length);
+		}
+
+		zs.next_out = reinterpret_cast<Bytef*>(out);
+		zs.avail_out = sizeof(out);
+		ret = inflate(&zs, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END) {
+			inflateEnd(&zs);
+			throw std::runtime_error("Corrupt compressed section");
+		}
+		output.write(out, sizeof(out) - zs.avail_out);
+	}
+
+	inflateEnd(&zs);
+}
+
+// deflate the text, then wrap the deflate data in a gzip member
+std::string CompressedWriter::compressMember(size_t section, const std::string& title, const char* text, size_t size) {
+	if (section > 0xffff || title.size() > 0xff00) {
+		throw std::length_error("Section number or title too large");
+	}
+
+	// written to the stream buffer directly, so a failure to compress throws rather than setting a stream state
+	std::string deflated;
+	DeflateStreamBuf buffer(deflated);
+	if (static_cast<size_t>(buffer.sputn(text, static_cast<std::streamsize>(size))) != size) {
+		throw std::runtime_error("gzip compression failed");
+	}
+	buffer.finish();
+
+	// header, extra field, deflate data, trailer
+	size_t fieldLength = SECTION_FIELD_SIZE + title.size();
+	std::uint64_t memberSize = GZIP_HEADER_SIZE + 4 + fieldLength + deflated.size() + 8;
+
+	std::string member;
+	member.reserve(static_cast<size_t>(memberSize));
+
+	// magic, deflate, FEXTRA, mtime, xfl, os unknown
+	const unsigned char fixed[] = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff };
+	member.append(reinterpret_cast<const char*>(fixed), sizeof(fixed));
+	putLittleEndian(member, 4 + fieldLength, 2);
+
+	// "FF" subfield
+	member.push_back('F');
+	member.push_back('F');
+	putLittleEndian(member, fieldLength, 2);
+	putLittleEndian(member, SECTION_FORMAT_VERSION, 1);
+	putLittleEndian(member, section, 2);
+	putLittleEndian(member, memberSize, 8);
+	putLittleEndian(member, buffer.size(), 8);
+	putLittleEndian(member, title.size(), 2);
+	member.append(title);
+
+	member.append(deflated);
+
+	// trailer, size is modulo 2^32
+	putLittleEndian(member, buffer.crc(), 4);
+	putLittleEndian(member, buffer.size() & 0xffffffffu, 4);
+
+	return member;
+}
+
+#else
+
+// zlib not compiled in
+void CompressedWriter::extractSection(std::istream&, size_t, std::ostream&) {
+	throw std::runtime_error("Compressed output is not supported, build with FILEFACTORY_HAVE_ZLIB");
+}
+
+// zlib not compiled in
+void CompressedWriter::inflateMember(std::istream&, const SectionInfo&, std::ostream&) {
+	throw std::runtime_error("Compressed output is not supported, build with FILEFACTORY_HAVE_ZLIB");
+}
+
+// zlib not compiled in
+std::string CompressedWriter::compressMember(size_t, const std::string&, const char*, size_t) {
+	throw std::runtime_error("Compressed output is not supported, build with FILEFACTORY_HAVE_ZLIB");
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+* File:		CompressedWriter.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a CompressedWriter class, that writes output sections as a
+*			seekable compressed file. Sections are rendered and compressed in parallel, and each one is written
+*			as one or more independent gzip members, so the whole file still decompresses with zcat/gunzip.
+*
+*			A section is cut into parts of PART_SIZE uncompressed bytes as it is rendered, and the parts are
+*			compressed by whichever workers are free, so one large section keeps every worker busy instead of
+*			bounding the run by the time one worker takes to compress it. The parts of a section are written as
+*			consecutive members, in order.
+*
+*			Every member carries a gzip extra field (subfield id "FF") recording the section number, its title,
+*			the total size of the member and its uncompressed size, in the spirit of BGZF. A reader finds any
+*			section by hopping from header to header, without decompressing the sections before it.
+*
+*			Requires zlib, compiled in when FILEFACTORY_HAVE_ZLIB is defined.
+*/
+
+#ifndef COMPRESSED_WRITER_HPP
+#define COMPRESSED_WRITER_HPP
+
+// includes
+#include <iostream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// class definition
+class CompressedWriter {
+public:
+	// section renderer, prints the uncompressed section text to the stream
+	typedef std::function<void(std::ostream&)> SectionRenderer;
+
+	// uncompressed bytes of a section compressed into one member
+	static const size_t PART_SIZE = 4 * 1024 * 1024;
+
+	// description of a member of a compressed file, a section larger than PART_SIZE has several
+	struct SectionInfo {
+		// section number
+		size_t section;
+		// section title
+		std::string title;
+		// offset of the gzip member in the file
+		std::uint64_t offset;
+		// size of the gzip member, header and trailer included
+		std::uint64_t memberSize;
+		// size of the uncompressed part of the section in the member
+		std::uint64_t size;
+	};
+
+	// constructor/destructor
+	CompressedWriter();
+	virtual ~CompressedWriter();
+
+	// render and compress the sections in parallel, writing the gzip members of each section to the stream, in order
+	// threads is the number of compression workers, 0 uses the number of hardware threads
+	// when the caller's arena maps its blocks, each worker allocates from an arena of its own mapped the same way
+	// a stream that fails, such as a full disk, throws std::runtime_error
+	static void write(std::ostream& stream,
+		const std::vector<std::string>& titles,
+		const std::vector<SectionRenderer>& renderers,
+		unsigned threads = 0);
+
+	// read the member index of a compressed file, reading only the member headers
+	static std::vector<SectionInfo> index(std::istream& stream);
+
+	// decompress a single section of a compressed file to the output stream, all of its members in order
+	static void extractSection(std::istream& stream, size_t section, std::ostream& output);
+
+private:
+	// compress part of a section into a complete gzip member
+	static std::string compressMember(size_t section, const std::string& title, const char* text, size_t size);
+	// inflate one member to the output stream, reading it from the stream a block at a time
+	static void inflateMember(std::istream& stream, const SectionInfo& member, std::ostream& output);
+}; // end class CompressedWriter
+
+#endif
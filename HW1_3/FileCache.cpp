@@ -0,0 +1,151 @@
+/**
+* File:		FileCache.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a FileCache class, a least recently used cache of parsed input files.
+*/
+
+#include "FileCache.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// take the file and build its C-string array
+FileCache::Entry::Entry(File file) : m_file(std::move(file)), m_array(nullptr), m_arraySize(0) {
+	m_array = FileFactory::toCStringArray(m_file, m_arraySize);
+}
+
+// release the C-string array
+FileCache::Entry::~Entry() {
+	FileFactory::freeCStringArray(m_array, m_arraySize);
+}
+
+// the parsed file
+const File& FileCache::Entry::file() const {
+	return m_file;
+}
+
+// the C-string array of the file
+char** FileCache::Entry::array() const {
+	return m_array;
+}
+
+// size of the C-string array
+size_t FileCache::Entry::arraySize() const {
+	return m_arraySize;
+}
+
+// an empty cache
+FileCache::FileCache(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1), m_hits(0), m_misses(0) {
+
+}
+
+// empty
+FileCache::~FileCache() {
+
+}
+
+// look the path up, parse it outside the lock on a miss, then insert it as the most recent entry
+// two requests missing on the same file at once both parse it, the later insert wins
+FileCache::EntryPointer FileCache::get(const std::string& path, bool& hit) {
+	Version version = statFile(path);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto found = m_index.find(path);
+		if (found != m_index.end() && found->second->version == version) {
+			m_slots.splice(m_slots.begin(), m_slots, found->second);
+			m_hits++;
+			hit = true;
+			return found->second->entry;
+		}
+		m_misses++;
+	}
+
+	hit = false;
+	EntryPointer entry = load(path);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_index.find(path);
+	if (found != m_index.end()) {
+		m_slots.erase(found->second);
+		m_index.erase(found);
+	}
+
+	Slot slot = { path, version, entry };
+	m_slots.push_front(slot);
+	m_index[path] = m_slots.begin();
+
+	// evict the least recently used, requests still printing them keep their entries alive
+	while (m_slots.size() > m_capacity) {
+		m_index.erase(m_slots.back().path);
+		m_slots.pop_back();
+	}
+
+	return entry;
+}
+
+// number of cached files
+size_t FileCache::size() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_slots.size();
+}
+
+// maximum number of cached files
+size_t FileCache::capacity() const {
+	return m_capacity;
+}
+
+// lookups served from the cache
+std::uint64_t FileCache::hits() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hits;
+}
+
+// lookups that parsed the file
+std::uint64_t FileCache::misses() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_misses;
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// same modification time and size
+bool FileCache::Version::operator==(const Version& other) const {
+	return seconds == other.seconds && nanoseconds == other.nanoseconds && size == other.size;
+}
+
+// modification time, to the nanosecond where the system records it
+FileCache::Version FileCache::statFile(const std::string& path) {
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0) {
+		throw std::runtime_error("Unable to open " + path);
+	}
+
+	Version version;
+	version.seconds = static_cast<std::int64_t>(status.st_mtime);
+#if defined(__linux__)
+	version.nanoseconds = static_cast<std::int64_t>(status.st_mtim.tv_nsec);
+#elif defined(__APPLE__)
+	version.nanoseconds = static_cast<std::int64_t>(status.st_mtimespec.tv_nsec);
+#else
+	version.nanoseconds = 0;
+#endif
+	version.size = static_cast<std::uint64_t>(status.st_size);
+	return version;
+}
+
+// parse a possibly compressed file
+FileCache::EntryPointer FileCache::load(const std::string& path) {
+	std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + path);
+	}
+
+	// a request thread decompresses with one worker, the other requests keep the rest of the cores
+	return std::make_shared<const Entry>(FileFactory::readFileFromCompressedStream(input, 1));
+}
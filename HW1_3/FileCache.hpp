@@ -0,0 +1,101 @@
+/**
+* File:		FileCache.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a FileCache class, a least recently used cache of parsed input
+*			files, keyed by path and modification time, used by FileServer. Each entry holds the File and its
+*			C-string array, built once and shared read-only by every request that prints it. An entry whose file
+*			changed on disk (modification time or size) is parsed again on its next use.
+*/
+
+#ifndef FILE_CACHE_HPP
+#define FILE_CACHE_HPP
+
+// includes
+#include "FileFactory.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// class definition
+class FileCache {
+public:
+	// a parsed file and its C-string array, immutable once made
+	class Entry {
+	public:
+		// constructor/destructor, builds the C-string array of file
+		explicit Entry(File file);
+		virtual ~Entry();
+
+		const File& file() const;
+		char** array() const;
+		size_t arraySize() const;
+
+	private:
+		// not copyable
+		Entry(const Entry&);
+		Entry& operator=(const Entry&);
+
+		File m_file;
+		char** m_array;
+		size_t m_arraySize;
+	}; // end class Entry
+
+	typedef std::shared_ptr<const Entry> EntryPointer;
+
+	// constructor/destructor, capacity is the number of files kept
+	explicit FileCache(size_t capacity);
+	virtual ~FileCache();
+
+	// the entry of the file at path, parsed if it is not cached or changed on disk, hit is set if it was cached
+	// throws runtime_error if the file cannot be read
+	// entries stay valid while they are held, even after they are evicted
+	EntryPointer get(const std::string& path, bool& hit);
+
+	// number of cached files
+	size_t size() const;
+	size_t capacity() const;
+	// lookups served from the cache, and lookups that parsed the file
+	std::uint64_t hits() const;
+	std::uint64_t misses() const;
+
+private:
+	// modification time and size of a file, an entry is current while they match
+	struct Version {
+		std::int64_t seconds;
+		std::int64_t nanoseconds;
+		std::uint64_t size;
+
+		bool operator==(const Version& other) const;
+	};
+
+	// a cached file, the list is in order of use, most recent first
+	struct Slot {
+		std::string path;
+		Version version;
+		EntryPointer entry;
+	};
+	typedef std::list<Slot> SlotList;
+
+	// version of the file on disk, throws runtime_error if there is none
+	static Version statFile(const std::string& path);
+	// parse the file
+	static EntryPointer load(const std::string& path);
+
+	// not copyable
+	FileCache(const FileCache&);
+	FileCache& operator=(const FileCache&);
+
+	size_t m_capacity;
+	SlotList m_slots;
+	std::unordered_map<std::string, SlotList::iterator> m_index;
+	std::uint64_t m_hits;
+	std::uint64_t m_misses;
+	// guards the list, the index and the counters, never held while a file is parsed
+	mutable std::mutex m_mutex;
+}; // end class FileCache
+
+#endif
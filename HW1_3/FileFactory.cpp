@@ -13,116 +13,1158 @@
 *			Odd words reversed
 *			Alternating words, meeting in middle
 *			C-Strings Forward/Backward, const/non const
+*			The same operations are supported on an InternedFile, where per-word transforms are memoized per distinct word,
+*			and on a PackedFile, where short words are transformed in their 16-byte slots with a single byte shuffle
+*			on processors that have one, chosen at run time with the other WordKernels.
+*			Built as C++20, words can also be pulled one at a time from coroutine generators, over a stream, a
+*			descriptor, or a File in the order of each print function.
 */
 
 #include "FileFactory.hpp"
+#include "CompressedReader.hpp"
+#include "WordTokenizer.hpp"
+#include "WordSorter.hpp"
+#include "WordKernels.hpp"
+#include <cerrno>
 #include <stdexcept>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// byte shuffle masks for words stored inline in a PackedFile slot, indexed by word length
+// entry i is the index of the source byte for output byte i, 0x80 produces a zero byte (the terminator)
+struct SlotMasks {
+	unsigned char reverse[PackedFile::SLOT_SIZE][PackedFile::SLOT_SIZE];
+	unsigned char alternate[PackedFile::SLOT_SIZE][PackedFile::SLOT_SIZE];
+
+	SlotMasks() {
+		for (size_t length = 0; length < PackedFile::SLOT_SIZE; length++) {
+			for (size_t i = 0; i < PackedFile::SLOT_SIZE; i++) {
+				if (i < length) {
+					// last to first
+					reverse[length][i] = static_cast<unsigned char>(length - 1 - i);
+					// first, last, second, next-to-last, etc.
+					alternate[length][i] = static_cast<unsigned char>(i % 2 == 0 ? i / 2 : length - 1 - i / 2);
+				}
+				else {
+					reverse[length][i] = 0x80;
+					alternate[length][i] = 0x80;
+				}
+			}
+		}
+	}
+};
+
+static const SlotMasks slotMasks;
+
+// the slot shuffle of WordKernels permutes 16 bytes
+static_assert(PackedFile::SLOT_SIZE == 16, "WordKernels::shuffleSlot permutes 16 byte slots");
+
+#if CONTAINER == FORWARD_LIST
+// words between the iterators kept by forEachBackward
+static const size_t BACKWARD_CHUNK = 4096;
+
+// bytes a reversed copy of a forward list takes, a node per word and the characters of its long words
+static size_t copyBytes(const File& file) {
+	size_t bytes = 0;
+	for (const std::string& word : file) {
+		bytes += sizeof(std::string) + sizeof(void*) + Budget::heapBytes(word);
+	}
+	return bytes;
+}
+
+// visit the words of a forward list last to first without copying it, until visit returns false
+// one walk keeps an iterator every BACKWARD_CHUNK words, then the chunks, last first, are gathered and visited
+// backward, so only an iterator per chunk and a pointer per word of one chunk are held
+template <class Iterator, class Visit>
+static void forEachBackward(Iterator first, Iterator last, Visit visit) {
+	std::vector<Iterator> chunks;
+	size_t count = 0;
+	for (Iterator itr = first; itr != last; ++itr, ++count) {
+		if (count % BACKWARD_CHUNK == 0) {
+			chunks.push_back(itr);
+		}
+	}
+
+	std::vector<typename std::iterator_traits<Iterator>::pointer> words;
+	for (size_t chunk = chunks.size(); chunk-- > 0;) {
+		words.clear();
+		Iterator itr = chunks[chunk];
+		for (size_t i = chunk * BACKWARD_CHUNK; i < count && i < (chunk + 1) * BACKWARD_CHUNK; i++, ++itr) {
+			words.push_back(&*itr);
+		}
+
+		for (size_t i = words.size(); i-- > 0;) {
+			if (!visit(*words[i])) {
+				return;
+			}
+		}
+	}
+}
+#endif
+
 // empty
 FileFactory::FileFactory() {
 
 }
 
-// empty
-FileFactory::~FileFactory() {
+// empty
+FileFactory::~FileFactory() {
+
+}
+
+// backend chosen by CONTAINER
+const char* FileFactory::containerName() {
+#if CONTAINER == VECTOR
+	return "vector";
+#elif CONTAINER == DEQUE
+	return "deque";
+#elif CONTAINER == LIST
+	return "list";
+#elif CONTAINER == FORWARD_LIST
+	return "forward_list";
+#else
+	return "array";
+#endif
+}
+
+// end of the filled slots of an ARRAY file, the end of any other
+File::const_iterator FileFactory::filledEnd(const File& file) {
+#if CONTAINER == ARRAY
+	return std::find(file.cbegin(), file.cend(), std::string());
+#else
+	return file.cend();
+#endif
+}
+
+// read contents of input stream to File object
+File FileFactory::readFileFromStream(std::istream& stream) {
+	std::string line;
+	std::string word;
+
+	File infile;
+	size_t count = 0;
+
+	// while input remains
+	while (stream) {
+		// read contents of stdin to variable, by line
+		std::getline(stream, line);
+
+		// if there is an error with the stream, break
+		if (!stream) {
+			break;
+		}
+
+		// the budget is checked a line at a time
+		Budget::checkpoint();
+		
+		// else, process word by word
+		std::istringstream iss(line);
+
+		// add the word to the File object, an ARRAY file throws length_error when it is full
+		while (iss >> word) {
+			appendWord(infile, count, word);
+		}
+	}
+
+	// return the file object
+	finishFile(infile);
+
+	return infile;
+}
+
+// read contents of a possibly compressed input stream to File object
+// each decompressed block is tokenized as it arrives, the uncompressed input is never held in full
+File FileFactory::readFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	File infile;
+	size_t count = 0;
+
+	WordTokenizer tokenizer;
+	auto sink = [&infile, &count](const std::string& word) {
+		appendWord(infile, count, word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
+
+	tokenizer.finish(sink);
+	finishFile(infile);
+
+	return infile;
+}
+
+// read a possibly compressed input stream to File object, with the grammar's tokenizer in place of WordTokenizer
+template <class Grammar>
+File FileFactory::readFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	File infile;
+	size_t count = 0;
+
+	GrammarTokenizer<Grammar> tokenizer;
+	auto sink = [&infile, &count](const std::string& word) {
+		appendWord(infile, count, word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
+
+	tokenizer.finish(sink);
+	finishFile(infile);
+
+	return infile;
+}
+
+// read words and line starts in one pass, the tokenizer reports each newline after the words before it
+File FileFactory::readFileWithLines(std::istream& stream, LineIndex& lines, unsigned threads) {
+	File infile;
+	size_t count = 0;
+
+	WordTokenizer tokenizer;
+	auto sink = [&infile, &count](const std::string& word) {
+		appendWord(infile, count, word);
+	};
+	auto newline = [&lines, &count]() {
+		lines.newline(count);
+	};
+
+	lines.clear();
+	CompressedReader::read(stream, [&tokenizer, &sink, &newline](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink, newline);
+	}, threads);
+
+	tokenizer.finish(sink);
+	finishFile(infile);
+	lines.finish(count);
+
+	return infile;
+}
+
+// read words straight from a caller's buffer, the text is tokenized in place without being copied first
+File FileFactory::readFileFromBuffer(const char* data, size_t length) {
+	File infile;
+	size_t count = 0;
+
+	WordTokenizer tokenizer;
+	auto sink = [&infile, &count](const std::string& word) {
+		appendWord(infile, count, word);
+	};
+
+	// fed a block at a time, so the budget is checked as often as for a stream
+	for (size_t offset = 0; offset < length; offset += CompressedReader::BLOCK_SIZE) {
+		size_t block = length - offset;
+		if (block > CompressedReader::BLOCK_SIZE) {
+			block = CompressedReader::BLOCK_SIZE;
+		}
+
+		Budget::checkpoint();
+		tokenizer.feed(data + offset, block, sink);
+	}
+	tokenizer.finish(sink);
+	finishFile(infile);
+
+	return infile;
+}
+
+// read a range of words through the checkpoint index, only the pages holding them are parsed
+File FileFactory::readFileRange(const PagedReader& reader, std::uint64_t first, std::uint64_t last) {
+	File infile;
+	size_t count = 0;
+
+	reader.readRange(first, last, [&infile, &count](const std::string& word) {
+		appendWord(infile, count, word);
+	});
+
+	finishFile(infile);
+
+	return infile;
+}
+
+// read the last words through the checkpoint index
+File FileFactory::readFileTail(const PagedReader& reader, std::uint64_t count) {
+	File infile;
+	size_t added = 0;
+
+	reader.readTail(count, [&infile, &added](const std::string& word) {
+		appendWord(infile, added, word);
+	});
+
+	finishFile(infile);
+
+	return infile;
+}
+
+// append words after the last word of a finished file
+void FileFactory::appendWords(File& file, const std::vector<std::string>& words) {
+#if CONTAINER == ARRAY
+	size_t count = filledEnd(file) - file.cbegin();
+	for (const std::string& word : words) {
+		appendWord(file, count, word);
+	}
+#elif CONTAINER == FORWARD_LIST
+	// walk to the last node, then insert after it
+	File::iterator last = file.before_begin();
+	for (File::iterator next = file.begin(); next != file.end(); ++next) {
+		last = next;
+	}
+	for (const std::string& word : words) {
+		last = file.insert_after(last, word);
+	}
+#else
+	file.insert(file.end(), words.cbegin(), words.cend());
+#endif
+}
+
+// print contents of file, using const methods
+// specify direction and interator type
+// forward printing with reverse iterators is not allowed and generates an exception
+void FileFactory::printFileConst(const File& file,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+	
+	// determine iterator type
+	switch (iteratorType) {
+		// if normal iterators, support fwd/backward printing
+		case NORMAL:
+			if (direction == FORWARD) {
+				printForwardConst(file, stream, filter);
+			}
+			else {
+				printBackwardConst(file, stream, filter);
+			}
+			break;
+		// reverse iteration is only supported when printing backward
+		case REVERSE:
+			if (direction == FORWARD) {
+				// throw exception
+				throw std::invalid_argument("This is not a supported print operation");
+			}
+			
+			// print backward
+			printBackwardReverseConst(file, stream, filter);
+
+			break;
+	}
+}
+
+// print contents of file, using non const methods
+// specify direction and interator type
+// forward printing with reverse iterators is not allowed and generates an exception
+void FileFactory::printFile(File& file,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+
+	// determine iterator type
+	switch (iteratorType) {
+		// if normal iterators, support fwd/backward printing
+		case NORMAL:
+			if (direction == FORWARD) {
+				printForward(file, stream, filter);
+			}
+			else {
+				printBackward(file, stream, filter);
+			}
+			break;
+		// reverse iteration is only supported when printing backward
+		case REVERSE:
+			if (direction == FORWARD) {
+				// throw exception
+				throw std::invalid_argument("This is not a supported print operation");
+			}
+
+			// print backward
+			printBackwardReverse(file, stream, filter);
+
+			break;
+	}
+}
+
+// print odd indexed words in reverse order
+void FileFactory::printOddWordsReverse(const File& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+	File::const_iterator itr;
+	// counter for word number
+	int count = 1;
+	// begin to end
+	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
+		// if odd, reverse into a temporary that is copied out, otherwise print the word in place
+		// a copied word skips the emitter's filter, so it is matched here, before it is reversed
+		if (count % 2 == 1) {
+			// call helper function
+			if (filter.matches(*itr)) {
+				emitter.addCopy(reverseString(*itr));
+			}
+		}
+		else {
+			emitter.add(*itr);
+		}
+
+		// increment
+		count++;
+	}
+}
+
+// print words in alternating order, first to last, meeting in middle
+void FileFactory::printAlternatingWords(const File& file, std::ostream& stream, const PatternFilter& filter) {
+#if CONTAINER == FORWARD_LIST
+	// i and j are the positions of front and back, counted from the front, back walks the reversed copy
+	size_t i = 0;
+	size_t j = FileFactory::size(file);
+
+	// without room in the budget for the copy, back walks the list a chunk at a time instead
+	if (Budget::current() != nullptr && !Budget::allows(copyBytes(file))) {
+		WordEmitter emitter(stream);
+		File::const_iterator front = file.cbegin();
+
+		forEachBackward(file.cbegin(), file.cend(), [&](const std::string& back) {
+			--j;
+			if (filter.matches(*front)) {
+				emitter.addCopy(alternateString(*front));
+			}
+			if (i == j) {
+				return false;
+			}
+			if (filter.matches(back)) {
+				emitter.addCopy(alternateString(back));
+			}
+			++front;
+			++i;
+			return i != j;
+		});
+		return;
+	}
+
+	File copy = file;
+	copy.reverse();
+#endif
+
+	File::const_iterator front = file.cbegin();
+	File::const_iterator back =
+#if CONTAINER == FORWARD_LIST
+		copy.cbegin();
+#else
+		filledEnd(file);
+#endif
+
+	// declared after the copy, so it is flushed while the copy's words are still alive
+	WordEmitter emitter(stream);
+
+	// use two iterators, while front not past back
+#if CONTAINER == FORWARD_LIST
+	while (i != j) {
+#else
+	while (front != back) {
+#endif
+		// decrement back first
+#if CONTAINER == FORWARD_LIST
+		--j;
+#else
+		--back;
+#endif
+
+		// alternate the characters, print the front, the words are matched before they are alternated
+		if (filter.matches(*front)) {
+			emitter.addCopy(alternateString(*front));
+		}
+		// if not same word, print back
+#if CONTAINER == FORWARD_LIST
+		if (i != j) {
+#else
+		if (front != back) {
+#endif
+			if (filter.matches(*back)) {
+				emitter.addCopy(alternateString(*back));
+			}
+#if CONTAINER == FORWARD_LIST
+			++back;
+#endif
+		}
+		else {
+			break;
+		}
+		// increment front
+		++front;
+#if CONTAINER == FORWARD_LIST
+		++i;
+#endif
+	}
+}
+
+// print the words of the file sorted, the keys point into the file, so no word is copied
+void FileFactory::printSorted(const File& file,
+	std::ostream& stream,
+	WordSorter::Order order,
+	bool unique,
+	unsigned threads) {
+
+	std::vector<WordSorter::Key> keys;
+#if CONTAINER != FORWARD_LIST
+	keys.reserve(file.size());
+#endif
+	for (const std::string& word : file) {
+		// the empty slots of an array are not words
+		if (!word.empty()) {
+			keys.push_back(WordSorter::key(word.data(), word.size()));
+		}
+	}
+
+	printKeys(keys, stream, order, unique, threads);
+}
+
+// print words as the reader finds them, last to first, output starts with the last block
+void FileFactory::printFileBackward(const ReverseReader& reader, std::ostream& stream) {
+	WordEmitter emitter(stream);
+
+	// the reader's characters only live for the call, so each word is copied out
+	reader.read([&emitter](const char* word, size_t length) {
+		emitter.addCopy(word, length);
+	});
+}
+
+// print lines in order
+void FileFactory::printLines(const File& file, const LineIndex& lines, std::ostream& stream, size_t first, size_t last) {
+	printLineRange(file, lines, first, last, false, stream);
+}
+
+// print lines last to first
+void FileFactory::printLinesBackward(const File& file, const LineIndex& lines, std::ostream& stream) {
+	std::string output;
+	std::vector<const std::string*> words;
+
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+	// no random access, find the start of every line in one walk
+	std::vector<File::const_iterator> starts;
+	starts.reserve(lines.lines());
+
+	File::const_iterator itr = file.cbegin();
+	size_t position = 0;
+	for (size_t line = 0; line < lines.lines(); line++) {
+		std::advance(itr, lines.first(line) - position);
+		position = lines.first(line);
+		starts.push_back(itr);
+	}
+#endif
+
+	for (size_t line = lines.lines(); line-- > 0;) {
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+		File::const_iterator start = starts[line];
+#else
+		File::const_iterator start = file.cbegin() + lines.first(line);
+#endif
+		appendLine(start, lines.last(line) - lines.first(line), false, words, output);
+
+		if (output.size() >= WordEmitter::BUFFER_SIZE) {
+			stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			output.clear();
+		}
+	}
+	stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+}
+
+// print lines with their words reversed
+void FileFactory::printLinesWordsReversed(const File& file, const LineIndex& lines, std::ostream& stream) {
+	printLineRange(file, lines, 0, lines.lines(), true, stream);
+}
+
+#ifdef FILEFACTORY_HAVE_COROUTINES
+// words of the stream, each block is read only once the caller has pulled every word of the one before
+Generator<std::string> FileFactory::generateWords(std::istream& stream) {
+	WordTokenizer tokenizer;
+	std::vector<std::string> words;
+	auto sink = [&words](const std::string& word) {
+		words.push_back(word);
+	};
+
+	std::vector<char> buffer(1 << 16);
+	while (stream) {
+		stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		tokenizer.feed(buffer.data(), static_cast<size_t>(stream.gcount()), sink);
+
+		for (const std::string& word : words) {
+			co_yield word;
+		}
+		words.clear();
+	}
+
+	if (stream.bad()) {
+		throw std::runtime_error("Unable to read the input stream");
+	}
+
+	tokenizer.finish(sink);
+	for (const std::string& word : words) {
+		co_yield word;
+	}
+}
+
+#ifndef _WIN32
+// words of a descriptor, an empty word when a read would block, so an event loop can wait on many descriptors
+Generator<std::string> FileFactory::generateWords(int descriptor) {
+	WordTokenizer tokenizer;
+	std::vector<std::string> words;
+	auto sink = [&words](const std::string& word) {
+		words.push_back(word);
+	};
+
+	std::vector<char> buffer(1 << 16);
+	const std::string notReady;
+
+	while (true) {
+		ssize_t count = read(descriptor, buffer.data(), buffer.size());
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				co_yield notReady;
+				continue;
+			}
+			throw std::runtime_error(std::string("Unable to read the input: ") + std::strerror(errno));
+		}
+
+		// end of input
+		if (count == 0) {
+			break;
+		}
+
+		tokenizer.feed(buffer.data(), static_cast<size_t>(count), sink);
+		for (const std::string& word : words) {
+			co_yield word;
+		}
+		words.clear();
+	}
+
+	tokenizer.finish(sink);
+	for (const std::string& word : words) {
+		co_yield word;
+	}
+}
+#endif
+
+// words first to last, the empty slots of an array are skipped as the print functions skip them
+Generator<std::string> FileFactory::generateForward(const File& file) {
+	for (const std::string& word : file) {
+		if (!word.empty()) {
+			co_yield word;
+		}
+	}
+}
+
+// words last to first, a forward list is walked once to find them
+Generator<std::string> FileFactory::generateBackward(const File& file) {
+#if CONTAINER == FORWARD_LIST
+	std::vector<const std::string*> words;
+	for (const std::string& word : file) {
+		words.push_back(&word);
+	}
+
+	for (std::vector<const std::string*>::const_reverse_iterator itr = words.crbegin(); itr != words.crend(); ++itr) {
+		co_yield **itr;
+	}
+#else
+	for (File::const_reverse_iterator itr = file.crbegin(); itr != file.crend(); ++itr) {
+		if (!itr->empty()) {
+			co_yield *itr;
+		}
+	}
+#endif
+}
+
+// words first to last, odd words reversed
+Generator<std::string> FileFactory::generateOddWordsReverse(const File& file) {
+	// counter for word number
+	size_t count = 1;
+	for (const std::string& word : file) {
+		if (word.empty()) {
+			continue;
+		}
+
+		if (count % 2 == 1) {
+			co_yield reverseString(word);
+		}
+		else {
+			co_yield word;
+		}
+		count++;
+	}
+}
+
+// words alternating first and last, meeting in the middle, characters alternated as printAlternatingWords does
+Generator<std::string> FileFactory::generateAlternatingWords(const File& file) {
+#if CONTAINER == FORWARD_LIST
+	std::vector<const std::string*> words;
+	for (const std::string& word : file) {
+		words.push_back(&word);
+	}
+
+	std::vector<const std::string*>::const_iterator front = words.cbegin();
+	std::vector<const std::string*>::const_iterator back = words.cend();
+#else
+	File::const_iterator front = file.cbegin();
+	File::const_iterator back = filledEnd(file);
+#endif
+
+	while (front != back) {
+		--back;
+
+#if CONTAINER == FORWARD_LIST
+		co_yield alternateString(**front);
+		if (front == back) {
+			break;
+		}
+		co_yield alternateString(**back);
+#else
+		co_yield alternateString(*front);
+		if (front == back) {
+			break;
+		}
+		co_yield alternateString(*back);
+#endif
+		++front;
+	}
+}
+#endif
+
+// turn contents of file into a C-String array
+char** FileFactory::toCStringArray(const File& file, size_t& size) {
+	size_t fileSize =
+		// arrays and forward lists do not provide a 'count' function, so we'll have to calculate it...
+#if CONTAINER == ARRAY || CONTAINER == FORWARD_LIST
+		FileFactory::size(file);
+#else
+		// another method to have done this would be to use the size function implemented below, 
+		// and just have the macro determine if a manual count or a simple return of the implemented size() function should be returned.
+		size = file.size();
+#endif
+
+
+	// characters of the copies, counted only when there is a budget to check them against
+	size_t characters = 0;
+	if (Budget::current() != nullptr) {
+		for (const std::string& word : file) {
+			characters += word.length() + 1;
+		}
+	}
+
+	char** result = allocateCStringArray(fileSize, characters);  // allocate memory
+	size = fileSize;
+
+	// iterator
+	File::const_iterator itr;
+	// index counter
+	int count = 0;
+	// for begin to end
+	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
+		// allocate an element, with space for the null terminator
+		// and copy to array index
+		result[count] = allocateCString(*itr);
+		// increment count
+		count++;
+	}
+
+	// return the result
+	return result;
+}
+
+// release a C-string array produced by toCStringArray
+void FileFactory::freeCStringArray(char** fileArray, const size_t size) {
+	Arena* arena = Arena::current();
+
+	// arena memory is reclaimed when the arena is released
+	if (arena != nullptr && arena->owns(fileArray)) {
+		return;
+	}
+
+	for (size_t i = 0; i < size; i++) {
+		delete[] fileArray[i];
+	}
+	delete[] fileArray;
+}
+
+
+// print the contents of a C-string array of specified size in direction specified, using const methods
+void FileFactory::printArrayConst(char** fileArray,
+	const size_t size,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	const PatternFilter& filter) {
+
+	// if fwd/backward
+	switch (direction) {
+	case FORWARD:
+		// print forward
+		printForwardCStringConst(fileArray, size, stream, filter);
+		break;
+	case BACKWARD:
+		// print backward
+		printBackwardCStringConst(fileArray, size, stream, filter);
+		break;
+	}
+}
+
+// print the contents of a C-string array of specified size in direction specified, using non const methods
+void FileFactory::printArray(char** fileArray,
+	const size_t size,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	const PatternFilter& filter) {
+
+	// if fwd/backward
+	switch (direction) {
+	case FORWARD:
+		// print forward
+		printForwardCString(fileArray, size, stream, filter);
+		break;
+	case BACKWARD:
+		// print backward
+		printBackwardCString(fileArray, size, stream, filter);
+		break;
+	}
+}
+
+// print the contents of a C-string array sorted
+void FileFactory::printArraySorted(char** fileArray,
+	const size_t size,
+	std::ostream& stream,
+	WordSorter::Order order,
+	bool unique,
+	unsigned threads) {
+
+	std::vector<WordSorter::Key> keys;
+	keys.reserve(size);
+	for (size_t i = 0; i < size; i++) {
+		keys.push_back(WordSorter::key(fileArray[i], std::strlen(fileArray[i])));
+	}
+
+	printKeys(keys, stream, order, unique, threads);
+}
+
+// read contents of input stream to an InternedFile object
+InternedFile FileFactory::readInternedFileFromStream(std::istream& stream) {
+	std::string line;
+	std::string word;
+
+	InternedFile infile;
+
+	// while input remains
+	while (stream) {
+		// read contents of stream to variable, by line
+		std::getline(stream, line);
+
+		// if there is an error with the stream, break
+		if (!stream) {
+			break;
+		}
+
+		// the budget is checked a line at a time
+		Budget::checkpoint();
+
+		// else, process word by word
+		std::istringstream iss(line);
+
+		// intern the word
+		while (iss >> word) {
+			infile.add(word);
+		}
+	}
+
+	return infile;
+}
+
+// read a possibly compressed input stream to an InternedFile, tokenized a decompressed block at a time
+InternedFile FileFactory::readInternedFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	InternedFile infile;
+
+	WordTokenizer tokenizer;
+	auto sink = [&infile](const std::string& word) {
+		infile.add(word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
+
+	tokenizer.finish(sink);
+	return infile;
+}
+
+// read a possibly compressed input stream to an InternedFile, with the grammar's tokenizer
+template <class Grammar>
+InternedFile FileFactory::readInternedFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	InternedFile infile;
+
+	GrammarTokenizer<Grammar> tokenizer;
+	auto sink = [&infile](const std::string& word) {
+		infile.add(word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
+
+	tokenizer.finish(sink);
+	return infile;
+}
+
+// produce an InternedFile from the contents of file
+InternedFile FileFactory::intern(const File& file) {
+	InternedFile result;
+	File::const_iterator itr;
+	File::const_iterator end = filledEnd(file);
+
+	// begin to end
+	for (itr = file.cbegin(); itr != end; ++itr) {
+		result.add(*itr);
+	}
+
+	return result;
+}
+
+// print contents of interned file, using const methods
+// specify direction and interator type
+// forward printing with reverse iterators is not allowed and generates an exception
+void FileFactory::printFileConst(const InternedFile& file,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+
+	const InternedFile::WordIds& ids = file.ids();
+	WordEmitter emitter(stream, &filter);
+
+	// determine iterator type
+	switch (iteratorType) {
+		// if normal iterators, support fwd/backward printing
+		case NORMAL:
+			if (direction == FORWARD) {
+				for (size_t i = 0; i < ids.size(); i++) {
+					emitter.add(file.word(ids[i]));
+				}
+			}
+			else {
+				// i is unsigned, cannot go less than 0 -- start at size and use index - 1
+				for (size_t i = ids.size(); i > 0; --i) {
+					emitter.add(file.word(ids[i - 1]));
+				}
+			}
+			break;
+		// reverse iteration is only supported when printing backward
+		case REVERSE:
+			if (direction == FORWARD) {
+				// throw exception
+				throw std::invalid_argument("This is not a supported print operation");
+			}
+
+			// print backward, using a reverse iterator over the id sequence
+			for (InternedFile::WordIds::const_reverse_iterator itr = ids.crbegin(); itr != ids.crend(); ++itr) {
+				emitter.add(file.word(*itr));
+			}
+
+			break;
+	}
+}
+
+// print contents of interned file, using non const methods
+// the interned representation is never modified by printing, so this is the same as the const version
+void FileFactory::printFile(InternedFile& file,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+
+	printFileConst(file, stream, direction, iteratorType, filter);
+}
+
+// print odd indexed words in reverse order, reversing each distinct word at most once
+void FileFactory::printOddWordsReverse(const InternedFile& file, std::ostream& stream, const PatternFilter& filter) {
+	// reversed dictionary words, filled in on first use
+	std::vector<std::string> memo(file.vocabularySize());
+	std::vector<bool> done(file.vocabularySize(), false);
+	// memoized words are not moved once computed, so they are queued in place
+	// reversed words must not be matched, so every word is matched here, as stored
+	WordEmitter emitter(stream);
+
+	for (size_t i = 0; i < file.size(); i++) {
+		if (!filter.matches(file[i])) {
+			continue;
+		}
+
+		// words are counted from 1, so even indexes are odd words
+		if (i % 2 == 0) {
+			emitter.add(memoize(file, file.id(i), memo, done, &FileFactory::reverseString));
+		}
+		else {
+			emitter.add(file[i]);
+		}
+	}
+}
+
+// print words in alternating order, first to last, meeting in middle, alternating each distinct word at most once
+void FileFactory::printAlternatingWords(const InternedFile& file, std::ostream& stream, const PatternFilter& filter) {
+	// alternated dictionary words, filled in on first use
+	std::vector<std::string> memo(file.vocabularySize());
+	std::vector<bool> done(file.vocabularySize(), false);
+	WordEmitter emitter(stream);
+
+	size_t front = 0;
+	size_t back = file.size();
+
+	// use two indexes, while front not past back
+	while (front != back) {
+		// decrement back first
+		--back;
+
+		// print the front, words are matched as stored, before they are alternated
+		if (filter.matches(file[front])) {
+			emitter.add(memoize(file, file.id(front), memo, done, &FileFactory::alternateString));
+		}
+		// if not same word, print back
+		if (front != back) {
+			if (filter.matches(file[back])) {
+				emitter.add(memoize(file, file.id(back), memo, done, &FileFactory::alternateString));
+			}
+		}
+		else {
+			break;
+		}
+		// increment front
+		++front;
+	}
+}
+
+// turn contents of interned file into a C-String array
+char** FileFactory::toCStringArray(const InternedFile& file, size_t& size) {
+	size = file.size();
+
+	// characters of the copies, counted only when there is a budget to check them against
+	size_t characters = 0;
+	if (Budget::current() != nullptr) {
+		for (size_t i = 0; i < size; i++) {
+			characters += file[i].length() + 1;
+		}
+	}
 
+	char** result = allocateCStringArray(size, characters);  // allocate memory
+
+	for (size_t i = 0; i < size; i++) {
+		// allocate an element, with space for the null terminator, and copy to array index
+		result[i] = allocateCString(file[i]);
+	}
+
+	// return the result
+	return result;
 }
 
-// read contents of input stream to File object
-File FileFactory::readFileFromStream(std::istream& stream) {
+// read contents of input stream to a PackedFile object
+PackedFile FileFactory::readPackedFileFromStream(std::istream& stream) {
 	std::string line;
 	std::string word;
 
-	File infile;
-
-#if CONTAINER == ARRAY || CONTAINER == FORWARD_LIST
-	int count = 0;
-#endif
+	PackedFile infile;
 
 	// while input remains
 	while (stream) {
-		// read contents of stdin to variable, by line
+		// read contents of stream to variable, by line
 		std::getline(stream, line);
 
 		// if there is an error with the stream, break
 		if (!stream) {
 			break;
 		}
-		
+
+		// the budget is checked a line at a time
+		Budget::checkpoint();
+
 		// else, process word by word
 		std::istringstream iss(line);
 
-		// add the word to the File object
+		// pack the word
 		while (iss >> word) {
-#if CONTAINER == ARRAY
-			infile[count] = word;
-			count++;
-#elif CONTAINER == FORWARD_LIST
-			infile.push_front(word);
-#else
-			infile.push_back(word);
-#endif
+			infile.add(word);
 		}
 	}
 
-	// return the file object
-#if CONTAINER == FORWARD_LIST
-	infile.reverse();
-#endif
+	return infile;
+}
+
+// read a possibly compressed input stream to a PackedFile, tokenized a decompressed block at a time
+PackedFile FileFactory::readPackedFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	PackedFile infile;
+
+	WordTokenizer tokenizer;
+	auto sink = [&infile](const std::string& word) {
+		infile.add(word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
 
+	tokenizer.finish(sink);
 	return infile;
 }
 
-// print contents of file, using const methods
-// specify direction and interator type
-// forward printing with reverse iterators is not allowed and generates an exception
-void FileFactory::printFileConst(const File& file,
-	std::ostream& stream,
-	FileFactory::PrintDirection direction,
-	FileFactory::IteratorType iteratorType) {
-	
-	// determine iterator type
-	switch (iteratorType) {
-		// if normal iterators, support fwd/backward printing
-		case NORMAL:
-			if (direction == FORWARD) {
-				printForwardConst(file, stream);
-			}
-			else {
-				printBackwardConst(file, stream);
-			}
-			break;
-		// reverse iteration is only supported when printing backward
-		case REVERSE:
-			if (direction == FORWARD) {
-				// throw exception
-				throw std::invalid_argument("This is not a supported print operation");
-			}
-			
-			// print backward
-			printBackwardReverseConst(file, stream);
+// read a possibly compressed input stream to a PackedFile, with the grammar's tokenizer
+template <class Grammar>
+PackedFile FileFactory::readPackedFileFromCompressedStream(std::istream& stream, unsigned threads) {
+	PackedFile infile;
 
-			break;
+	GrammarTokenizer<Grammar> tokenizer;
+	auto sink = [&infile](const std::string& word) {
+		infile.add(word);
+	};
+
+	CompressedReader::read(stream, [&tokenizer, &sink](const char* data, size_t length) {
+		tokenizer.feed(data, length, sink);
+	}, threads);
+
+	tokenizer.finish(sink);
+	return infile;
+}
+
+// produce a PackedFile from the contents of file
+PackedFile FileFactory::pack(const File& file) {
+	PackedFile result;
+	File::const_iterator itr;
+	File::const_iterator end = filledEnd(file);
+
+	// begin to end
+	for (itr = file.cbegin(); itr != end; ++itr) {
+		result.add(*itr);
 	}
+
+	return result;
 }
 
-// print contents of file, using non const methods
+// print contents of packed file, using const methods
 // specify direction and interator type
 // forward printing with reverse iterators is not allowed and generates an exception
-void FileFactory::printFile(File& file,
+void FileFactory::printFileConst(const PackedFile& file,
 	std::ostream& stream,
 	FileFactory::PrintDirection direction,
-	FileFactory::IteratorType iteratorType) {
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+
+	WordEmitter emitter(stream, &filter);
 
 	// determine iterator type
 	switch (iteratorType) {
 		// if normal iterators, support fwd/backward printing
 		case NORMAL:
 			if (direction == FORWARD) {
-				printForward(file, stream);
+				for (size_t i = 0; i < file.size(); i++) {
+					emitter.add(file.data(i), file.length(i));
+				}
 			}
 			else {
-				printBackward(file, stream);
+				// i is unsigned, cannot go less than 0 -- start at size and use index - 1
+				for (size_t i = file.size(); i > 0; --i) {
+					emitter.add(file.data(i - 1), file.length(i - 1));
+				}
 			}
 			break;
 		// reverse iteration is only supported when printing backward
@@ -132,122 +1174,95 @@ void FileFactory::printFile(File& file,
 				throw std::invalid_argument("This is not a supported print operation");
 			}
 
-			// print backward
-			printBackwardReverse(file, stream);
+			// print backward, walking the length array with a reverse iterator alongside the index
+			{
+				size_t i = file.size();
+				for (PackedFile::Lengths::const_reverse_iterator itr = file.lengths().crbegin();
+					itr != file.lengths().crend(); ++itr) {
+					--i;
+					emitter.add(file.data(i), *itr);
+				}
+			}
 
 			break;
 	}
 }
 
+// print contents of packed file, using non const methods
+// the packed representation is never modified by printing, so this is the same as the const version
+void FileFactory::printFile(PackedFile& file,
+	std::ostream& stream,
+	FileFactory::PrintDirection direction,
+	FileFactory::IteratorType iteratorType,
+	const PatternFilter& filter) {
+
+	printFileConst(file, stream, direction, iteratorType, filter);
+}
+
 // print odd indexed words in reverse order
-void FileFactory::printOddWordsReverse(const File& file, std::ostream& stream) {
-	File::const_iterator itr;
-	// counter for word number
-	int count = 1;
-	// begin to end
-	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
-		// get string
-		std::string word = *itr;
-		// if odd, revers
-		if (count % 2 == 1) {
-			// call helper function
-			word = reverseString(word);
+void FileFactory::printOddWordsReverse(const PackedFile& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+
+	for (size_t i = 0; i < file.size(); i++) {
+		// words are counted from 1, so even indexes are odd words
+		// transformed words are copied past the emitter's filter, so they are matched here, before the transform
+		if (i % 2 == 0) {
+			if (filter.matches(file.data(i), file.length(i))) {
+				printTransformed(file, i, slotMasks.reverse, &FileFactory::reverseString, emitter);
+			}
+		}
+		else {
+			emitter.add(file.data(i), file.length(i));
 		}
-		// print to stream
-		print(word, stream);
-
-		// increment
-		count++;
 	}
 }
 
 // print words in alternating order, first to last, meeting in middle
-void FileFactory::printAlternatingWords(const File& file, std::ostream& stream) {
-#if CONTAINER == FORWARD_LIST
-	File copy = file;
-	copy.reverse();
-
-	int i = 0;
-	int j = FileFactory::size(file);
-#endif
-
-	File::const_iterator front = file.cbegin();
-	File::const_iterator back =
-#if CONTAINER == FORWARD_LIST
-		copy.cbegin();
-#else
-		file.cend();
-#endif
-
-	std::string word;
+void FileFactory::printAlternatingWords(const PackedFile& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream);
+	size_t front = 0;
+	size_t back = file.size();
 
-	// use two iterators, while front not past back
-#if CONTAINER == FORWARD_LIST
-	while (i != j) {
-#else
+	// use two indexes, while front not past back
 	while (front != back) {
-#endif
 		// decrement back first
-#if CONTAINER != FORWARD_LIST
 		--back;
-#endif
 
-		// alternate the characters
-		word = alternateString(*front);
-		// print the front
-		print(word, stream);
+		// print the front, words are matched before they are alternated
+		if (filter.matches(file.data(front), file.length(front))) {
+			printTransformed(file, front, slotMasks.alternate, &FileFactory::alternateString, emitter);
+		}
 		// if not same word, print back
-#if CONTAINER == FORWARD_LIST
-		if (i != j) {
-#else
 		if (front != back) {
-#endif
-			word = alternateString(*back);
-			print(word, stream);
-#if CONTAINER == FORWARD_LIST
-			--j;
-			++back;
-#endif
+			if (filter.matches(file.data(back), file.length(back))) {
+				printTransformed(file, back, slotMasks.alternate, &FileFactory::alternateString, emitter);
+			}
 		}
 		else {
 			break;
 		}
 		// increment front
 		++front;
-#if CONTAINER == FORWARD_LIST
-		++i;
-#endif
 	}
 }
 
-// turn contents of file into a C-String array
-char** FileFactory::toCStringArray(const File& file, size_t& size) {
-	size_t fileSize =
-		// arrays and forward lists do not provide a 'count' function, so we'll have to calculate it...
-#if CONTAINER == ARRAY || CONTAINER == FORWARD_LIST
-		FileFactory::size(file);
-#else
-		// another method to have done this would be to use the size function implemented below, 
-		// and just have the macro determine if a manual count or a simple return of the implemented size() function should be returned.
-		size = file.size();
-#endif
+// turn contents of packed file into a C-String array
+char** FileFactory::toCStringArray(const PackedFile& file, size_t& size) {
+	size = file.size();
 
+	// characters of the copies, counted only when there is a budget to check them against
+	size_t characters = 0;
+	if (Budget::current() != nullptr) {
+		for (std::uint32_t length : file.lengths()) {
+			characters += length + 1;
+		}
+	}
 
-	char** result = new char*[fileSize];  // allocate memory
-	size = fileSize;
+	char** result = allocateCStringArray(size, characters);  // allocate memory
 
-	// iterator
-	File::const_iterator itr;
-	// index counter
-	int count = 0;
-	// for begin to end
-	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
-		// allocate an element, with space for the null terminator
-		result[count] = new char[(*itr).length() + 1];
-		// copy to array index
-		strncpy(result[count], (*itr).c_str(), (*itr).length() + 1);
-		// increment count
-		count++;
+	for (size_t i = 0; i < size; i++) {
+		// allocate an element, with space for the null terminator, and copy to array index
+		result[i] = allocateCString(file[i]);
 	}
 
 	// return the result
@@ -255,74 +1270,162 @@ char** FileFactory::toCStringArray(const File& file, size_t& size) {
 }
 
 
-// print the contents of a C-string array of specified size in direction specified, using const methods
-void FileFactory::printArrayConst(char** fileArray,
-	const size_t size,
-	std::ostream& stream,
-	FileFactory::PrintDirection direction) {
+/// PRIVATE FUNCTIONS AREA ///
 
-	// if fwd/backward
-	switch (direction) {
-	case FORWARD:
-		// print forward
-		printForwardCStringConst(fileArray, size, stream);
-		break;
-	case BACKWARD:
-		// print backward
-		printBackwardCStringConst(fileArray, size, stream);
-		break;
+// add a word to the end of a file under construction
+void FileFactory::appendWord(File& file, size_t& count, const std::string& word) {
+#if CONTAINER == ARRAY
+	// fixed size, make sure there is room
+	if (count >= file.size()) {
+		throw std::length_error("File is full");
+	}
+	file[count] = word;
+
+	// no allocator sees the word, so its characters are charged here, and stay charged
+	Budget* budget = Budget::current();
+	if (budget != nullptr) {
+		try {
+			budget->charge(Budget::heapBytes(file[count]));
+		}
+		catch (...) {
+			std::string().swap(file[count]);
+			throw;
+		}
 	}
+#elif CONTAINER == FORWARD_LIST
+	// built in reverse, see finishFile
+	file.push_front(word);
+#else
+	file.push_back(word);
+#endif
+	count++;
 }
 
-// print the contents of a C-string array of specified size in direction specified, using non const methods
-void FileFactory::printArray(char** fileArray,
-	const size_t size,
+// finish a file built with appendWord
+void FileFactory::finishFile(File& file) {
+#if CONTAINER == FORWARD_LIST
+	file.reverse();
+#else
+	(void)file;
+#endif
+}
+
+// sort the keys and print their words
+void FileFactory::printKeys(std::vector<WordSorter::Key>& keys,
 	std::ostream& stream,
-	FileFactory::PrintDirection direction) {
+	WordSorter::Order order,
+	bool unique,
+	unsigned threads) {
 
-	// if fwd/backward
-	switch (direction) {
-	case FORWARD:
-		// print forward
-		printForwardCString(fileArray, size, stream);
-		break;
-	case BACKWARD:
-		// print backward
-		printBackwardCString(fileArray, size, stream);
-		break;
+	WordSorter::sort(keys, order, unique, threads);
+
+	WordEmitter emitter(stream);
+	for (const WordSorter::Key& key : keys) {
+		emitter.add(key.data, key.length);
 	}
 }
 
+// print lines first to last - 1, the file is walked once, from the first line's first word
+void FileFactory::printLineRange(const File& file,
+	const LineIndex& lines,
+	size_t first,
+	size_t last,
+	bool reversed,
+	std::ostream& stream) {
+
+	last = std::min(last, lines.lines());
+	if (first > last) {
+		throw std::out_of_range("Line number out of range");
+	}
 
-/// PRIVATE FUNCTIONS AREA ///
+	std::string output;
+	std::vector<const std::string*> words;
+	File::const_iterator itr = file.cbegin();
+	size_t position = 0;
+
+	for (size_t line = first; line < last; line++) {
+		// constant time for random access containers, a step per word otherwise
+		std::advance(itr, lines.first(line) - position);
+		position = lines.first(line);
+
+		appendLine(itr, lines.last(line) - position, reversed, words, output);
+
+		if (output.size() >= WordEmitter::BUFFER_SIZE) {
+			stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+			output.clear();
+		}
+	}
+	stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+}
+
+// add a line to the output, words separated by spaces
+void FileFactory::appendLine(File::const_iterator first,
+	size_t count,
+	bool reversed,
+	std::vector<const std::string*>& words,
+	std::string& output) {
+
+	// gather the line's words, every container can walk them forward
+	words.clear();
+	for (size_t i = 0; i < count; i++, ++first) {
+		words.push_back(&*first);
+	}
+
+	if (reversed) {
+		std::reverse(words.begin(), words.end());
+	}
+
+	for (size_t i = 0; i < words.size(); i++) {
+		if (i > 0) {
+			output += ' ';
+		}
+		output += *words[i];
+	}
+	output += '\n';
+}
 
 // print file contents forward, const
-void FileFactory::printForwardConst(const File& file, std::ostream& stream) {
+void FileFactory::printForwardConst(const File& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
 	File::const_iterator itr;
 
 	// use a forward iterator
 	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
-		print(*itr, stream);
+		emitter.add(*itr);
 	}
 }
 
 // print file contents forward, non const
-void FileFactory::printForward(File& file, std::ostream& stream) {
+void FileFactory::printForward(File& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
 	File::iterator itr;
 
 	// use forward iterator
 	for (itr = file.begin(); itr != file.end(); ++itr) {
-		print(*itr, stream);
+		emitter.add(*itr);
 	}
 }
 
 // print file contents backward, const
-void FileFactory::printBackwardConst(const File& file, std::ostream& stream) {
+void FileFactory::printBackwardConst(const File& file, std::ostream& stream, const PatternFilter& filter) {
 #if CONTAINER == FORWARD_LIST
+	// without room in the budget for the copy, the list is walked a chunk at a time instead
+	if (Budget::current() != nullptr && !Budget::allows(copyBytes(file))) {
+		WordEmitter emitter(stream, &filter);
+		forEachBackward(file.cbegin(), file.cend(), [&emitter](const std::string& word) {
+			emitter.add(word);
+			return true;
+		});
+		return;
+	}
+
 	File copy = file;
 	copy.reverse();
 #endif
 
+	// declared after the copy, so it is flushed while the copy's words are still alive
+	WordEmitter emitter(stream, &filter);
+
 	File::const_iterator itr =
 #if CONTAINER == FORWARD_LIST
 		copy.cbegin();
@@ -341,7 +1444,7 @@ void FileFactory::printBackwardConst(const File& file, std::ostream& stream) {
 		--itr; // decrement first
 #endif
 
-		print(*itr, stream);
+		emitter.add(*itr);
 
 #if CONTAINER == FORWARD_LIST
 		++itr;
@@ -350,12 +1453,25 @@ void FileFactory::printBackwardConst(const File& file, std::ostream& stream) {
 }
 
 // print file contents backward, non const
-void FileFactory::printBackward(File& file, std::ostream& stream) {
+void FileFactory::printBackward(File& file, std::ostream& stream, const PatternFilter& filter) {
 #if CONTAINER == FORWARD_LIST
+	// without room in the budget for the copy, the list is walked a chunk at a time instead
+	if (Budget::current() != nullptr && !Budget::allows(copyBytes(file))) {
+		WordEmitter emitter(stream, &filter);
+		forEachBackward(file.begin(), file.end(), [&emitter](std::string& word) {
+			emitter.add(word);
+			return true;
+		});
+		return;
+	}
+
 	File copy = file;
 	copy.reverse();
 #endif
 
+	// declared after the copy, so it is flushed while the copy's words are still alive
+	WordEmitter emitter(stream, &filter);
+
 	File::iterator itr =
 #if CONTAINER == FORWARD_LIST
 		copy.begin();
@@ -373,7 +1489,7 @@ void FileFactory::printBackward(File& file, std::ostream& stream) {
 		--itr; // decrement first
 #endif
 
-		print(*itr, stream);
+		emitter.add(*itr);
 
 #if CONTAINER == FORWARD_LIST
 		++itr;
@@ -382,108 +1498,148 @@ void FileFactory::printBackward(File& file, std::ostream& stream) {
 }
 
 // print file contents backwards, reverse iterator, const
-void FileFactory::printBackwardReverseConst(const File& file, std::ostream& stream) {
+void FileFactory::printBackwardReverseConst(const File& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
 #if CONTAINER == FORWARD_LIST
-	File::const_iterator itr;
+	// a forward list has no reverse iterators, so its words are gathered and walked with one
+	std::vector<const std::string*> words;
+	for (File::const_iterator word = file.cbegin(); word != file.cend(); ++word) {
+		words.push_back(&*word);
+	}
+	std::vector<const std::string*>::const_reverse_iterator itr;
 #else
 	File::const_reverse_iterator itr;
 #endif
 	// use const reverse iterator
 #if CONTAINER == FORWARD_LIST
-	for (itr = file.cbegin(); itr != file.cend(); ++itr) {
+	for (itr = words.crbegin(); itr != words.crend(); ++itr) {
+		emitter.add(**itr);
+	}
 #else
 	for (itr = file.crbegin(); itr != file.crend(); ++itr) {
-#endif
-		print(*itr, stream);
+		emitter.add(*itr);
 	}
+#endif
 }
 
 // print file contents backwards, reverse iterator, non const
-void FileFactory::printBackwardReverse(File& file, std::ostream& stream) {
+void FileFactory::printBackwardReverse(File& file, std::ostream& stream, const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
 #if CONTAINER == FORWARD_LIST
-	File::iterator itr;
+	// a forward list has no reverse iterators, so its words are gathered and walked with one
+	std::vector<std::string*> words;
+	for (File::iterator word = file.begin(); word != file.end(); ++word) {
+		words.push_back(&*word);
+	}
+	std::vector<std::string*>::reverse_iterator itr;
 #else
 	File::reverse_iterator itr;
 #endif
 	// use a reverse iterator
 #if CONTAINER == FORWARD_LIST
-	for (itr = file.begin(); itr != file.end(); ++itr) {
+	for (itr = words.rbegin(); itr != words.rend(); ++itr) {
+		emitter.add(**itr);
+	}
 #else
 	for (itr = file.rbegin(); itr != file.rend(); ++itr) {
-#endif
-		print(*itr, stream);
+		emitter.add(*itr);
 	}
+#endif
 }
 
 // print C-string array contents forward, const
-void FileFactory::printForwardCStringConst(char** fileArray, const size_t size, std::ostream& stream) {
+void FileFactory::printForwardCStringConst(char** fileArray, const size_t size, std::ostream& stream,
+	const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+
 	for (unsigned int i = 0; i < size; i++) {
 		// use const pointers to print
 		const char* word = fileArray[i];
-		print(word, stream);
+		emitter.add(word);
 	}
 }
 
 // print C-string array contents forward, non-const
-void FileFactory::printForwardCString(char** fileArray, const size_t size, std::ostream& stream) {
+void FileFactory::printForwardCString(char** fileArray, const size_t size, std::ostream& stream,
+	const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+
 	for (unsigned int i = 0; i < size; i++) {
 		// use non-const pointers
 		char* word = fileArray[i];
-		print(word, stream);
+		emitter.add(word);
 	}
 }
 
 // print C-string array contents backward, const
-void FileFactory::printBackwardCStringConst(char** fileArray, const size_t size, std::ostream& stream) {
+void FileFactory::printBackwardCStringConst(char** fileArray, const size_t size, std::ostream& stream,
+	const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+
 	// i is unsigned, cannot go less than 0 -- start at size and use index - 1
 	for (unsigned int i = size; i > 0; --i) {
 		// use const pointers
 		const char* word = fileArray[i-1];
-		print(word, stream);
+		emitter.add(word);
 	}
 }
 
 // print C-string array contents backward, non const
-void FileFactory::printBackwardCString(char** fileArray, const size_t size, std::ostream& stream) {
+void FileFactory::printBackwardCString(char** fileArray, const size_t size, std::ostream& stream,
+	const PatternFilter& filter) {
+	WordEmitter emitter(stream, &filter);
+
 	// i is unsigned, cannot go less than 0 -- start at size and use index - 1
 	for (unsigned int i = size; i > 0; --i) {
 		// use non-const pointers
 		char* word = fileArray[i-1];
-		print(word, stream);
+		emitter.add(word);
 	}
 }
 
-void FileFactory::print(const std::string& word, std::ostream& stream) {
-	if (word != "") {
-		stream << word << std::endl;
-	}
-}
+// helper function to print a transformed packed word
+void FileFactory::printTransformed(const PackedFile& file,
+	size_t index,
+	const unsigned char (*masks)[PackedFile::SLOT_SIZE],
+	std::string (*transform)(const std::string&),
+	WordEmitter& emitter) {
 
-void FileFactory::print(const char* word, std::ostream& stream) {
-	if (strcmp(word, "") != 0) {
-		stream << word << std::endl;
+	size_t length = file.length(index);
+
+	// long words are not in a slot
+	if (!file.isInline(index)) {
+		std::string word = transform(std::string(file.data(index), length));
+		emitter.addCopy(word);
+		return;
 	}
+
+	// permute the whole slot at once, bytes past the word come out as zero
+	alignas(16) char result[PackedFile::SLOT_SIZE];
+	WordKernels::select().shuffleSlot(file.slot(index).bytes, masks[length], result);
+
+	emitter.addCopy(result, length);
 }
 
 // helper function to reverse a std::string, assumes no use of any built-in reversing functions
 std::string FileFactory::reverseString(const std::string& src) {
-	// ostringstream for gathering characters
-	std::ostringstream oss;
+	// result is built in place, sized once, no stream buffer in between
+	std::string result;
+	result.reserve(src.length());
 	// reverse iterator
 	std::string::const_reverse_iterator itr;
 
-	// iterate over the string from the back, add to the string stream
+	// iterate over the string from the back, add to the result
 	for (itr = src.rbegin(); itr != src.rend(); ++itr) {
-		oss << *itr;
+		result.push_back(*itr);
 	}
 
-	// return std::string from the stream
-	return oss.str();
+	return result;
 }
 
 // helper function to alternate the characters in the source string, first, last, second, next-to-last, etc.
 std::string FileFactory::alternateString(const std::string& src) {
-	std::ostringstream oss;
+	std::string result;
+	result.reserve(src.length());
 	// iterators
 	std::string::const_iterator back;
 	std::string::const_iterator front;
@@ -493,10 +1649,10 @@ std::string FileFactory::alternateString(const std::string& src) {
 
 	while (front != back) {
 		--back;
-		oss << *front;
+		result.push_back(*front);
 
 		if (front != back) {
-			oss << *back;
+			result.push_back(*back);
 		}
 		else {
 			break;
@@ -505,7 +1661,58 @@ std::string FileFactory::alternateString(const std::string& src) {
 		++front;
 	}
 
-	return oss.str();
+	return result;
+}
+
+// helper function to allocate an array of C-string pointers, from the current arena if there is one
+// the array is not charged to the budget, it may be freed on another thread, but one that cannot fit its
+// pointers and the characters of its words is refused before anything is allocated
+char** FileFactory::allocateCStringArray(size_t size, size_t characters) {
+	if (!Budget::allows(size * sizeof(char*) + characters)) {
+		throw BudgetExceeded("Memory budget of " + std::to_string(Budget::current()->memoryLimit() / 1024)
+			+ " KB exceeded by a C-string array of " + std::to_string(size) + " words");
+	}
+
+	Arena* arena = Arena::current();
+
+	if (arena != nullptr) {
+		return static_cast<char**>(arena->allocate(size * sizeof(char*), alignof(char*)));
+	}
+
+	return new char*[size];
+}
+
+// helper function to allocate a copy of the word as a C-string, from the current arena if there is one
+char* FileFactory::allocateCString(const std::string& word) {
+	Arena* arena = Arena::current();
+	char* result;
+
+	// space for the null terminator
+	if (arena != nullptr) {
+		result = static_cast<char*>(arena->allocate(word.length() + 1, 1));
+	}
+	else {
+		result = new char[word.length() + 1];
+	}
+
+	strncpy(result, word.c_str(), word.length() + 1);
+
+	return result;
+}
+
+// helper function to look up the transformed form of a dictionary word, the transform runs once per distinct word
+const std::string& FileFactory::memoize(const InternedFile& file,
+	InternedFile::WordId id,
+	std::vector<std::string>& memo,
+	std::vector<bool>& done,
+	std::string (*transform)(const std::string&)) {
+
+	if (!done[id]) {
+		memo[id] = transform(file.word(id));
+		done[id] = true;
+	}
+
+	return memo[id];
 }
 
 #if CONTAINER == ARRAY || CONTAINER == FORWARD_LIST
@@ -519,3 +1726,12 @@ size_t FileFactory::size(const File& file) {
 }
 #endif
 
+// the grammars the readers are built for
+#define FILE_FACTORY_INSTANTIATE(Grammar) \
+	template File FileFactory::readFileFromCompressedStream<Grammar>(std::istream&, unsigned); \
+	template InternedFile FileFactory::readInternedFileFromCompressedStream<Grammar>(std::istream&, unsigned); \
+	template PackedFile FileFactory::readPackedFileFromCompressedStream<Grammar>(std::istream&, unsigned);
+
+FILE_FACTORY_INSTANTIATE(WhitespaceGrammar)
+FILE_FACTORY_INSTANTIATE(CsvGrammar)
+FILE_FACTORY_INSTANTIATE(TextGrammar)
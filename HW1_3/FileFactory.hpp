@@ -37,16 +37,31 @@
 #include <cstring>
 #include <sstream>
 
+
+#include "Arena.hpp"
+#include "Budget.hpp"
+#include "Generator.hpp"
+#include "GrammarTokenizer.hpp"
+#include "InternedFile.hpp"
+#include "LineIndex.hpp"
+#include "PackedFile.hpp"
+#include "PagedReader.hpp"
+#include "PatternFilter.hpp"
+#include "ReverseReader.hpp"
+#include "WordEmitter.hpp"
+#include "WordSorter.hpp"
+
 // type alias
+// containers allocate through ArenaAllocator, which uses the heap unless an ArenaScope is active
 using File =
 #if CONTAINER == VECTOR
-	std::vector<std::string>;
+	std::vector<std::string, ArenaAllocator<std::string> >;
 #elif CONTAINER == DEQUE
-	std::deque<std::string>;
+	std::deque<std::string, ArenaAllocator<std::string> >;
 #elif CONTAINER == LIST
-	std::list<std::string>;
+	std::list<std::string, ArenaAllocator<std::string> >;
 #elif CONTAINER == FORWARD_LIST
-	std::forward_list<std::string>;
+	std::forward_list<std::string, ArenaAllocator<std::string> >;
 #elif CONTAINER == ARRAY
 	std::array<std::string,10000>;
 #else
@@ -70,72 +85,258 @@ public:
 	FileFactory();
 	virtual ~FileFactory();
 
+	// name of the backend chosen by CONTAINER: vector, deque, list, forward_list or array
+	static const char* containerName();
+	// end of the words of the file, for an ARRAY file the first empty slot, since its words fill the slots
+	// from the front, otherwise cend()
+	static File::const_iterator filledEnd(const File& file);
+
 	// read file from stream, return a File object containing words read from stream
 	static File readFileFromStream(std::istream& stream);
+	// read file from a gzip, zstd or uncompressed stream, return a File object containing the decompressed words
+	// decompression is pipelined with tokenizing, threads is the number of zstd frame workers (0 for all cores)
+	static File readFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// read file as readFileFromCompressedStream does, split into tokens by the grammar, see GrammarTokenizer.hpp
+	// instantiated for WhitespaceGrammar, CsvGrammar and TextGrammar
+	template <class Grammar>
+	static File readFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// read file from an uncompressed buffer in memory, return a File object containing its words
+	static File readFileFromBuffer(const char* data, size_t length);
+	// read words first through last - 1 of a paged file, return a File object containing them
+	static File readFileRange(const PagedReader& reader, std::uint64_t first, std::uint64_t last);
+	// read the last count words of a paged file, return a File object containing them
+	static File readFileTail(const PagedReader& reader, std::uint64_t count);
+	// append words to the end of a file that was already read, ARRAY files throw length_error when full
+	static void appendWords(File& file, const std::vector<std::string>& words);
+
+	// read file from a stream, possibly compressed, recording where each line starts in lines in the same pass
+	static File readFileWithLines(std::istream& stream, LineIndex& lines, unsigned threads = 0);
+	// print lines first to last - 1 of the file, words separated by spaces, blank lines kept, last is clamped
+	static void printLines(const File& file,
+		const LineIndex& lines,
+		std::ostream& stream,
+		size_t first = 0,
+		size_t last = static_cast<size_t>(-1));
+	// print the lines of the file last to first
+	static void printLinesBackward(const File& file, const LineIndex& lines, std::ostream& stream);
+	// print the lines of the file with the words of each line reversed
+	static void printLinesWordsReversed(const File& file, const LineIndex& lines, std::ostream& stream);
 
 	// print the contents of the file using const methods, in the direction and iteration method provided
+	// the print functions given a filter print only the words it matches
 	static void printFileConst(const File& file, 
 		std::ostream& stream,
 		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD, 
-		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL);
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
 
 	// print the contents of the file using non-const methods, in the direction and iteration method provided
 	static void printFile(File& file,
 		std::ostream& stream,
 		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
-		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL);
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
 
-	// print the contents of the file where odd words are in reverse
-	static void printOddWordsReverse(const File& file, std::ostream& stream);
-	// print the contents of the file using alternating words, meeting in the middle
-	static void printAlternatingWords(const File& file, std::ostream& stream);
+	// print the contents of the file where odd words are in reverse, words are matched before they are reversed
+	static void printOddWordsReverse(const File& file, std::ostream& stream, const PatternFilter& filter = PatternFilter());
+	// print the contents of the file using alternating words, meeting in the middle, words are matched before
+	// they are alternated
+	static void printAlternatingWords(const File& file, std::ostream& stream, const PatternFilter& filter = PatternFilter());
+	// print the words of the file sorted, each distinct word once if unique, threads is 0 for all cores
+	static void printSorted(const File& file,
+		std::ostream& stream,
+		WordSorter::Order order = WordSorter::LEXICOGRAPHIC,
+		bool unique = false,
+		unsigned threads = 0);
+	// print the words of a file on disk backward, as the backward modes do, without reading it into a File
+	static void printFileBackward(const ReverseReader& reader, std::ostream& stream);
+
+#ifdef FILEFACTORY_HAVE_COROUTINES
+	// words of the stream as they are read, a block at a time as the caller pulls them
+	static Generator<std::string> generateWords(std::istream& stream);
+#ifndef _WIN32
+	// words of a descriptor as they arrive, an empty word means no input is ready yet: wait until the descriptor
+	// is readable and pull again, a non-blocking descriptor never blocks the caller
+	static Generator<std::string> generateWords(int descriptor);
+#endif
+	// the words of the file in the order of the print functions, the file must outlive the generator
+	static Generator<std::string> generateForward(const File& file);
+	static Generator<std::string> generateBackward(const File& file);
+	static Generator<std::string> generateOddWordsReverse(const File& file);
+	static Generator<std::string> generateAlternatingWords(const File& file);
+#endif
 
 	// produce an array of C-strings from supplied file
+	// the array is allocated from the current arena if there is one, release it with freeCStringArray
 	static char** toCStringArray(const File& file, size_t& size);
+	// release an array of C-strings produced by toCStringArray, arena memory is left for the arena to release
+	static void freeCStringArray(char** fileArray, const size_t size);
 
 	// print the contents of a C-string array of given size, in direction provided, using const methods
 	static void printArrayConst(char** fileArray,
 		const size_t size,
 		std::ostream& stream,
-		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD);
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		const PatternFilter& filter = PatternFilter());
 
 	// print the contents of a C-string array of given size, in direction provided, using non-const methods
 	static void printArray(char** fileArray,
 		const size_t size,
 		std::ostream& stream,
-		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD);
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		const PatternFilter& filter = PatternFilter());
+	// print the contents of a C-string array of given size sorted, each distinct word once if unique
+	static void printArraySorted(char** fileArray,
+		const size_t size,
+		std::ostream& stream,
+		WordSorter::Order order = WordSorter::LEXICOGRAPHIC,
+		bool unique = false,
+		unsigned threads = 0);
+
+	// read file from stream, return an InternedFile containing the words read from stream
+	static InternedFile readInternedFileFromStream(std::istream& stream);
+	// read file from a gzip, zstd or uncompressed stream, return an InternedFile containing the decompressed words
+	static InternedFile readInternedFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// read file as readInternedFileFromCompressedStream does, split into tokens by the grammar
+	template <class Grammar>
+	static InternedFile readInternedFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// produce an InternedFile from the supplied file
+	static InternedFile intern(const File& file);
+
+	// print the contents of the interned file using const methods, in the direction and iteration method provided
+	static void printFileConst(const InternedFile& file,
+		std::ostream& stream,
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
+
+	// print the contents of the interned file using non-const methods, in the direction and iteration method provided
+	static void printFile(InternedFile& file,
+		std::ostream& stream,
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
+
+	// print the contents of the interned file where odd words are in reverse, each distinct word is reversed once
+	static void printOddWordsReverse(const InternedFile& file, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+	// print the contents of the interned file using alternating words, each distinct word is alternated once
+	static void printAlternatingWords(const InternedFile& file, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+
+	// produce an array of C-strings from supplied interned file
+	static char** toCStringArray(const InternedFile& file, size_t& size);
+
+	// read file from stream, return a PackedFile containing the words read from stream
+	static PackedFile readPackedFileFromStream(std::istream& stream);
+	// read file from a gzip, zstd or uncompressed stream, return a PackedFile containing the decompressed words
+	static PackedFile readPackedFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// read file as readPackedFileFromCompressedStream does, split into tokens by the grammar
+	template <class Grammar>
+	static PackedFile readPackedFileFromCompressedStream(std::istream& stream, unsigned threads = 0);
+	// produce a PackedFile from the supplied file
+	static PackedFile pack(const File& file);
+
+	// print the contents of the packed file using const methods, in the direction and iteration method provided
+	static void printFileConst(const PackedFile& file,
+		std::ostream& stream,
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
+
+	// print the contents of the packed file using non-const methods, in the direction and iteration method provided
+	static void printFile(PackedFile& file,
+		std::ostream& stream,
+		FileFactory::PrintDirection direction = FileFactory::PrintDirection::FORWARD,
+		FileFactory::IteratorType iteratorType = FileFactory::IteratorType::NORMAL,
+		const PatternFilter& filter = PatternFilter());
+
+	// print the contents of the packed file where odd words are in reverse
+	static void printOddWordsReverse(const PackedFile& file, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+	// print the contents of the packed file using alternating words, meeting in the middle
+	static void printAlternatingWords(const PackedFile& file, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+
+	// produce an array of C-strings from supplied packed file
+	static char** toCStringArray(const PackedFile& file, size_t& size);
 
 // private methods
 private:
+	// add a word to the end of a file under construction, count is the number of words added so far
+	static void appendWord(File& file, size_t& count, const std::string& word);
+	// finish a file built with appendWord
+	static void finishFile(File& file);
+
 	// print file forward, const
-	static void printForwardConst(const File& file, std::ostream& stream);
+	static void printForwardConst(const File& file, std::ostream& stream, const PatternFilter& filter);
 	// print file forward, non const
-	static void printForward(File& file, std::ostream& stream);
+	static void printForward(File& file, std::ostream& stream, const PatternFilter& filter);
 	// print file backward, const
-	static void printBackwardConst(const File& file, std::ostream& stream);
+	static void printBackwardConst(const File& file, std::ostream& stream, const PatternFilter& filter);
 	// print file backward, non const
-	static void printBackward(File& file, std::ostream& stream);
+	static void printBackward(File& file, std::ostream& stream, const PatternFilter& filter);
 	// print file backward, reverse iteration, const
-	static void printBackwardReverseConst(const File& file, std::ostream& stream);
+	static void printBackwardReverseConst(const File& file, std::ostream& stream, const PatternFilter& filter);
 	// print file backward, reverse iteration, non const
-	static void printBackwardReverse(File& file, std::ostream& stream);
+	static void printBackwardReverse(File& file, std::ostream& stream, const PatternFilter& filter);
 
 	// helper function to reverse a std::string (assumes no use of built-in reverse functions)
 	static std::string reverseString(const std::string& src);
 	// helper function to alternate the characters in the source string, first, last, second, next-to-last, etc.
 	static std::string alternateString(const std::string& src);
 	// print c string array forward, const
-	static void printForwardCStringConst(char** fileArray, const size_t size, std::ostream& stream);
+	static void printForwardCStringConst(char** fileArray, const size_t size, std::ostream& stream,
+		const PatternFilter& filter);
 	// print c string array forward, non const
-	static void printForwardCString(char** fileArray, const size_t size, std::ostream& stream);
+	static void printForwardCString(char** fileArray, const size_t size, std::ostream& stream,
+		const PatternFilter& filter);
 	// print c string array backward, const
-	static void printBackwardCStringConst(char** fileArray, const size_t size, std::ostream& stream);
+	static void printBackwardCStringConst(char** fileArray, const size_t size, std::ostream& stream,
+		const PatternFilter& filter);
 	// print c string array backward, non const
-	static void printBackwardCString(char** fileArray, const size_t size, std::ostream& stream);
+	static void printBackwardCString(char** fileArray, const size_t size, std::ostream& stream,
+		const PatternFilter& filter);
+
+	// helper function to print a transformed packed word, inline words are permuted a whole slot at a time
+	// with the shuffle mask for their length, longer words go through the std::string transform
+	static void printTransformed(const PackedFile& file,
+		size_t index,
+		const unsigned char (*masks)[PackedFile::SLOT_SIZE],
+		std::string (*transform)(const std::string&),
+		WordEmitter& emitter);
+
+	// helper function to sort keys and print the words they point to
+	static void printKeys(std::vector<WordSorter::Key>& keys,
+		std::ostream& stream,
+		WordSorter::Order order,
+		bool unique,
+		unsigned threads);
+	// helper function to print lines first to last - 1, with the words of each line reversed if requested
+	static void printLineRange(const File& file,
+		const LineIndex& lines,
+		size_t first,
+		size_t last,
+		bool reversed,
+		std::ostream& stream);
+	// helper function to add count words from first to output as one line, separated by spaces
+	// words is scratch space for reversing them
+	static void appendLine(File::const_iterator first,
+		size_t count,
+		bool reversed,
+		std::vector<const std::string*>& words,
+		std::string& output);
+
+	// helper functions to allocate the C-string array and its strings, from the current arena if there is one
+	static char** allocateCStringArray(size_t size, size_t characters);
+	static char* allocateCString(const std::string& word);
 
-	// print helper functions
-	static void print(const std::string& word, std::ostream& stream);
-	static void print(const char* word, std::ostream& stream);
+	// helper function to look up a transformed dictionary word, computing it on first use only
+	static const std::string& memoize(const InternedFile& file,
+		InternedFile::WordId id,
+		std::vector<std::string>& memo,
+		std::vector<bool>& done,
+		std::string (*transform)(const std::string&));
 
 #if CONTAINER == ARRAY || CONTAINER == FORWARD_LIST
 	static size_t size(const File& file);
@@ -0,0 +1,320 @@
+/**
+* File:		FileFactoryC.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation of the C interface to FileFactory. Every function catches all
+*			exceptions and turns them into a status code and a per-thread error message.
+*/
+
+#include "FileFactoryC.h"
+#include "FileFactory.hpp"
+#include "FileReport.hpp"
+#include "CompressedReader.hpp"
+#include <streambuf>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// a File handle, the words live in the handle's own arena and are released with it
+// the C-string array for the C-string modes is made on first use, once, whichever thread gets there first
+struct filefactory_file {
+	Arena arena;
+	File file;
+	size_t words;
+
+	mutable std::once_flag arrayOnce;
+	mutable char** array;
+	mutable size_t arraySize;
+
+	filefactory_file() : words(0), array(NULL), arraySize(0) {
+	}
+};
+
+namespace {
+
+	// last failure of the calling thread
+	thread_local std::string lastError;
+
+	// read-only stream buffer over the caller's memory, nothing is copied
+	class MemoryStreamBuf : public std::streambuf {
+	public:
+		MemoryStreamBuf(const char* data, size_t length) {
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + length);
+		}
+	}; // end class MemoryStreamBuf
+
+	// stream buffer reading a file descriptor, remembers whether a read failed
+	class FileDescriptorStreamBuf : public std::streambuf {
+	public:
+		explicit FileDescriptorStreamBuf(int fd) : m_fd(fd), m_failed(false), m_buffer(CompressedReader::BLOCK_SIZE) {
+		}
+
+		bool failed() const {
+			return m_failed;
+		}
+
+	protected:
+		int_type underflow() {
+			if (gptr() < egptr()) {
+				return traits_type::to_int_type(*gptr());
+			}
+
+			long count;
+			do {
+#ifdef _WIN32
+				count = _read(m_fd, m_buffer.data(), static_cast<unsigned>(m_buffer.size()));
+#else
+				count = static_cast<long>(::read(m_fd, m_buffer.data(), m_buffer.size()));
+#endif
+			} while (count < 0 && errno == EINTR);
+
+			if (count <= 0) {
+				m_failed = count < 0;
+				return traits_type::eof();
+			}
+
+			setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + count);
+			return traits_type::to_int_type(*gptr());
+		}
+
+	private:
+		int m_fd;
+		bool m_failed;
+		std::vector<char> m_buffer;
+	}; // end class FileDescriptorStreamBuf
+
+	// stream buffer writing into the caller's buffer, output past its end is counted but not stored
+	class BufferStreamBuf : public std::streambuf {
+	public:
+		BufferStreamBuf(char* buffer, size_t capacity) : m_begin(buffer), m_capacity(capacity), m_size(0) {
+		}
+
+		// bytes written, including those that did not fit
+		size_t size() const {
+			return m_size;
+		}
+
+	protected:
+		int_type overflow(int_type c) {
+			if (!traits_type::eq_int_type(c, traits_type::eof())) {
+				char character = traits_type::to_char_type(c);
+				xsputn(&character, 1);
+			}
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char* data, std::streamsize count) {
+			size_t length = static_cast<size_t>(count);
+			if (m_size < m_capacity) {
+				size_t room = m_capacity - m_size;
+				memcpy(m_begin + m_size, data, length < room ? length : room);
+			}
+			m_size += length;
+			return count;
+		}
+
+	private:
+		char* m_begin;
+		size_t m_capacity;
+		size_t m_size;
+	}; // end class BufferStreamBuf
+
+	// record a failure
+	filefactory_status fail(filefactory_status status, const char* message) {
+		lastError = message;
+		return status;
+	}
+
+	// run a function, turning any exception into a status
+	template <class Function>
+	filefactory_status guarded(Function function) {
+		try {
+			return function();
+		}
+		catch (const std::bad_alloc&) {
+			return fail(FILEFACTORY_ERROR_MEMORY, "Out of memory");
+		}
+		catch (const std::length_error& e) {
+			return fail(FILEFACTORY_ERROR_CAPACITY, e.what());
+		}
+		catch (const std::invalid_argument& e) {
+			return fail(FILEFACTORY_ERROR_ARGUMENT, e.what());
+		}
+		catch (const std::out_of_range& e) {
+			return fail(FILEFACTORY_ERROR_ARGUMENT, e.what());
+		}
+		catch (const std::runtime_error& e) {
+			return fail(FILEFACTORY_ERROR_FORMAT, e.what());
+		}
+		catch (const std::exception& e) {
+			return fail(FILEFACTORY_ERROR_INTERNAL, e.what());
+		}
+		catch (...) {
+			return fail(FILEFACTORY_ERROR_INTERNAL, "Unknown error");
+		}
+	}
+
+	// number of words, the ARRAY backend's empty slots are not words
+	size_t countWords(const File& file) {
+		size_t count = 0;
+		for (File::const_iterator itr = file.cbegin(); itr != file.cend(); ++itr) {
+			if (!itr->empty()) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	// make the handle's C-string array, from its arena, on first use
+	void prepareArray(const filefactory_file* file) {
+		std::call_once(file->arrayOnce, [file]() {
+			filefactory_file* handle = const_cast<filefactory_file*>(file);
+			ArenaScope scope(handle->arena);
+			handle->array = FileFactory::toCStringArray(handle->file, handle->arraySize);
+		});
+	}
+
+} // end anonymous namespace
+
+// interface version
+int filefactory_version(void) {
+	return FILEFACTORY_C_VERSION;
+}
+
+// backend chosen by CONTAINER
+const char* filefactory_backend(void) {
+	return FileFactory::containerName();
+}
+
+// plain text is tokenized in place, compressed buffers are decompressed from memory
+filefactory_status filefactory_create_from_buffer(const char* data, size_t length, filefactory_file** file) {
+	if (file == NULL || (data == NULL && length != 0)) {
+		return fail(FILEFACTORY_ERROR_ARGUMENT, "Null argument");
+	}
+	*file = NULL;
+
+	return guarded([&]() {
+		std::unique_ptr<filefactory_file> handle(new filefactory_file());
+
+		{
+			ArenaScope scope(handle->arena);
+
+			if (CompressedReader::detectFormat(data, length) == CompressedReader::PLAIN) {
+				handle->file = FileFactory::readFileFromBuffer(data, length);
+			}
+			else {
+				MemoryStreamBuf buffer(data, length);
+				std::istream stream(&buffer);
+				handle->file = FileFactory::readFileFromCompressedStream(stream);
+			}
+		}
+
+		handle->words = countWords(handle->file);
+		*file = handle.release();
+		return FILEFACTORY_OK;
+	});
+}
+
+// read the descriptor through a stream buffer, decompressing as it arrives
+filefactory_status filefactory_create_from_fd(int fd, filefactory_file** file) {
+	if (file == NULL || fd < 0) {
+		return fail(FILEFACTORY_ERROR_ARGUMENT, "Invalid argument");
+	}
+	*file = NULL;
+
+	return guarded([&]() {
+		std::unique_ptr<filefactory_file> handle(new filefactory_file());
+		FileDescriptorStreamBuf buffer(fd);
+
+		{
+			ArenaScope scope(handle->arena);
+			std::istream stream(&buffer);
+			handle->file = FileFactory::readFileFromCompressedStream(stream);
+		}
+
+		if (buffer.failed()) {
+			return fail(FILEFACTORY_ERROR_IO, "Unable to read file descriptor");
+		}
+
+		handle->words = countWords(handle->file);
+		*file = handle.release();
+		return FILEFACTORY_OK;
+	});
+}
+
+// words counted at creation
+size_t filefactory_word_count(const filefactory_file* file) {
+	return file != NULL ? file->words : 0;
+}
+
+// print straight into the caller's buffer, measuring the output in the same pass
+filefactory_status filefactory_print(const filefactory_file* file,
+	filefactory_mode mode,
+	char* buffer,
+	size_t capacity,
+	size_t* written) {
+
+	if (file == NULL || written == NULL || (buffer == NULL && capacity != 0)) {
+		return fail(FILEFACTORY_ERROR_ARGUMENT, "Null argument");
+	}
+	if (mode < FILEFACTORY_MODE_CONST_FORWARD || mode > FILEFACTORY_MODE_REPORT) {
+		return fail(FILEFACTORY_ERROR_ARGUMENT, "Unknown print mode");
+	}
+	*written = 0;
+
+	return guarded([&]() {
+		if (mode >= FILEFACTORY_MODE_CSTRING_CONST_FORWARD) {
+			prepareArray(file);
+		}
+
+		BufferStreamBuf output(buffer, capacity);
+		std::ostream stream(&output);
+
+		if (mode == FILEFACTORY_MODE_REPORT) {
+			for (size_t section = 0; section < FileReport::SECTION_COUNT; section++) {
+				FileReport::writeSection(file->file, file->array, file->arraySize, section, stream);
+			}
+		}
+		else {
+			FileReport::printSection(file->file, file->array, file->arraySize, static_cast<size_t>(mode), stream);
+		}
+
+		stream.flush();
+		*written = output.size();
+
+		if (output.size() > capacity) {
+			return fail(FILEFACTORY_ERROR_BUFFER_TOO_SMALL, "Output larger than the buffer");
+		}
+		return FILEFACTORY_OK;
+	});
+}
+
+// the C-string array and the words go with the handle's arena
+void filefactory_free(filefactory_file* file) {
+	if (file == NULL) {
+		return;
+	}
+
+	if (file->array != NULL) {
+		ArenaScope scope(file->arena);
+		FileFactory::freeCStringArray(file->array, file->arraySize);
+	}
+	delete file;
+}
+
+// last failure of this thread
+const char* filefactory_last_error(void) {
+	return lastError.c_str();
+}
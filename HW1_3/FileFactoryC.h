@@ -0,0 +1,103 @@
+/**
+* File:		FileFactoryC.h
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the C interface to FileFactory, for programs in other languages that load it as a shared
+*			library (Python ctypes/cffi, Go cgo, etc.) and call it in-process instead of running the program once per
+*			input. A File is created from a buffer or a file descriptor, printed in any mode into a buffer supplied
+*			by the caller, and freed. No C++ exception crosses this interface: every function returns a status, and
+*			filefactory_last_error() describes the last failure on the calling thread.
+*
+*			Input buffers are tokenized in place, without an intermediate copy, and output is written directly to
+*			the caller's buffer. A File may be printed from several threads at once.
+*/
+
+#ifndef FILE_FACTORY_C_H
+#define FILE_FACTORY_C_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(FILEFACTORY_C_BUILD)
+#define FILEFACTORY_API __declspec(dllexport)
+#elif defined(FILEFACTORY_C_BUILD)
+#define FILEFACTORY_API __attribute__((visibility("default")))
+#else
+#define FILEFACTORY_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* version of this interface, changed only when existing functions change */
+#define FILEFACTORY_C_VERSION 1
+
+/* opaque File handle */
+typedef struct filefactory_file filefactory_file;
+
+/* status codes */
+typedef enum filefactory_status {
+	FILEFACTORY_OK = 0,
+	FILEFACTORY_ERROR_ARGUMENT = 1,			/* null handle or pointer, unknown mode */
+	FILEFACTORY_ERROR_IO = 2,				/* the file descriptor could not be read */
+	FILEFACTORY_ERROR_FORMAT = 3,			/* corrupt compressed input, or a compression not built in */
+	FILEFACTORY_ERROR_MEMORY = 4,			/* out of memory */
+	FILEFACTORY_ERROR_CAPACITY = 5,			/* more words than the backend holds (the ARRAY backend) */
+	FILEFACTORY_ERROR_BUFFER_TOO_SMALL = 6,	/* the output did not fit, the required size is returned */
+	FILEFACTORY_ERROR_INTERNAL = 7
+} filefactory_status;
+
+/* print modes, the sections of the report in report order, then the whole report */
+typedef enum filefactory_mode {
+	FILEFACTORY_MODE_CONST_FORWARD = 0,
+	FILEFACTORY_MODE_CONST_BACKWARD = 1,
+	FILEFACTORY_MODE_FORWARD = 2,
+	FILEFACTORY_MODE_BACKWARD = 3,
+	FILEFACTORY_MODE_CONST_BACKWARD_REVERSE = 4,
+	FILEFACTORY_MODE_BACKWARD_REVERSE = 5,
+	FILEFACTORY_MODE_ODD_WORDS_REVERSE = 6,
+	FILEFACTORY_MODE_ALTERNATING_WORDS = 7,
+	FILEFACTORY_MODE_CSTRING_CONST_FORWARD = 8,
+	FILEFACTORY_MODE_CSTRING_CONST_BACKWARD = 9,
+	FILEFACTORY_MODE_CSTRING_FORWARD = 10,
+	FILEFACTORY_MODE_CSTRING_BACKWARD = 11,
+	FILEFACTORY_MODE_REPORT = 12				/* every section under its title line, as the program prints it */
+} filefactory_mode;
+
+/* FILEFACTORY_C_VERSION of the loaded library */
+FILEFACTORY_API int filefactory_version(void);
+
+/* container backend of the loaded library: "vector", "deque", "list", "forward_list" or "array" */
+FILEFACTORY_API const char* filefactory_backend(void);
+
+/* create a File from the words of a buffer, gzip and zstd buffers are decompressed */
+/* the buffer is only read during the call */
+FILEFACTORY_API filefactory_status filefactory_create_from_buffer(const char* data, size_t length, filefactory_file** file);
+
+/* create a File from everything readable from a file descriptor, gzip and zstd input is decompressed */
+/* the descriptor is read to its end and left open */
+FILEFACTORY_API filefactory_status filefactory_create_from_fd(int fd, filefactory_file** file);
+
+/* number of words in the File */
+FILEFACTORY_API size_t filefactory_word_count(const filefactory_file* file);
+
+/* print the File in the mode into buffer, which holds capacity bytes, the output is not null terminated */
+/* *written is set to the size of the output; if it is larger than capacity, the first capacity bytes are */
+/* written and FILEFACTORY_ERROR_BUFFER_TOO_SMALL is returned, so a null buffer and zero capacity query the size */
+FILEFACTORY_API filefactory_status filefactory_print(const filefactory_file* file,
+	filefactory_mode mode,
+	char* buffer,
+	size_t capacity,
+	size_t* written);
+
+/* free a File, null is ignored */
+FILEFACTORY_API void filefactory_free(filefactory_file* file);
+
+/* description of the last failure on the calling thread, empty if there was none */
+FILEFACTORY_API const char* filefactory_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,325 @@
+/**
+* File:		FileReport.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a FileReport class, that writes the sections of the FileFactory
+*			report. Every section after the first starts with a blank line, so sections concatenate to the report.
+*/
+
+#include "FileReport.hpp"
+#include "CompressedWriter.hpp"
+#include "SectionRouter.hpp"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// section titles, in report order
+static const char* const SECTION_TITLES[FileReport::SECTION_COUNT] = {
+	"Const - Forward - Normal Iterator",
+	"Const - Backward - Normal Iterator",
+	"Forward - Normal Iterator",
+	"Backward - Normal Iterator",
+	"Const - Backward - Reverse Iterator",
+	"Backward - Reverse Iterator",
+	"Odd words in reverse",
+	"Alternating words",
+	"Const C-Strings - Forward",
+	"Const C-Strings - Backward",
+	"C-Strings - Forward",
+	"C-Strings - Backward"
+};
+
+// empty
+FileReport::FileReport() {
+
+}
+
+// empty
+FileReport::~FileReport() {
+
+}
+
+// title of the section
+const char* FileReport::title(size_t section) {
+	if (section >= SECTION_COUNT) {
+		throw std::out_of_range("No such report section");
+	}
+
+	return SECTION_TITLES[section];
+}
+
+// write one section, with its title line
+template <class Words>
+void FileReport::writeSection(const Words& file, char** fileArray, size_t size, size_t section, std::ostream& stream,
+	const PatternFilter& filter) {
+	// sections are separated by a blank line
+	if (section > 0) {
+		stream << "\n";
+	}
+	stream << title(section) << std::endl;
+
+	printSection(file, fileArray, size, section, stream, filter);
+}
+
+// print the words of one section, each section is one print mode
+template <class Words>
+void FileReport::printSection(const Words& file, char** fileArray, size_t size, size_t section, std::ostream& stream,
+	const PatternFilter& filter) {
+	// the non-const modes iterate with non-const iterators but never modify the words,
+	// so any File, including a shared snapshot, can be printed in every mode
+	Words& words = const_cast<Words&>(file);
+
+	switch (section) {
+	case 0:
+		// print forward - const
+		FileFactory::printFileConst(file, stream, FileFactory::PrintDirection::FORWARD, FileFactory::IteratorType::NORMAL, filter);
+		break;
+	case 1:
+		// print backward - const
+		FileFactory::printFileConst(file, stream, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::NORMAL, filter);
+		break;
+	case 2:
+		// print forward - non const
+		FileFactory::printFile(words, stream, FileFactory::PrintDirection::FORWARD, FileFactory::IteratorType::NORMAL, filter);
+		break;
+	case 3:
+		// print backward - non const
+		FileFactory::printFile(words, stream, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::NORMAL, filter);
+		break;
+	case 4:
+		// print backward - reverse iteration - const
+		FileFactory::printFileConst(file, stream, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::REVERSE, filter);
+		break;
+	case 5:
+		// print backward - reverse iteration - non const
+		FileFactory::printFile(words, stream, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::REVERSE, filter);
+		break;
+	case 6:
+		// print odd words in reverse
+		FileFactory::printOddWordsReverse(file, stream, filter);
+		break;
+	case 7:
+		// print alternating words
+		FileFactory::printAlternatingWords(file, stream, filter);
+		break;
+	case 8:
+		// print c-string array foward - const
+		FileFactory::printArrayConst(fileArray, size, stream, FileFactory::PrintDirection::FORWARD, filter);
+		break;
+	case 9:
+		// print c-string array backward - const
+		FileFactory::printArrayConst(fileArray, size, stream, FileFactory::PrintDirection::BACKWARD, filter);
+		break;
+	case 10:
+		// print c-string array foward - non const
+		FileFactory::printArray(fileArray, size, stream, FileFactory::PrintDirection::FORWARD, filter);
+		break;
+	case 11:
+		// print c-string array backward - non const
+		FileFactory::printArray(fileArray, size, stream, FileFactory::PrintDirection::BACKWARD, filter);
+		break;
+	default:
+		throw std::out_of_range("No such report section");
+	}
+}
+
+// write all sections
+template <class Words>
+void FileReport::write(const Words& file, std::ostream& stream, const PatternFilter& filter) {
+	// construct a c-string array from File
+	size_t size;
+	char** fileArray = FileFactory::toCStringArray(file, size);
+
+	try {
+		for (size_t section = 0; section < SECTION_COUNT; section++) {
+			writeSection(file, fileArray, size, section, stream, filter);
+		}
+	}
+	catch (...) {
+		FileFactory::freeCStringArray(fileArray, size);
+		throw;
+	}
+
+	// clean up
+	FileFactory::freeCStringArray(fileArray, size);
+}
+
+// write all sections, each a phase, the stream is flushed inside the phase so its writes are counted too
+template <class Words>
+void FileReport::writeProfiled(const Words& file,
+	std::ostream& stream,
+	PerfCounters& counters,
+	std::vector<std::pair<std::string, PerfCounters::Sample> >& phases,
+	const PatternFilter& filter) {
+
+	// construct a c-string array from File
+	counters.start();
+	size_t size;
+	char** fileArray = FileFactory::toCStringArray(file, size);
+	phases.push_back(std::make_pair(std::string("C-string array"), counters.stop()));
+
+	try {
+		for (size_t section = 0; section < SECTION_COUNT; section++) {
+			counters.start();
+			writeSection(file, fileArray, size, section, stream, filter);
+			stream.flush();
+			phases.push_back(std::make_pair(std::string(title(section)), counters.stop()));
+		}
+	}
+	catch (...) {
+		FileFactory::freeCStringArray(fileArray, size);
+		throw;
+	}
+
+	// clean up
+	counters.start();
+	FileFactory::freeCStringArray(fileArray, size);
+	phases.push_back(std::make_pair(std::string("free C-string array"), counters.stop()));
+}
+
+// write all sections, compressed
+template <class Words>
+void FileReport::writeCompressed(const Words& file, std::ostream& stream, unsigned threads,
+	const PatternFilter& filter) {
+	// construct a c-string array from File, shared read-only by the section workers
+	size_t size;
+	char** fileArray = FileFactory::toCStringArray(file, size);
+
+	std::vector<std::string> titles;
+	std::vector<CompressedWriter::SectionRenderer> renderers;
+
+	for (size_t section = 0; section < SECTION_COUNT; section++) {
+		titles.push_back(title(section));
+		renderers.push_back([&file, fileArray, size, section, &filter](std::ostream& out) {
+			writeSection(file, fileArray, size, section, out, filter);
+		});
+	}
+
+	try {
+		CompressedWriter::write(stream, titles, renderers, threads);
+	}
+	catch (...) {
+		FileFactory::freeCStringArray(fileArray, size);
+		throw;
+	}
+
+	// clean up
+	FileFactory::freeCStringArray(fileArray, size);
+}
+
+// routed sections on a pool of workers, each takes the next routed section not yet started
+// the outputs are all opened first, so a bad route fails before anything is written
+template <class Words>
+void FileReport::writeRouted(const Words& file, const SectionRouter& router, std::ostream& stream, unsigned threads,
+	const PatternFilter& filter) {
+
+	std::vector<size_t> routed;
+	std::vector<std::unique_ptr<std::ostream> > outputs;
+	for (size_t section = 0; section < SECTION_COUNT; section++) {
+		if (router.routed(section)) {
+			outputs.push_back(router.open(section));
+			routed.push_back(section);
+		}
+	}
+
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+	if (threads > routed.size()) {
+		threads = static_cast<unsigned>(routed.size());
+	}
+
+	// construct a c-string array from File, shared read-only by the workers
+	size_t size;
+	char** fileArray = FileFactory::toCStringArray(file, size);
+
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex mutex;
+
+	// the workers work within the caller's budget
+	Budget* budget = Budget::current();
+
+	auto work = [&]() {
+		BudgetScope budgetScope(budget);
+		for (size_t job = next++; job < routed.size(); job = next++) {
+			try {
+				std::ostream& out = *outputs[job];
+				printSection(file, fileArray, size, routed[job], out, filter);
+				out.flush();
+				if (!out) {
+					throw std::runtime_error("Unable to write " + router.target(routed[job]));
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		}
+	};
+
+	// the workers start on the routed sections while this thread writes the others
+	std::vector<std::thread> workers;
+	for (unsigned w = 0; w < threads; w++) {
+		workers.push_back(std::thread(work));
+	}
+
+	try {
+		bool first = true;
+		for (size_t section = 0; section < SECTION_COUNT; section++) {
+			if (router.routed(section)) {
+				continue;
+			}
+
+			// sections left in the report are still separated by a blank line
+			if (!first) {
+				stream << "\n";
+			}
+			stream << title(section) << std::endl;
+			printSection(file, fileArray, size, section, stream, filter);
+			first = false;
+		}
+		stream.flush();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!error) {
+			error = std::current_exception();
+		}
+	}
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// clean up
+	FileFactory::freeCStringArray(fileArray, size);
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+// the layouts a report is written from
+#define FILE_REPORT_INSTANTIATE(Words) \
+	template void FileReport::writeSection<Words>(const Words&, char**, size_t, size_t, std::ostream&, \
+		const PatternFilter&); \
+	template void FileReport::printSection<Words>(const Words&, char**, size_t, size_t, std::ostream&, \
+		const PatternFilter&); \
+	template void FileReport::write<Words>(const Words&, std::ostream&, const PatternFilter&); \
+	template void FileReport::writeProfiled<Words>(const Words&, std::ostream&, PerfCounters&, \
+		std::vector<std::pair<std::string, PerfCounters::Sample> >&, const PatternFilter&); \
+	template void FileReport::writeCompressed<Words>(const Words&, std::ostream&, unsigned, const PatternFilter&); \
+	template void FileReport::writeRouted<Words>(const Words&, const SectionRouter&, std::ostream&, unsigned, \
+		const PatternFilter&);
+
+FILE_REPORT_INSTANTIATE(File)
+FILE_REPORT_INSTANTIATE(InternedFile)
+FILE_REPORT_INSTANTIATE(PackedFile)
@@ -0,0 +1,71 @@
+/**
+* File:		FileReport.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a FileReport class, that describes the sections of the full
+*			FileFactory report (each print mode under a title line) and writes them, one at a time or all together.
+*			Writing the sections back to back produces exactly the report printed by main. Given a filter, every
+*			section prints only the words it matches.
+*
+*			The report is written from any of the File layouts: Words is File, InternedFile or PackedFile, and
+*			all three print the same report.
+*/
+
+#ifndef FILE_REPORT_HPP
+#define FILE_REPORT_HPP
+
+// includes
+#include "FileFactory.hpp"
+#include "PerfCounters.hpp"
+
+class SectionRouter;
+
+// class definition
+class FileReport {
+public:
+	// number of sections in the report
+	static const size_t SECTION_COUNT = 12;
+
+	// constructor/destructor
+	FileReport();
+	virtual ~FileReport();
+
+	// title of the section
+	static const char* title(size_t section);
+
+	// write one section, including its title line, fileArray/size is the C-string array produced from file
+	template <class Words>
+	static void writeSection(const Words& file, char** fileArray, size_t size, size_t section, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+	// print the words of one section, without its title line
+	template <class Words>
+	static void printSection(const Words& file, char** fileArray, size_t size, size_t section, std::ostream& stream,
+		const PatternFilter& filter = PatternFilter());
+
+	// write all sections of the report, in order
+	template <class Words>
+	static void write(const Words& file, std::ostream& stream, const PatternFilter& filter = PatternFilter());
+
+	// write all sections of the report, measuring each with counters, the C-string array's construction and
+	// release are phases too, the phases are appended to phases
+	template <class Words>
+	static void writeProfiled(const Words& file,
+		std::ostream& stream,
+		PerfCounters& counters,
+		std::vector<std::pair<std::string, PerfCounters::Sample> >& phases,
+		const PatternFilter& filter = PatternFilter());
+
+	// write all sections of the report as a seekable compressed file, one gzip member per section
+	// sections are rendered and compressed in parallel, threads is the number of workers (0 for all cores)
+	template <class Words>
+	static void writeCompressed(const Words& file, std::ostream& stream, unsigned threads = 0,
+		const PatternFilter& filter = PatternFilter());
+
+	// write the sections routed by router to their own outputs, concurrently on threads workers (0 for all
+	// cores), and the rest of the report to stream, in order, on the calling thread
+	template <class Words>
+	static void writeRouted(const Words& file, const SectionRouter& router, std::ostream& stream, unsigned threads = 0,
+		const PatternFilter& filter = PatternFilter());
+}; // end class FileReport
+
+#endif
@@ -0,0 +1,453 @@
+/**
+* File:		FileServer.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a FileServer class, that serves FileFactory reports over a Unix
+*			domain socket from a cache of parsed files.
+*/
+
+#include "FileServer.hpp"
+#include "FileReport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	// how often the accepting thread checks whether the server is stopping, in milliseconds
+	const int POLL_INTERVAL = 200;
+
+#ifndef _WIN32
+	// send all of data, false if the client went away
+	bool sendAll(int connection, const char* data, size_t length) {
+#ifdef MSG_NOSIGNAL
+		const int flags = MSG_NOSIGNAL;
+#else
+		const int flags = 0;
+#endif
+		while (length > 0) {
+			ssize_t sent = ::send(connection, data, length, flags);
+			if (sent < 0 && errno == EINTR) {
+				continue;
+			}
+			if (sent <= 0) {
+				return false;
+			}
+			data += sent;
+			length -= static_cast<size_t>(sent);
+		}
+		return true;
+	}
+#endif
+
+	// split a comma separated list of section numbers, or "all"
+	std::vector<size_t> parseSections(const std::string& sections) {
+		std::vector<size_t> result;
+
+		if (sections == "all") {
+			for (size_t section = 0; section < FileReport::SECTION_COUNT; section++) {
+				result.push_back(section);
+			}
+			return result;
+		}
+
+		std::istringstream list(sections);
+		std::string item;
+		while (std::getline(list, item, ',')) {
+			char* end = nullptr;
+			unsigned long section = std::strtoul(item.c_str(), &end, 10);
+			if (item.empty() || *end != '\0' || section >= FileReport::SECTION_COUNT) {
+				throw std::invalid_argument("No such report section: " + item);
+			}
+			result.push_back(section);
+		}
+
+		// printed in report order, each once
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+		return result;
+	}
+
+} // end anonymous namespace
+
+// nothing is opened until run
+FileServer::FileServer(const std::string& socketPath, unsigned threads, size_t cacheCapacity)
+	: m_socketPath(socketPath),
+	m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+	m_cache(cacheCapacity),
+	m_stopping(false),
+	m_requests(0),
+	m_errors(0),
+	m_latencyNext(0) {
+
+	m_wake[0] = -1;
+	m_wake[1] = -1;
+}
+
+// empty
+FileServer::~FileServer() {
+
+}
+
+#ifdef _WIN32
+
+// Unix domain sockets are not available
+void FileServer::run() {
+	throw std::runtime_error("The server needs Unix domain sockets");
+}
+
+#else
+
+// accept connections and wait for requests on the calling thread, the request threads answer them
+void FileServer::run() {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Socket path too long: " + m_socketPath);
+	}
+	strcpy(address.sun_path, m_socketPath.c_str());
+
+	int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		throw std::runtime_error("Unable to create a socket");
+	}
+
+	// a socket left behind by a previous server is replaced
+	::unlink(m_socketPath.c_str());
+	if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 128) != 0) {
+		::close(listener);
+		throw std::runtime_error("Unable to listen on " + m_socketPath);
+	}
+	if (::pipe(m_wake) != 0) {
+		::close(listener);
+		throw std::runtime_error("Unable to create a pipe");
+	}
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < m_threads; i++) {
+		workers.emplace_back(&FileServer::work, this);
+	}
+
+	// connections waiting for their next request
+	std::vector<Connection> idle;
+
+	while (!m_stopping) {
+		std::vector<pollfd> polled;
+		polled.push_back(pollfd{ listener, POLLIN, 0 });
+		polled.push_back(pollfd{ m_wake[0], POLLIN, 0 });
+		for (const Connection& connection : idle) {
+			polled.push_back(pollfd{ connection.socket, POLLIN, 0 });
+		}
+
+		if (::poll(polled.data(), polled.size(), POLL_INTERVAL) <= 0) {
+			continue;
+		}
+
+		// connections with data, or closed by the client, go to the request threads
+		std::vector<Connection> waiting;
+		{
+			std::lock_guard<std::mutex> lock(m_readyMutex);
+			for (size_t i = 0; i < idle.size(); i++) {
+				if (polled[i + 2].revents != 0) {
+					m_ready.push_back(std::move(idle[i]));
+					m_readyCondition.notify_one();
+				}
+				else {
+					waiting.push_back(std::move(idle[i]));
+				}
+			}
+		}
+		idle.swap(waiting);
+
+		// connections released by the request threads wait here again
+		if (polled[1].revents != 0) {
+			char drain[256];
+			if (::read(m_wake[0], drain, sizeof(drain)) > 0) {
+				std::lock_guard<std::mutex> lock(m_releasedMutex);
+				for (Connection& connection : m_released) {
+					idle.push_back(std::move(connection));
+				}
+				m_released.clear();
+			}
+		}
+
+		if (polled[0].revents != 0) {
+			int socket = ::accept(listener, nullptr, nullptr);
+			if (socket >= 0) {
+#ifdef SO_NOSIGPIPE
+				int on = 1;
+				::setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+				idle.push_back(Connection{ socket, std::string() });
+			}
+		}
+	}
+
+	// wake the request threads, they finish the requests in hand and return
+	{
+		std::lock_guard<std::mutex> lock(m_readyMutex);
+		m_readyCondition.notify_all();
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	for (const Connection& connection : idle) {
+		::close(connection.socket);
+	}
+	for (const Connection& connection : m_ready) {
+		::close(connection.socket);
+	}
+	for (const Connection& connection : m_released) {
+		::close(connection.socket);
+	}
+	m_ready.clear();
+	m_released.clear();
+
+	::close(m_wake[0]);
+	::close(m_wake[1]);
+	::close(listener);
+	::unlink(m_socketPath.c_str());
+}
+
+#endif
+
+// only sets a lock-free flag, which is what makes it safe in a signal handler
+void FileServer::stop() {
+	m_stopping = true;
+}
+
+// parse the request line and answer it, failures become ERROR responses
+std::string FileServer::respond(const std::string& request) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::string response;
+	bool printed = false;
+
+	try {
+		std::istringstream line(request);
+		std::string command;
+		line >> command;
+
+		if (command == "PRINT") {
+			std::string sections;
+			std::string path;
+			line >> sections;
+			std::getline(line >> std::ws, path);
+			if (sections.empty() || path.empty()) {
+				throw std::invalid_argument("usage: PRINT <sections> <path>");
+			}
+
+			response = print(sections, path);
+			printed = true;
+		}
+		else if (command == "STATS") {
+			response = stats();
+		}
+		else {
+			throw std::invalid_argument("Unknown request: " + command);
+		}
+
+		response = "OK " + std::to_string(response.size()) + "\n" + response;
+	}
+	catch (const std::exception& e) {
+		// one line, whatever the message holds
+		std::string message = e.what();
+		std::replace(message.begin(), message.end(), '\n', ' ');
+		response = "ERROR " + message + "\n";
+
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		m_errors++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		m_requests++;
+	}
+
+	if (printed) {
+		recordLatency(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count()));
+	}
+
+	return response;
+}
+
+// counters, cache hit rate and latency percentiles, one "name value" line each
+std::string FileServer::stats() const {
+	std::vector<std::uint64_t> latencies;
+	std::uint64_t requests;
+	std::uint64_t errors;
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		latencies = m_latencies;
+		requests = m_requests;
+		errors = m_errors;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	std::uint64_t hits = m_cache.hits();
+	std::uint64_t misses = m_cache.misses();
+
+	// nearest rank percentile
+	auto percentile = [&latencies](unsigned p) -> std::uint64_t {
+		if (latencies.empty()) {
+			return 0;
+		}
+		size_t rank = (latencies.size() * p + 99) / 100;
+		return latencies[rank > 0 ? rank - 1 : 0];
+	};
+
+	std::ostringstream out;
+	out << "requests " << requests << "\n"
+		<< "errors " << errors << "\n"
+		<< "threads " << m_threads << "\n"
+		<< "cache_entries " << m_cache.size() << "\n"
+		<< "cache_capacity " << m_cache.capacity() << "\n"
+		<< "cache_hits " << hits << "\n"
+		<< "cache_misses " << misses << "\n"
+		<< "cache_hit_rate " << std::fixed << std::setprecision(3)
+		<< (hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0) << "\n"
+		<< "latency_samples " << latencies.size() << "\n"
+		<< "latency_p50_us " << percentile(50) << "\n"
+		<< "latency_p90_us " << percentile(90) << "\n"
+		<< "latency_p99_us " << percentile(99) << "\n"
+		<< "latency_max_us " << (latencies.empty() ? 0 : latencies.back()) << "\n";
+	return out.str();
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// take connections with data until the server stops
+void FileServer::work() {
+	while (true) {
+		Connection connection;
+		{
+			std::unique_lock<std::mutex> lock(m_readyMutex);
+			m_readyCondition.wait(lock, [this]() {
+				return m_stopping || !m_ready.empty();
+			});
+			if (m_stopping) {
+				return;
+			}
+
+			connection = std::move(m_ready.front());
+			m_ready.pop_front();
+		}
+
+		if (serve(connection)) {
+			release(connection);
+		}
+		else {
+#ifndef _WIN32
+			::close(connection.socket);
+#endif
+		}
+	}
+}
+
+#ifdef _WIN32
+
+// never called, run throws first
+bool FileServer::serve(Connection& connection) {
+	(void)connection;
+	return false;
+}
+
+// never called, run throws first
+void FileServer::release(const Connection& connection) {
+	(void)connection;
+}
+
+#else
+
+// one read, the connection is known to have data, then every complete line is answered in turn
+bool FileServer::serve(Connection& connection) {
+	char buffer[4096];
+	ssize_t received;
+	do {
+		received = ::recv(connection.socket, buffer, sizeof(buffer), 0);
+	} while (received < 0 && errno == EINTR);
+
+	if (received <= 0) {
+		return false;
+	}
+	connection.pending.append(buffer, static_cast<size_t>(received));
+
+	size_t newline;
+	while ((newline = connection.pending.find('\n')) != std::string::npos) {
+		std::string request = connection.pending.substr(0, newline);
+		connection.pending.erase(0, newline + 1);
+		if (!request.empty() && request.back() == '\r') {
+			request.pop_back();
+		}
+
+		std::string response = respond(request);
+		if (!sendAll(connection.socket, response.data(), response.size())) {
+			return false;
+		}
+	}
+
+	if (connection.pending.size() > MAX_REQUEST) {
+		std::string response = "ERROR Request too long\n";
+		sendAll(connection.socket, response.data(), response.size());
+		return false;
+	}
+
+	return true;
+}
+
+// queue the connection for the accepting thread and wake it
+void FileServer::release(const Connection& connection) {
+	{
+		std::lock_guard<std::mutex> lock(m_releasedMutex);
+		m_released.push_back(connection);
+	}
+
+	char wake = 0;
+	while (::write(m_wake[1], &wake, 1) < 0 && errno == EINTR) {
+	}
+}
+
+#endif
+
+// the sections of the report, from the cached file
+std::string FileServer::print(const std::string& sections, const std::string& path) {
+	std::vector<size_t> selected = parseSections(sections);
+
+	bool hit;
+	FileCache::EntryPointer entry = m_cache.get(path, hit);
+
+	std::ostringstream out;
+	for (size_t section : selected) {
+		FileReport::writeSection(entry->file(), entry->array(), entry->arraySize(), section, out);
+	}
+	return out.str();
+}
+
+// keep the most recent samples
+void FileServer::recordLatency(std::uint64_t microseconds) {
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+
+	if (m_latencies.size() < LATENCY_SAMPLES) {
+		m_latencies.push_back(microseconds);
+	}
+	else {
+		m_latencies[m_latencyNext] = microseconds;
+		m_latencyNext = (m_latencyNext + 1) % LATENCY_SAMPLES;
+	}
+}
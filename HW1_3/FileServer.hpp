@@ -0,0 +1,99 @@
+/**
+* File:		FileServer.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a FileServer class, a long-running server that prints Files for
+*			clients connected to a Unix domain socket. Parsed files are kept in a FileCache, so a file is parsed
+*			once and then served from memory until it changes, and requests are answered by a pool of threads.
+*			Idle connections wait in one poll on the accepting thread, so a request thread is only taken while a
+*			request is being answered, and any number of clients can keep their connections open.
+*
+*			Requests are single lines, a connection may send any number of them:
+*				PRINT <sections> <path>		sections is "all" or section numbers separated by commas, e.g. 0,2,8
+*				STATS						request count, cache hit rate and latency percentiles
+*			Responses are "OK <length>\n" followed by length bytes, or "ERROR <message>\n". The body of PRINT is
+*			the report restricted to the sections asked for, exactly as the program prints it.
+*/
+
+#ifndef FILE_SERVER_HPP
+#define FILE_SERVER_HPP
+
+// includes
+#include "FileCache.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// class definition
+class FileServer {
+public:
+	// number of recent requests the latency percentiles are taken over
+	static const size_t LATENCY_SAMPLES = 4096;
+	// longest request line accepted
+	static const size_t MAX_REQUEST = 64 * 1024;
+
+	// constructor/destructor, threads is the number of request threads (0 for all cores)
+	FileServer(const std::string& socketPath, unsigned threads = 0, size_t cacheCapacity = 64);
+	virtual ~FileServer();
+
+	// listen on the socket and serve requests until stop is called, throws runtime_error if it cannot listen
+	void run();
+	// make run return, safe to call from a signal handler
+	void stop();
+
+	// answer one request line, as sent on the socket
+	std::string respond(const std::string& request);
+	// the body of a STATS response
+	std::string stats() const;
+
+private:
+	// not copyable
+	FileServer(const FileServer&);
+	FileServer& operator=(const FileServer&);
+
+	// a client connection and the start of its next request
+	struct Connection {
+		int socket;
+		std::string pending;
+	};
+
+	// request thread, serves connections that have data
+	void work();
+	// read what has arrived and answer the complete requests, false if the connection is finished
+	bool serve(Connection& connection);
+	// hand a connection back to the accepting thread to wait for its next request
+	void release(const Connection& connection);
+	// print the sections of a file into the response body
+	std::string print(const std::string& sections, const std::string& path);
+	// record the time taken by a PRINT request
+	void recordLatency(std::uint64_t microseconds);
+
+	std::string m_socketPath;
+	unsigned m_threads;
+	FileCache m_cache;
+	std::atomic<bool> m_stopping;
+
+	// connections with data, waiting for a request thread
+	std::deque<Connection> m_ready;
+	std::mutex m_readyMutex;
+	std::condition_variable m_readyCondition;
+
+	// connections served and waiting for their next request, picked up by the accepting thread
+	std::vector<Connection> m_released;
+	std::mutex m_releasedMutex;
+	// pipe that wakes the accepting thread when a connection is released
+	int m_wake[2];
+
+	// counters and the most recent PRINT latencies, a ring
+	std::uint64_t m_requests;
+	std::uint64_t m_errors;
+	std::vector<std::uint64_t> m_latencies;
+	size_t m_latencyNext;
+	mutable std::mutex m_statsMutex;
+}; // end class FileServer
+
+#endif
@@ -0,0 +1,182 @@
+/**
+* File:		Generator.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the definition of a Generator class template, the return type of a C++20 coroutine that
+*			produces values one at a time, when the caller asks for them. Nothing runs until the first value is
+*			pulled, and the coroutine is suspended at each co_yield until the next one is, so a caller that stops
+*			pulling holds the producer where it is, which is all the backpressure it needs.
+*
+*			Values are yielded by reference and only live until the next pull. A value can be a temporary, since
+*			the temporary lives until the coroutine is resumed.
+*
+*			Available when the compiler supports coroutines, FILEFACTORY_HAVE_COROUTINES is defined if so.
+*/
+
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define FILEFACTORY_HAVE_COROUTINES
+#endif
+#endif
+
+#ifdef FILEFACTORY_HAVE_COROUTINES
+
+// includes
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// class definition
+template <class T>
+class Generator {
+public:
+	// the coroutine's side of the generator
+	struct promise_type {
+		const T* m_value = nullptr;
+		std::exception_ptr m_exception;
+
+		Generator get_return_object() {
+			return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		// lazy, nothing runs until the first pull
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always yield_value(const T& value) noexcept {
+			m_value = std::addressof(value);
+			return {};
+		}
+
+		void return_void() {
+		}
+
+		// rethrown to the caller by the pull that resumed the coroutine
+		void unhandled_exception() {
+			m_exception = std::current_exception();
+		}
+
+		// a generator only yields, it does not wait on anything
+		template <class U>
+		std::suspend_never await_transform(U&&) = delete;
+	};
+
+	// input iterator over the remaining values, so a generator works with range for
+	class iterator {
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		iterator() : m_generator(nullptr) {
+		}
+
+		explicit iterator(Generator* generator) : m_generator(generator) {
+		}
+
+		reference operator*() const {
+			return m_generator->value();
+		}
+
+		pointer operator->() const {
+			return std::addressof(m_generator->value());
+		}
+
+		iterator& operator++() {
+			if (!m_generator->next()) {
+				m_generator = nullptr;
+			}
+			return *this;
+		}
+
+		void operator++(int) {
+			++*this;
+		}
+
+		bool operator==(const iterator& other) const {
+			return m_generator == other.m_generator;
+		}
+
+		bool operator!=(const iterator& other) const {
+			return m_generator != other.m_generator;
+		}
+
+	private:
+		Generator* m_generator;
+	}; // end class iterator
+
+	// constructor/destructor
+	Generator(Generator&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {
+	}
+
+	Generator& operator=(Generator&& other) noexcept {
+		if (this != &other) {
+			destroy();
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	~Generator() {
+		destroy();
+	}
+
+	Generator(const Generator&) = delete;
+	Generator& operator=(const Generator&) = delete;
+
+	// run the coroutine to its next value, false once it has finished
+	bool next() {
+		if (!m_handle || m_handle.done()) {
+			return false;
+		}
+
+		m_handle.resume();
+		if (m_handle.promise().m_exception) {
+			std::rethrow_exception(std::exchange(m_handle.promise().m_exception, nullptr));
+		}
+		return !m_handle.done();
+	}
+
+	// the value of the last successful next()
+	const T& value() const {
+		return *m_handle.promise().m_value;
+	}
+
+	// pulls the first value
+	iterator begin() {
+		return next() ? iterator(this) : iterator();
+	}
+
+	iterator end() {
+		return iterator();
+	}
+
+private:
+	explicit Generator(std::coroutine_handle<promise_type> handle) : m_handle(handle) {
+	}
+
+	void destroy() {
+		if (m_handle) {
+			m_handle.destroy();
+		}
+	}
+
+	std::coroutine_handle<promise_type> m_handle;
+}; // end class Generator
+
+#endif
+
+#endif
@@ -0,0 +1,349 @@
+/**
+* File:		GrammarTokenizer.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a GrammarTokenizer class template, that splits raw blocks of
+*			characters into tokens by a grammar fixed when the program is compiled, and for the grammars it
+*			comes with. It is fed blocks exactly as a WordTokenizer is, so it plugs into the same ingestion.
+*
+*			A grammar names its delimiters, an optional quote character and the characters stripped from both
+*			ends of a token. Its CharClasses table, one class per byte, is built by constexpr functions, so the
+*			tokenizer only ever looks a character up. Between delimiters the tokenizer searches for the next
+*			character that is not a plain word character a whole vector at a time: the special characters are
+*			gathered into runs of consecutive byte values, and when there are at most MAX_VECTOR_RUNS runs each
+*			costs one SSE2 range compare per 16 characters (whitespace is two runs, ' ' and '\t' to '\r', all of
+*			ASCII punctuation and whitespace is five). Grammars with more runs are scanned a byte at a time.
+*
+*			Quoted text is part of the token it is in, delimiters and all, and the quotes are removed. Two quotes
+*			in a row inside quoted text are one quote, as in CSV. Characters to strip are only stripped outside
+*			quotes, so a token's inner punctuation (don't, well-known) is kept. Tokens left empty, such as "" or
+*			a token made only of stripped characters, are dropped, and an unterminated quote runs to the end of
+*			the input.
+*/
+
+#ifndef GRAMMAR_TOKENIZER_HPP
+#define GRAMMAR_TOKENIZER_HPP
+
+// includes
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GRAMMAR_TOKENIZER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// class of every byte value of a grammar, built at compile time
+struct CharClasses {
+	// what a character does
+	enum Class {
+		WORD, DELIMITER, QUOTE, STRIP
+	};
+
+	// most runs of special characters that are classified with vector compares
+	static const unsigned MAX_VECTOR_RUNS = 8;
+
+	// consecutive byte values that are all special
+	struct Run {
+		unsigned char low;
+		unsigned char high;
+	};
+
+	// class of each byte value
+	unsigned char classes[256];
+	// runs of special characters, in byte order
+	Run runs[MAX_VECTOR_RUNS];
+	// number of runs, more than MAX_VECTOR_RUNS if they did not all fit
+	unsigned runCount;
+
+	// classify the characters of the grammar, delimiters win over the quote, which wins over stripping
+	static constexpr CharClasses build(const char* delimiters, char quote, const char* strip) {
+		CharClasses table = {};
+
+		for (const char* c = strip; *c != '\0'; ++c) {
+			table.classes[static_cast<unsigned char>(*c)] = STRIP;
+		}
+		if (quote != '\0') {
+			table.classes[static_cast<unsigned char>(quote)] = QUOTE;
+		}
+		for (const char* c = delimiters; *c != '\0'; ++c) {
+			table.classes[static_cast<unsigned char>(*c)] = DELIMITER;
+		}
+
+		// a special character after a word character starts a run, one after a special character extends it
+		for (unsigned c = 0; c < 256; c++) {
+			if (table.classes[c] == WORD) {
+				continue;
+			}
+			if (c > 0 && table.classes[c - 1] != WORD) {
+				if (table.runCount <= MAX_VECTOR_RUNS) {
+					table.runs[table.runCount - 1].high = static_cast<unsigned char>(c);
+				}
+				continue;
+			}
+
+			table.runCount++;
+			if (table.runCount <= MAX_VECTOR_RUNS) {
+				table.runs[table.runCount - 1].low = static_cast<unsigned char>(c);
+				table.runs[table.runCount - 1].high = static_cast<unsigned char>(c);
+			}
+		}
+		return table;
+	}
+
+	// true if the special characters can be found with vector compares
+	constexpr bool vectorizable() const {
+		return runCount <= MAX_VECTOR_RUNS;
+	}
+}; // end struct CharClasses
+
+// words separated by whitespace, as operator>> and WordTokenizer split them
+struct WhitespaceGrammar {
+	static constexpr const char* delimiters() {
+		return " \t\n\v\f\r";
+	}
+	static constexpr char quote() {
+		return '\0';
+	}
+	static constexpr const char* strip() {
+		return "";
+	}
+}; // end struct WhitespaceGrammar
+
+// comma separated fields, a record per line, fields may be quoted and the spaces around them are dropped
+struct CsvGrammar {
+	static constexpr const char* delimiters() {
+		return ",\r\n";
+	}
+	static constexpr char quote() {
+		return '"';
+	}
+	static constexpr const char* strip() {
+		return " \t";
+	}
+}; // end struct CsvGrammar
+
+// words of prose, separated by whitespace, with the ASCII punctuation around them stripped
+struct TextGrammar {
+	static constexpr const char* delimiters() {
+		return " \t\n\v\f\r";
+	}
+	static constexpr char quote() {
+		return '\0';
+	}
+	static constexpr const char* strip() {
+		return "!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+	}
+}; // end struct TextGrammar
+
+// class definition
+template <class Grammar>
+class GrammarTokenizer {
+public:
+	// the grammar's classes
+	static constexpr CharClasses TABLE = CharClasses::build(Grammar::delimiters(), Grammar::quote(), Grammar::strip());
+
+	// constructor/destructor
+	GrammarTokenizer();
+	virtual ~GrammarTokenizer();
+
+	// tokenize a block of characters, calling sink(const std::string&) for each complete token
+	// a token running into the end of the block is held back until the next block or finish()
+	template <class Sink>
+	void feed(const char* data, size_t length, Sink& sink);
+
+	// tokenize as feed does, also calling newline() for each newline delimiter, after the tokens before it
+	template <class Sink, class Newline>
+	void feed(const char* data, size_t length, Sink& sink, Newline& newline);
+
+	// flush the token carried over from the last block, if any
+	template <class Sink>
+	void finish(Sink& sink);
+
+private:
+	// newline callback of the plain feed, does nothing
+	struct IgnoreNewlines {
+		void operator()() const {
+		}
+	};
+
+	// first character in [begin, end) that is not a word character, end if there is none
+	static const char* findSpecial(const char* begin, const char* end);
+
+	// hand the token to the sink without its trailing stripped characters, then start a new one
+	template <class Sink>
+	void endToken(Sink& sink);
+
+	// token so far, carried over between blocks
+	std::string m_token;
+	// length of m_token without the stripped characters at its end
+	size_t m_kept;
+	// inside quoted text
+	bool m_quoted;
+	// the last character was a closing quote, a quote now is a quote character
+	bool m_closed;
+}; // end class GrammarTokenizer
+
+// the table's definition, needed for it to be indexed at run time
+template <class Grammar>
+constexpr CharClasses GrammarTokenizer<Grammar>::TABLE;
+
+// empty token, outside quotes
+template <class Grammar>
+GrammarTokenizer<Grammar>::GrammarTokenizer() : m_kept(0), m_quoted(false), m_closed(false) {
+
+}
+
+// empty
+template <class Grammar>
+GrammarTokenizer<Grammar>::~GrammarTokenizer() {
+
+}
+
+// tokenize a block, newlines are ignored
+template <class Grammar>
+template <class Sink>
+void GrammarTokenizer<Grammar>::feed(const char* data, size_t length, Sink& sink) {
+	IgnoreNewlines newline;
+	feed(data, length, sink, newline);
+}
+
+// tokenize a block, runs of word characters are appended whole, special characters one at a time
+template <class Grammar>
+template <class Sink, class Newline>
+void GrammarTokenizer<Grammar>::feed(const char* data, size_t length, Sink& sink, Newline& newline) {
+	const char* end = data + length;
+	const char* itr = data;
+
+	while (itr != end) {
+		// quoted text up to the closing quote is taken as it is
+		if (m_quoted) {
+			const void* found = std::memchr(itr, Grammar::quote(), static_cast<size_t>(end - itr));
+			const char* close = found != nullptr ? static_cast<const char*>(found) : end;
+
+			if (close != itr) {
+				m_token.append(itr, close);
+				m_kept = m_token.size();
+			}
+			if (close == end) {
+				break;
+			}
+
+			m_quoted = false;
+			m_closed = true;
+			itr = close + 1;
+			continue;
+		}
+
+		const char* stop = findSpecial(itr, end);
+		if (stop != itr) {
+			m_token.append(itr, stop);
+			m_kept = m_token.size();
+			m_closed = false;
+			itr = stop;
+			if (itr == end) {
+				break;
+			}
+		}
+
+		char c = *itr++;
+		switch (TABLE.classes[static_cast<unsigned char>(c)]) {
+		case CharClasses::QUOTE:
+			// a quote right after a closing quote is the quote character itself
+			if (m_closed) {
+				m_token.push_back(c);
+				m_kept = m_token.size();
+			}
+			m_quoted = true;
+			m_closed = false;
+			break;
+		case CharClasses::STRIP:
+			// leading ones are dropped now, trailing ones when the token ends
+			if (!m_token.empty()) {
+				m_token.push_back(c);
+			}
+			m_closed = false;
+			break;
+		default:
+			endToken(sink);
+			if (c == '\n') {
+				newline();
+			}
+			break;
+		}
+	}
+}
+
+// flush the carried over token, an unterminated quote ends here
+template <class Grammar>
+template <class Sink>
+void GrammarTokenizer<Grammar>::finish(Sink& sink) {
+	endToken(sink);
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// each run costs a range compare, one unsigned compare after subtracting its low end
+template <class Grammar>
+const char* GrammarTokenizer<Grammar>::findSpecial(const char* begin, const char* end) {
+#ifdef GRAMMAR_TOKENIZER_SSE2
+	if (TABLE.vectorizable()) {
+		while (end - begin >= 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			__m128i special = _mm_setzero_si128();
+
+			for (unsigned r = 0; r < TABLE.runCount; r++) {
+				const CharClasses::Run& run = TABLE.runs[r];
+				if (run.low == run.high) {
+					special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(run.low))));
+				}
+				else {
+					__m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8(static_cast<char>(run.low)));
+					__m128i span = _mm_set1_epi8(static_cast<char>(run.high - run.low));
+					special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(shifted, span), shifted));
+				}
+			}
+
+			unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+			if (mask != 0) {
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return begin + index;
+#else
+				return begin + __builtin_ctz(mask);
+#endif
+			}
+			begin += 16;
+		}
+	}
+#endif
+
+	while (begin != end && TABLE.classes[static_cast<unsigned char>(*begin)] == CharClasses::WORD) {
+		++begin;
+	}
+	return begin;
+}
+
+// trailing stripped characters are cut, empty tokens are dropped
+template <class Grammar>
+template <class Sink>
+void GrammarTokenizer<Grammar>::endToken(Sink& sink) {
+	m_token.resize(m_kept);
+	if (!m_token.empty()) {
+		sink(m_token);
+	}
+
+	m_token.clear();
+	m_kept = 0;
+	m_quoted = false;
+	m_closed = false;
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+* File:		InternedFile.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for an InternedFile class, that stores a word sequence as a dictionary
+*			of distinct words plus a dense array of 32-bit word IDs.
+*/
+
+#include "InternedFile.hpp"
+#include <functional>
+#include <stdexcept>
+#include <limits>
+
+// definition of the class constant, Slots takes it by reference
+const InternedFile::WordId InternedFile::NO_WORD;
+
+// empty
+InternedFile::InternedFile() {
+
+}
+
+// empty
+InternedFile::~InternedFile() {
+
+}
+
+// look up the word in the dictionary, adding it if not present, then append the id to the sequence
+InternedFile::WordId InternedFile::add(const std::string& word) {
+	// room for another word, so the probe below ends at an empty slot
+	if ((m_dictionary.size() + 1) * 2 > m_slots.size()) {
+		grow();
+	}
+
+	size_t mask = m_slots.size() - 1;
+	size_t slot = std::hash<std::string>()(word) & mask;
+	while (m_slots[slot] != NO_WORD && m_dictionary[m_slots[slot]] != word) {
+		slot = (slot + 1) & mask;
+	}
+
+	if (m_slots[slot] == NO_WORD) {
+		// ids are 32 bits wide, make sure the dictionary has room for another entry
+		if (m_dictionary.size() >= std::numeric_limits<WordId>::max()) {
+			throw std::length_error("InternedFile dictionary is full");
+		}
+
+		m_dictionary.push_back(word);
+		m_slots[slot] = static_cast<WordId>(m_dictionary.size() - 1);
+	}
+
+	WordId id = m_slots[slot];
+	m_ids.push_back(id);
+
+	return id;
+}
+
+// place every dictionary id in a table twice the size
+void InternedFile::grow() {
+	Slots slots(m_slots.empty() ? 16 : m_slots.size() * 2, NO_WORD);
+	size_t mask = slots.size() - 1;
+	std::hash<std::string> hash;
+
+	for (size_t id = 0; id < m_dictionary.size(); id++) {
+		size_t slot = hash(m_dictionary[id]) & mask;
+		while (slots[slot] != NO_WORD) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = static_cast<WordId>(id);
+	}
+
+	m_slots.swap(slots);
+}
+
+// number of words in the sequence
+size_t InternedFile::size() const {
+	return m_ids.size();
+}
+
+// true if there are no words
+bool InternedFile::empty() const {
+	return m_ids.empty();
+}
+
+// number of distinct words
+size_t InternedFile::vocabularySize() const {
+	return m_dictionary.size();
+}
+
+// id of the word at index
+InternedFile::WordId InternedFile::id(size_t index) const {
+	return m_ids[index];
+}
+
+// word at index
+const std::string& InternedFile::operator[](size_t index) const {
+	return m_dictionary[m_ids[index]];
+}
+
+// dictionary word for id
+const std::string& InternedFile::word(WordId id) const {
+	return m_dictionary[id];
+}
+
+// id sequence
+const InternedFile::WordIds& InternedFile::ids() const {
+	return m_ids;
+}
+
+// dictionary
+const InternedFile::Dictionary& InternedFile::dictionary() const {
+	return m_dictionary;
+}
+
+// approximate memory usage: the id array, each dictionary word once, and the lookup table
+size_t InternedFile::memoryUsage() const {
+	size_t bytes = m_ids.capacity() * sizeof(WordId);
+
+	bytes += m_dictionary.capacity() * sizeof(std::string);
+	for (const std::string& word : m_dictionary) {
+		// count the heap buffer of words that do not fit in the small string buffer
+		if (word.capacity() > 15) {
+			bytes += word.capacity() + 1;
+		}
+	}
+
+	bytes += m_slots.capacity() * sizeof(WordId);
+
+	return bytes;
+}
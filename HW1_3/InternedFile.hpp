@@ -0,0 +1,81 @@
+/**
+* File:		InternedFile.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for an InternedFile class, an alternative File representation that
+*			stores each distinct word once in a dictionary and the word sequence as a dense array of 32-bit IDs.
+*			Repetitive input (natural language, logs) uses a small vocabulary, so this saves a great deal of memory.
+*			Words are found by an open addressing table of ids, hashed by their dictionary words, so the table
+*			holds 4 bytes per slot and no second copy of any word. The id array, the table and the dictionary
+*			allocate through ArenaAllocator, as a File does, so they are placed in the current arena and charged
+*			to the current budget.
+*/
+
+#ifndef INTERNED_FILE_HPP
+#define INTERNED_FILE_HPP
+
+// includes
+#include "Arena.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class InternedFile {
+public:
+	// word id type, an index into the dictionary
+	typedef std::uint32_t WordId;
+	// the word sequence
+	typedef std::vector<WordId, ArenaAllocator<WordId> > WordIds;
+	// distinct words, indexed by id
+	typedef std::vector<std::string, ArenaAllocator<std::string> > Dictionary;
+
+	// constructor/destructor
+	InternedFile();
+	virtual ~InternedFile();
+
+	// intern the word and append its id to the word sequence, returns the id of the word
+	WordId add(const std::string& word);
+
+	// number of words in the sequence
+	size_t size() const;
+	// true if there are no words in the sequence
+	bool empty() const;
+	// number of distinct words in the dictionary
+	size_t vocabularySize() const;
+
+	// id of the word at the specified position in the sequence
+	WordId id(size_t index) const;
+	// word at the specified position in the sequence
+	const std::string& operator[](size_t index) const;
+	// dictionary word for the specified id
+	const std::string& word(WordId id) const;
+
+	// the word id sequence
+	const WordIds& ids() const;
+	// the dictionary of distinct words, indexed by id
+	const Dictionary& dictionary() const;
+
+	// approximate number of bytes used by this object
+	size_t memoryUsage() const;
+
+private:
+	// slots of the lookup table, each a dictionary id or NO_WORD
+	typedef std::vector<WordId, ArenaAllocator<WordId> > Slots;
+
+	// an empty slot, never an id since the dictionary holds fewer words
+	static const WordId NO_WORD = 0xffffffff;
+
+	// double the lookup table, at least 16 slots, placing every dictionary id again
+	void grow();
+
+	// distinct words, indexed by id
+	Dictionary m_dictionary;
+	// lookup from word to id, a power of two slots at most half full, probed linearly from the word's hash
+	Slots m_slots;
+	// word sequence, as dictionary ids
+	WordIds m_ids;
+}; // end class InternedFile
+
+#endif
@@ -0,0 +1,214 @@
+/**
+* File:		LayoutPlanner.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a LayoutPlanner class, that chooses the word layout and thread
+*			count for an input from a sample of it.
+*/
+
+// includes
+#include "LayoutPlanner.hpp"
+#include "FileFactory.hpp"
+#include "WordTokenizer.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+// definition of the class constant, std::min takes it by reference
+const size_t LayoutPlanner::SAMPLE_SIZE;
+
+// empty
+LayoutPlanner::LayoutPlanner() {
+
+}
+
+// empty
+LayoutPlanner::~LayoutPlanner() {
+
+}
+
+// name of a layout
+const char* LayoutPlanner::name(Layout layout) {
+	switch (layout) {
+	case AUTO:
+		return "auto";
+	case INTERNED:
+		return "interned";
+	case PACKED:
+		return "packed";
+	default:
+		return "file";
+	}
+}
+
+// layout from its name
+LayoutPlanner::Layout LayoutPlanner::parse(const std::string& name) {
+	if (name == "auto") {
+		return AUTO;
+	}
+	else if (name == "file") {
+		return CONTAINER_FILE;
+	}
+	else if (name == "interned") {
+		return INTERNED;
+	}
+	else if (name == "packed") {
+		return PACKED;
+	}
+
+	throw std::invalid_argument("No such layout: " + name);
+}
+
+// the planner's choice, each rule records why it chose
+LayoutPlanner::Plan LayoutPlanner::plan(const char* sample, size_t length, const Workload& workload) {
+	Plan plan;
+	plan.threads = chooseThreads(workload);
+
+	if (workload.needsFile) {
+		plan.reason = "sorted and line output need a File";
+		return plan;
+	}
+	if (workload.compressed) {
+		plan.reason = "compressed input is not sampled";
+		return plan;
+	}
+	if (sample == nullptr) {
+		plan.reason = "the input cannot be sampled";
+		return plan;
+	}
+
+	plan.sampled = true;
+	plan.sample = measure(sample, length, workload.inputBytes);
+	const Sample& measured = plan.sample;
+
+	std::ostringstream reason;
+	reason << measured.words << " words sampled, " << measured.distinctWords << " distinct, "
+		<< measured.longWords << " longer than " << PackedFile::MAX_INLINE_LENGTH << " bytes, about "
+		<< measured.estimatedWords << " words in all";
+
+	bool repetitive = measured.words >= MIN_SAMPLE_WORDS
+		&& measured.distinctWords * 100 <= measured.words * REPETITIVE_PERCENT;
+	bool shortWords = measured.longWords * 100 <= measured.words * PACKED_LONG_PERCENT;
+
+#if CONTAINER == ARRAY
+	// the array has a fixed number of slots, the other layouts grow
+	if (measured.estimatedWords > std::tuple_size<File>::value) {
+		plan.layout = repetitive ? INTERNED : PACKED;
+		reason << ", more than the " << std::tuple_size<File>::value << " the array holds";
+		plan.reason = reason.str();
+		return plan;
+	}
+#endif
+
+	// a list pays a cache miss per word in every mode, the slots are read in order
+	bool nodes = CONTAINER == LIST || CONTAINER == FORWARD_LIST;
+
+	if (repetitive) {
+		plan.layout = INTERNED;
+		reason << ", repetitive";
+	}
+	else if (measured.estimatedWords < MIN_PACKED_WORDS) {
+		reason << ", small";
+	}
+	else if (nodes || shortWords) {
+		plan.layout = PACKED;
+		reason << (nodes ? ", a list backend" : ", mostly short words");
+	}
+	else {
+		reason << ", many long words";
+	}
+
+	plan.reason = reason.str();
+	return plan;
+}
+
+// a layout chosen by hand is kept, the sample is still measured for the log
+LayoutPlanner::Plan LayoutPlanner::plan(Layout layout, const char* sample, size_t length, const Workload& workload) {
+	if (layout == AUTO) {
+		return plan(sample, length, workload);
+	}
+
+	if (workload.needsFile && layout != CONTAINER_FILE) {
+		throw std::invalid_argument("Sorted and line output need the file layout");
+	}
+
+	Plan plan;
+	plan.layout = layout;
+	plan.threads = chooseThreads(workload);
+	plan.reason = "requested";
+
+	if (sample != nullptr && !workload.compressed) {
+		plan.sampled = true;
+		plan.sample = measure(sample, length, workload.inputBytes);
+	}
+	return plan;
+}
+
+// one line, the layout, the threads and why
+void LayoutPlanner::describe(const Plan& plan, std::ostream& stream) {
+	stream << "layout " << name(plan.layout) << " (" << FileFactory::containerName() << " backend), "
+		<< plan.threads << (plan.threads == 1 ? " thread: " : " threads: ") << plan.reason << std::endl;
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// count words, distinct words and long words, a word cut off by the end of the sample is left out
+LayoutPlanner::Sample LayoutPlanner::measure(const char* sample, size_t length, std::uint64_t inputBytes) {
+	Sample measured;
+	measured.bytes = length;
+
+	std::unordered_set<std::string> distinct;
+	bool cut = inputBytes > length;
+	size_t i = 0;
+
+	while (i < length) {
+		while (i < length && WordTokenizer::isDelimiter(sample[i])) {
+			i++;
+		}
+
+		size_t start = i;
+		while (i < length && !WordTokenizer::isDelimiter(sample[i])) {
+			i++;
+		}
+
+		if (i == start || (i == length && cut)) {
+			break;
+		}
+
+		size_t wordLength = i - start;
+		measured.words++;
+		measured.characters += wordLength;
+		if (wordLength > PackedFile::MAX_INLINE_LENGTH) {
+			measured.longWords++;
+		}
+		distinct.insert(std::string(sample + start, wordLength));
+	}
+
+	measured.distinctWords = distinct.size();
+
+	// the rest of the input is assumed to be like the sample
+	measured.estimatedWords = measured.words;
+	if (cut && length > 0) {
+		measured.estimatedWords = static_cast<std::uint64_t>(
+			static_cast<double>(measured.words) * inputBytes / length);
+	}
+	return measured;
+}
+
+// one thread per BYTES_PER_THREAD of input, up to the number of cores, all cores if the size is unknown
+unsigned LayoutPlanner::chooseThreads(const Workload& workload) {
+	if (workload.threads > 0) {
+		return workload.threads;
+	}
+
+	std::uint64_t cores = std::max(1u, std::thread::hardware_concurrency());
+	if (workload.inputBytes == 0) {
+		return static_cast<unsigned>(cores);
+	}
+
+	std::uint64_t wanted = std::max<std::uint64_t>(1, workload.inputBytes / BYTES_PER_THREAD);
+	return static_cast<unsigned>(std::min(wanted, cores));
+}
@@ -0,0 +1,107 @@
+/**
+* File:		LayoutPlanner.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a LayoutPlanner class, that chooses at run time how the words of
+*			an input are stored and how many threads work on them. The CONTAINER backend is fixed when the program
+*			is built, but every backend can also hold its words as an InternedFile (each distinct word once, best
+*			on repetitive text) or a PackedFile (short words inline in 16-byte slots, best on large inputs of short
+*			words), and all three print the same report.
+*
+*			The planner reads the first SAMPLE_SIZE bytes of the input, counts its words, distinct words and long
+*			words, and estimates the whole input from the input size. Repetitive text is interned, which is both
+*			smaller and faster. Otherwise larger inputs are packed when the backend is a list, whose nodes cost a
+*			cache miss per word, or when the words are short enough to fit their slots, which takes less memory
+*			than a File at about the same speed. Sorting and line modes need a File. An ARRAY backend that could
+*			not hold the input is given a layout that can. Inputs that cannot be sampled (standard input,
+*			compressed files) keep the File. Each plan carries the reason for it, for the log.
+*/
+
+#ifndef LAYOUT_PLANNER_HPP
+#define LAYOUT_PLANNER_HPP
+
+// includes
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class LayoutPlanner {
+public:
+	// how the words are stored
+	enum Layout {
+		AUTO, CONTAINER_FILE, INTERNED, PACKED
+	};
+
+	// bytes of input sampled
+	static const size_t SAMPLE_SIZE = 1 << 20;
+	// fewest sampled words to judge the vocabulary on
+	static const std::uint64_t MIN_SAMPLE_WORDS = 4096;
+	// most distinct words per 100 words for the input to count as repetitive
+	static const std::uint64_t REPETITIVE_PERCENT = 20;
+	// fewest words worth packing
+	static const std::uint64_t MIN_PACKED_WORDS = 1 << 16;
+	// most long words per 100 words to pack, long words are stored outside their slots
+	static const std::uint64_t PACKED_LONG_PERCENT = 5;
+	// bytes of input per thread
+	static const std::uint64_t BYTES_PER_THREAD = 8 << 20;
+
+	// what the input is read for
+	struct Workload {
+		// size of the input, 0 if unknown
+		std::uint64_t inputBytes = 0;
+		// the input is gzip or zstd compressed
+		bool compressed = false;
+		// words are sorted, or printed a line at a time, which only a File supports
+		bool needsFile = false;
+		// threads requested, 0 to let the planner choose
+		unsigned threads = 0;
+	};
+
+	// what was sampled
+	struct Sample {
+		std::uint64_t bytes = 0;
+		std::uint64_t words = 0;
+		std::uint64_t distinctWords = 0;
+		std::uint64_t longWords = 0;
+		std::uint64_t characters = 0;
+		// words in the whole input, extrapolated from the sample
+		std::uint64_t estimatedWords = 0;
+	};
+
+	// the decision
+	struct Plan {
+		Layout layout = CONTAINER_FILE;
+		unsigned threads = 1;
+		bool sampled = false;
+		Sample sample;
+		std::string reason;
+	};
+
+	// constructor/destructor
+	LayoutPlanner();
+	virtual ~LayoutPlanner();
+
+	// name of a layout, as accepted by parse
+	static const char* name(Layout layout);
+	// layout named auto, file, interned or packed, throws invalid_argument otherwise
+	static Layout parse(const std::string& name);
+
+	// plan for an input beginning with the length bytes of sample, sample may be null if there is none
+	static Plan plan(const char* sample, size_t length, const Workload& workload);
+	// plan the layout given, chosen by hand, or by the planner for AUTO
+	// throws invalid_argument if the workload needs a File and another layout is given
+	static Plan plan(Layout layout, const char* sample, size_t length, const Workload& workload);
+
+	// write the decision as one line
+	static void describe(const Plan& plan, std::ostream& stream);
+
+private:
+	// count the words of the sample
+	static Sample measure(const char* sample, size_t length, std::uint64_t inputBytes);
+	// threads for the input size
+	static unsigned chooseThreads(const Workload& workload);
+}; // end class LayoutPlanner
+
+#endif
@@ -0,0 +1,84 @@
+/**
+* File:		LineIndex.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a LineIndex class, that records where the lines of the input
+*			begin in its word sequence.
+*/
+
+// includes
+#include "LineIndex.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// constructor
+LineIndex::LineIndex() : m_words(0) {
+	// empty
+}
+
+// destructor
+LineIndex::~LineIndex() {
+	// empty
+}
+
+// start recording
+void LineIndex::clear() {
+	m_starts.clear();
+	m_starts.push_back(0);
+	m_words = 0;
+}
+
+// the next line starts at the next word
+void LineIndex::newline(size_t words) {
+	if (words > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::length_error("Too many words for the line index");
+	}
+	m_starts.push_back(static_cast<std::uint32_t>(words));
+}
+
+// stop recording, a last line without words or a newline is not a line
+void LineIndex::finish(size_t words) {
+	m_words = words;
+	if (!m_starts.empty() && m_starts.back() == words) {
+		m_starts.pop_back();
+	}
+	m_starts.shrink_to_fit();
+}
+
+// number of lines
+size_t LineIndex::lines() const {
+	return m_starts.size();
+}
+
+// index of the first word of the line
+size_t LineIndex::first(size_t line) const {
+	if (line >= m_starts.size()) {
+		throw std::out_of_range("Line number out of range");
+	}
+	return m_starts[line];
+}
+
+// index one past the last word of the line, the start of the next line
+size_t LineIndex::last(size_t line) const {
+	if (line >= m_starts.size()) {
+		throw std::out_of_range("Line number out of range");
+	}
+	return line + 1 < m_starts.size() ? m_starts[line + 1] : m_words;
+}
+
+// line of the word, the last line starting at or before it
+size_t LineIndex::lineOf(size_t word) const {
+	if (word >= m_words) {
+		throw std::out_of_range("Word number out of range");
+	}
+
+	// blank lines share their start with the line after them, which is the one holding the word
+	std::vector<std::uint32_t>::const_iterator itr = std::upper_bound(m_starts.cbegin(), m_starts.cend(), word);
+	return static_cast<size_t>(itr - m_starts.cbegin()) - 1;
+}
+
+// approximate number of bytes used by this object
+size_t LineIndex::memoryUsage() const {
+	return sizeof(*this) + m_starts.capacity() * sizeof(std::uint32_t);
+}
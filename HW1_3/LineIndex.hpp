@@ -0,0 +1,53 @@
+/**
+* File:		LineIndex.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a LineIndex class, that records where the lines of the input
+*			begin in its word sequence. It is filled in by the same tokenizing pass that reads the words, and holds
+*			one 32-bit word index per line, so line N is found without another pass over the input or the File.
+*			Blank lines are kept, they are lines without words. A last line without a newline is kept only if it
+*			holds words, so the number of lines is the number of newlines, plus one for trailing words.
+*/
+
+#ifndef LINE_INDEX_HPP
+#define LINE_INDEX_HPP
+
+// includes
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class LineIndex {
+public:
+	// constructor/destructor
+	LineIndex();
+	virtual ~LineIndex();
+
+	// start recording, the first line starts at the first word
+	void clear();
+	// a newline was read after words words, the next line starts at the next word
+	void newline(size_t words);
+	// stop recording, words is the number of words read
+	void finish(size_t words);
+
+	// number of lines
+	size_t lines() const;
+	// index of the first word of the line
+	size_t first(size_t line) const;
+	// index one past the last word of the line
+	size_t last(size_t line) const;
+	// line of the word at the specified index
+	size_t lineOf(size_t word) const;
+
+	// approximate number of bytes used by this object
+	size_t memoryUsage() const;
+
+private:
+	// index of the first word of each line
+	std::vector<std::uint32_t> m_starts;
+	// number of words, the end of the last line
+	size_t m_words;
+}; // end class LineIndex
+
+#endif
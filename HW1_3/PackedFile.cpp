@@ -0,0 +1,133 @@
+/**
+* File:		PackedFile.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a PackedFile class, a structure of arrays File layout with short
+*			words packed inline in 16-byte slots.
+*/
+
+#include "PackedFile.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PACKED_FILE_SSE2
+#endif
+
+// empty
+PackedFile::PackedFile() {
+
+}
+
+// empty
+PackedFile::~PackedFile() {
+
+}
+
+// append a word
+void PackedFile::add(const std::string& word) {
+	add(word.data(), word.length());
+}
+
+// append a word, inline if it fits in a slot, otherwise in the blob
+void PackedFile::add(const char* word, size_t length) {
+	if (length > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::length_error("Word too long for PackedFile");
+	}
+
+	Slot slot;
+	memset(slot.bytes, 0, SLOT_SIZE);
+
+	if (length <= MAX_INLINE_LENGTH) {
+		memcpy(slot.bytes, word, length);
+	}
+	else {
+		// slot holds the blob offset
+		std::uint64_t offset = m_blob.size();
+		memcpy(slot.bytes, &offset, sizeof(offset));
+		m_blob.insert(m_blob.end(), word, word + length);
+		m_blob.push_back('\0');
+	}
+
+	m_slots.push_back(slot);
+	m_lengths.push_back(static_cast<std::uint32_t>(length));
+}
+
+// reserve space
+void PackedFile::reserve(size_t words) {
+	m_slots.reserve(words);
+	m_lengths.reserve(words);
+}
+
+// number of words
+size_t PackedFile::size() const {
+	return m_lengths.size();
+}
+
+// true if there are no words
+bool PackedFile::empty() const {
+	return m_lengths.empty();
+}
+
+// length of word
+size_t PackedFile::length(size_t index) const {
+	return m_lengths[index];
+}
+
+// inline if short enough
+bool PackedFile::isInline(size_t index) const {
+	return m_lengths[index] <= MAX_INLINE_LENGTH;
+}
+
+// characters of the word, from the slot or the blob
+const char* PackedFile::data(size_t index) const {
+	if (isInline(index)) {
+		return m_slots[index].bytes;
+	}
+
+	std::uint64_t offset;
+	memcpy(&offset, m_slots[index].bytes, sizeof(offset));
+	return &m_blob[static_cast<size_t>(offset)];
+}
+
+// copy of the word
+std::string PackedFile::operator[](size_t index) const {
+	return std::string(data(index), length(index));
+}
+
+// slot of the word
+const PackedFile::Slot& PackedFile::slot(size_t index) const {
+	return m_slots[index];
+}
+
+// compare two words, lengths first, then whole slots for inline words
+bool PackedFile::equal(size_t first, size_t second) const {
+	if (m_lengths[first] != m_lengths[second]) {
+		return false;
+	}
+
+	if (!isInline(first)) {
+		return memcmp(data(first), data(second), m_lengths[first]) == 0;
+	}
+
+	// inline slots are zero padded, so equal words have equal slots
+#ifdef PACKED_FILE_SSE2
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_slots[first].bytes));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_slots[second].bytes));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xffff;
+#else
+	return memcmp(m_slots[first].bytes, m_slots[second].bytes, SLOT_SIZE) == 0;
+#endif
+}
+
+// word lengths
+const PackedFile::Lengths& PackedFile::lengths() const {
+	return m_lengths;
+}
+
+// slots, lengths and blob
+size_t PackedFile::memoryUsage() const {
+	return m_slots.capacity() * sizeof(Slot) + m_lengths.capacity() * sizeof(std::uint32_t) + m_blob.capacity();
+}
@@ -0,0 +1,84 @@
+/**
+* File:		PackedFile.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a PackedFile class, a structure of arrays File layout. Words of
+*			15 bytes or fewer are stored inline, null terminated, in fixed 16-byte slots that can be compared and
+*			copied with one SIMD load each. Longer words are stored in a side blob and their slot holds the blob
+*			offset. Word lengths live in a separate array, so length checks never touch the words themselves.
+*			All three arrays allocate from the current arena, as a File does.
+*/
+
+#ifndef PACKED_FILE_HPP
+#define PACKED_FILE_HPP
+
+// includes
+#include "Arena.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class PackedFile {
+public:
+	// size of an inline slot, and the longest word stored inline (one byte is kept for the null terminator)
+	static const size_t SLOT_SIZE = 16;
+	static const size_t MAX_INLINE_LENGTH = SLOT_SIZE - 1;
+
+	// a 16-byte aligned slot
+	struct alignas(16) Slot {
+		char bytes[SLOT_SIZE];
+	};
+
+	// the arrays, from the current arena when the PackedFile is made
+	typedef std::vector<Slot, ArenaAllocator<Slot> > Slots;
+	typedef std::vector<std::uint32_t, ArenaAllocator<std::uint32_t> > Lengths;
+	typedef std::vector<char, ArenaAllocator<char> > Blob;
+
+	// constructor/destructor
+	PackedFile();
+	virtual ~PackedFile();
+
+	// append a word
+	void add(const std::string& word);
+	void add(const char* word, size_t length);
+
+	// reserve space for the specified number of words
+	void reserve(size_t words);
+
+	// number of words
+	size_t size() const;
+	// true if there are no words
+	bool empty() const;
+
+	// length of the word at index
+	size_t length(size_t index) const;
+	// true if the word at index is stored inline in its slot
+	bool isInline(size_t index) const;
+	// null terminated characters of the word at index
+	const char* data(size_t index) const;
+	// copy of the word at index
+	std::string operator[](size_t index) const;
+	// slot of the word at index, only meaningful for inline words
+	const Slot& slot(size_t index) const;
+
+	// true if the words at the two indexes are equal, inline words are compared a whole slot at a time
+	bool equal(size_t first, size_t second) const;
+
+	// word lengths, in order
+	const Lengths& lengths() const;
+
+	// approximate number of bytes used by this object
+	size_t memoryUsage() const;
+
+private:
+	// inline words and blob offsets
+	Slots m_slots;
+	// word lengths
+	Lengths m_lengths;
+	// long words, each null terminated
+	Blob m_blob;
+}; // end class PackedFile
+
+#endif
@@ -0,0 +1,240 @@
+/**
+* File:		PageAllocator.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a PageAllocator class, that maps memory with huge pages and NUMA
+*			placement, and binds threads to NUMA nodes.
+*/
+
+// includes
+#include "PageAllocator.hpp"
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// empty
+PageAllocator::PageAllocator() {
+
+}
+
+// empty
+PageAllocator::~PageAllocator() {
+
+}
+
+// name of a page size
+const char* PageAllocator::name(Pages pages) {
+	switch (pages) {
+	case TRANSPARENT_HUGE_PAGES:
+		return "transparent";
+	case EXPLICIT_HUGE_PAGES:
+		return "explicit";
+	default:
+		return "off";
+	}
+}
+
+// name of a placement
+const char* PageAllocator::name(Placement placement) {
+	return placement == INTERLEAVED ? "interleave" : "local";
+}
+
+// page size from its name
+PageAllocator::Pages PageAllocator::parsePages(const std::string& name) {
+	if (name == "off") {
+		return SMALL_PAGES;
+	}
+	else if (name == "transparent") {
+		return TRANSPARENT_HUGE_PAGES;
+	}
+	else if (name == "explicit") {
+		return EXPLICIT_HUGE_PAGES;
+	}
+
+	throw std::invalid_argument("No such huge page setting: " + name);
+}
+
+// placement from its name
+PageAllocator::Placement PageAllocator::parsePlacement(const std::string& name) {
+	if (name == "local") {
+		return LOCAL;
+	}
+	else if (name == "interleave") {
+		return INTERLEAVED;
+	}
+
+	throw std::invalid_argument("No such NUMA placement: " + name);
+}
+
+// whole huge pages
+size_t PageAllocator::roundUp(size_t size) {
+	return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+#ifdef __linux__
+
+// explicit huge pages if asked for and the pool has them, otherwise small pages aligned so the kernel can
+// back them with transparent huge pages, the placement is set before any page is touched
+void* PageAllocator::allocate(size_t size, const Policy& policy) {
+	void* memory = MAP_FAILED;
+
+	if (policy.pages == EXPLICIT_HUGE_PAGES) {
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+
+	if (memory == MAP_FAILED) {
+		// a huge page more than needed, then the unaligned head and the tail are unmapped
+		size_t padded = size + HUGE_PAGE_SIZE;
+		void* mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+
+		std::uintptr_t address = reinterpret_cast<std::uintptr_t>(mapping);
+		std::uintptr_t aligned = (address + HUGE_PAGE_SIZE - 1) & ~static_cast<std::uintptr_t>(HUGE_PAGE_SIZE - 1);
+		size_t head = static_cast<size_t>(aligned - address);
+		if (head > 0) {
+			munmap(mapping, head);
+		}
+		if (padded - head > size) {
+			munmap(reinterpret_cast<char*>(aligned) + size, padded - head - size);
+		}
+		memory = reinterpret_cast<void*>(aligned);
+
+		// advice only, the kernel may still use small pages
+		if (policy.pages != SMALL_PAGES) {
+			madvise(memory, size, MADV_HUGEPAGE);
+		}
+	}
+
+	// pages go to the nodes in turn as they are first touched
+	unsigned count = nodes();
+	if (policy.placement == INTERLEAVED && count > 1) {
+		std::vector<unsigned long> mask((count + 63) / 64, 0);
+		for (unsigned node : parseList(readSystemFile("/sys/devices/system/node/online"))) {
+			mask[node / 64] |= 1ul << (node % 64);
+		}
+		syscall(SYS_mbind, memory, size, MPOL_INTERLEAVE, mask.data(), mask.size() * 64 + 1, 0);
+	}
+
+	return memory;
+}
+
+// unmap
+void PageAllocator::release(void* memory, size_t size) {
+	munmap(memory, size);
+}
+
+// highest online node plus one, read once
+unsigned PageAllocator::nodes() {
+	static const unsigned count = []() {
+		std::vector<unsigned> online = parseList(readSystemFile("/sys/devices/system/node/online"));
+		unsigned highest = 0;
+		for (unsigned node : online) {
+			highest = node > highest ? node : highest;
+		}
+		return online.empty() ? 1u : highest + 1;
+	}();
+	return count;
+}
+
+// the calling thread runs only on the node's CPUs
+bool PageAllocator::bindToNode(unsigned node) {
+	std::vector<unsigned> cpus = parseList(readSystemFile(
+		"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+	if (cpus.empty()) {
+		return false;
+	}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (unsigned cpu : cpus) {
+		if (cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &set);
+		}
+	}
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+#else
+
+// the heap, there are no huge pages or nodes to ask for
+void* PageAllocator::allocate(size_t size, const Policy&) {
+	return ::operator new(size);
+}
+
+// back to the heap
+void PageAllocator::release(void* memory, size_t) {
+	::operator delete(memory);
+}
+
+// one node
+unsigned PageAllocator::nodes() {
+	return 1;
+}
+
+// threads are not bound
+bool PageAllocator::bindToNode(unsigned) {
+	return false;
+}
+
+#endif
+
+// workers are spread over the nodes in turn
+void PageAllocator::bindWorker(unsigned worker) {
+	unsigned count = nodes();
+	if (count > 1) {
+		bindToNode(worker % count);
+	}
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// comma separated numbers and ranges
+std::vector<unsigned> PageAllocator::parseList(const std::string& list) {
+	std::vector<unsigned> numbers;
+	size_t i = 0;
+
+	while (i < list.size()) {
+		char* end;
+		unsigned long first = std::strtoul(list.c_str() + i, &end, 10);
+		if (end == list.c_str() + i) {
+			break;
+		}
+		i = static_cast<size_t>(end - list.c_str());
+
+		unsigned long last = first;
+		if (i < list.size() && list[i] == '-') {
+			last = std::strtoul(list.c_str() + i + 1, &end, 10);
+			i = static_cast<size_t>(end - list.c_str());
+		}
+
+		for (unsigned long number = first; number <= last; number++) {
+			numbers.push_back(static_cast<unsigned>(number));
+		}
+
+		if (i < list.size() && list[i] == ',') {
+			i++;
+		}
+	}
+	return numbers;
+}
+
+// first line of the file
+std::string PageAllocator::readSystemFile(const std::string& path) {
+	std::ifstream file(path.c_str());
+	std::string line;
+	std::getline(file, line);
+	return line;
+}
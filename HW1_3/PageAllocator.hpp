@@ -0,0 +1,90 @@
+/**
+* File:		PageAllocator.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a PageAllocator class, that maps the large blocks of an Arena
+*			with the page size and NUMA placement asked for, and keeps worker threads on one NUMA node.
+*
+*			A multi-GB File is read by one thread, so with small pages it costs a TLB entry per 4 KB and, on a
+*			host with several NUMA nodes, all of it is first touched on the node of the reading thread. Blocks
+*			can be mapped with transparent huge pages (2 MB aligned, advised with MADV_HUGEPAGE) or with explicit
+*			huge pages from the kernel's hugetlb pool, which fall back to transparent ones when the pool is empty.
+*			Interleaved blocks are spread page by page over every node, so threads on any node find part of the
+*			File local and none of the nodes is saturated. Local blocks are placed by first touch, on the node of
+*			the thread that fills them, which is right for an arena of each worker.
+*
+*			NUMA placement and binding use the kernel directly (mbind, sched_setaffinity and the node lists in
+*			/sys), so there is no dependency on libnuma, and both do nothing on a host with one node. Elsewhere
+*			than Linux blocks come from the heap and threads are not bound.
+*/
+
+#ifndef PAGE_ALLOCATOR_HPP
+#define PAGE_ALLOCATOR_HPP
+
+// includes
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// class definition
+class PageAllocator {
+public:
+	// page size of a mapping
+	enum Pages {
+		SMALL_PAGES, TRANSPARENT_HUGE_PAGES, EXPLICIT_HUGE_PAGES
+	};
+
+	// NUMA node of a mapping's pages
+	enum Placement {
+		LOCAL, INTERLEAVED
+	};
+
+	// how blocks are mapped, the default is the heap's small local pages
+	struct Policy {
+		Pages pages = SMALL_PAGES;
+		Placement placement = LOCAL;
+
+		// true if blocks are mapped rather than taken from the heap
+		bool mapped() const {
+			return pages != SMALL_PAGES || placement != LOCAL;
+		}
+	};
+
+	// size of a huge page, mapped blocks are a multiple of it
+	static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	// constructor/destructor
+	PageAllocator();
+	virtual ~PageAllocator();
+
+	// name of a page size or placement, as accepted by parse
+	static const char* name(Pages pages);
+	static const char* name(Placement placement);
+	// page size named off, transparent or explicit, throws invalid_argument otherwise
+	static Pages parsePages(const std::string& name);
+	// placement named local or interleave, throws invalid_argument otherwise
+	static Placement parsePlacement(const std::string& name);
+
+	// size rounded up to a whole number of huge pages
+	static size_t roundUp(size_t size);
+
+	// map size bytes, a multiple of HUGE_PAGE_SIZE, with the policy, throws std::bad_alloc
+	static void* allocate(size_t size, const Policy& policy);
+	// unmap memory returned by allocate
+	static void release(void* memory, size_t size);
+
+	// number of NUMA nodes, 1 when there is no NUMA information
+	static unsigned nodes();
+	// restrict the calling thread to the CPUs of a node, false if it could not be
+	static bool bindToNode(unsigned node);
+	// bind worker w of a pool to node w modulo the nodes, does nothing on a host with one node
+	static void bindWorker(unsigned worker);
+
+private:
+	// numbers in a kernel list such as 0-3,8-11
+	static std::vector<unsigned> parseList(const std::string& list);
+	// contents of a small file in /sys, empty if it cannot be read
+	static std::string readSystemFile(const std::string& path);
+}; // end class PageAllocator
+
+#endif
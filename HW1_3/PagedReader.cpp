@@ -0,0 +1,362 @@
+/**
+* File:		PagedReader.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a PagedReader class, that builds a sparse checkpoint index of word
+*			numbers over a large file and reads ranges of words from it.
+*
+*			Saved index layout, all integers 8 bytes little endian:
+*				"FFPAGES2", page size, file size, file modification time in nanoseconds, sample hash,
+*				word count, page count, then the ordinal of the first word of each page
+*/
+
+#include "PagedReader.hpp"
+#include "WordTokenizer.hpp"
+#include "WordKernels.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <cstring>
+
+#include <sys/stat.h>
+
+// magic number of a saved index, the last character is the layout version
+static const char INDEX_MAGIC[8] = { 'F', 'F', 'P', 'A', 'G', 'E', 'S', '2' };
+
+// bytes hashed at the start of each page and at the end of the file, to tell a rewritten file from the indexed one
+static const size_t SAMPLE_SIZE = 64;
+
+// modification time of the file in nanoseconds, to the second where the system records no more, 0 if unknown
+static std::uint64_t modificationTime(const std::string& path) {
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0) {
+		return 0;
+	}
+
+	std::uint64_t nanoseconds = static_cast<std::uint64_t>(info.st_mtime) * 1000000000;
+#if defined(__APPLE__)
+	nanoseconds += static_cast<std::uint64_t>(info.st_mtimespec.tv_nsec);
+#elif !defined(_WIN32)
+	nanoseconds += static_cast<std::uint64_t>(info.st_mtim.tv_nsec);
+#endif
+	return nanoseconds;
+}
+
+// append an unsigned integer, 8 bytes little endian
+static void putLittleEndian(std::string& out, std::uint64_t value) {
+	for (size_t i = 0; i < 8; i++) {
+		out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+}
+
+// read an unsigned integer, 8 bytes little endian, false at the end of the stream
+static bool getLittleEndian(std::istream& in, std::uint64_t& value) {
+	unsigned char bytes[8];
+	if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+		return false;
+	}
+	value = 0;
+	for (size_t i = 0; i < 8; i++) {
+		value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+	}
+	return true;
+}
+
+// open the file, load its saved index if there is one for it, otherwise build the index and save it if asked to
+PagedReader::PagedReader(const std::string& path, unsigned threads, const std::string& indexPath)
+	: m_path(path), m_size(0), m_modified(0), m_sampleHash(0), m_words(0), m_loaded(false) {
+
+	std::ifstream input(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + path);
+	}
+	m_size = static_cast<std::uint64_t>(input.tellg());
+
+	m_modified = modificationTime(path);
+	if (!indexPath.empty()) {
+		m_sampleHash = sampleHash(input);
+	}
+
+	if (!indexPath.empty() && loadIndex(indexPath)) {
+		m_loaded = true;
+		return;
+	}
+
+	buildIndex(threads);
+
+	if (!indexPath.empty()) {
+		saveIndex(indexPath);
+	}
+}
+
+// empty
+PagedReader::~PagedReader() {
+
+}
+
+// number of words
+std::uint64_t PagedReader::wordCount() const {
+	return m_words;
+}
+
+// size of the file
+std::uint64_t PagedReader::fileSize() const {
+	return m_size;
+}
+
+// number of checkpoints
+size_t PagedReader::checkpointCount() const {
+	return m_checkpoints.size();
+}
+
+// loaded or built
+bool PagedReader::indexLoaded() const {
+	return m_loaded;
+}
+
+// seek to the page holding the first word and tokenize until the last word
+void PagedReader::readRange(std::uint64_t first, std::uint64_t last, const WordHandler& handler) const {
+	if (last > m_words) {
+		last = m_words;
+	}
+	if (first >= last) {
+		return;
+	}
+
+	// last page whose first word is not after the word wanted, the word starts in that page
+	Checkpoint key;
+	key.offset = 0;
+	key.ordinal = first;
+	std::vector<Checkpoint>::const_iterator page = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), key,
+		[](const Checkpoint& a, const Checkpoint& b) { return a.ordinal < b.ordinal; });
+	--page;
+
+	std::ifstream input(m_path.c_str(), std::ios::in | std::ios::binary);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + m_path);
+	}
+
+	// a word continuing from the previous page was counted there, skip its tail
+	bool skipPartial = false;
+	std::uint64_t offset = page->offset;
+	if (offset > 0) {
+		input.seekg(static_cast<std::streamoff>(offset - 1));
+		char previous;
+		input.get(previous);
+		skipPartial = !WordTokenizer::isDelimiter(previous);
+	}
+	else {
+		input.seekg(0);
+	}
+
+	std::uint64_t ordinal = page->ordinal;
+	bool done = false;
+
+	// count words from the checkpoint, hand over the ones in the range
+	auto sink = [&](const std::string& word) {
+		if (done) {
+			return;
+		}
+		if (ordinal >= first) {
+			handler(word);
+		}
+		if (++ordinal >= last) {
+			done = true;
+		}
+	};
+
+	WordTokenizer tokenizer;
+	std::vector<char> block(PAGE_SIZE);
+
+	while (!done && input) {
+		input.read(block.data(), block.size());
+		size_t length = static_cast<size_t>(input.gcount());
+		size_t start = 0;
+
+		if (skipPartial) {
+			while (start < length && !WordTokenizer::isDelimiter(block[start])) {
+				start++;
+			}
+			// still inside the word if the whole block was skipped
+			skipPartial = start == length;
+		}
+
+		tokenizer.feed(block.data() + start, length - start, sink);
+	}
+
+	tokenizer.finish(sink);
+}
+
+// the last count words
+void PagedReader::readTail(std::uint64_t count, const WordHandler& handler) const {
+	readRange(count >= m_words ? 0 : m_words - count, m_words, handler);
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// count the words of every page in parallel, then turn the counts into checkpoints
+void PagedReader::buildIndex(unsigned threads) {
+	size_t pages = static_cast<size_t>((m_size + PAGE_SIZE - 1) / PAGE_SIZE);
+	std::vector<std::uint64_t> counts(pages, 0);
+
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+	if (threads > pages) {
+		threads = pages > 0 ? static_cast<unsigned>(pages) : 1;
+	}
+
+	// each worker counts a contiguous run of pages with its own stream
+	std::vector<std::thread> workers;
+	std::vector<std::exception_ptr> errors(threads);
+	size_t perThread = (pages + threads - 1) / threads;
+
+	for (unsigned w = 0; w < threads; w++) {
+		size_t first = std::min(pages, w * perThread);
+		size_t last = std::min(pages, first + perThread);
+
+		workers.push_back(std::thread([this, first, last, w, &counts, &errors]() {
+			try {
+				countPages(first, last, counts);
+			}
+			catch (...) {
+				errors[w] = std::current_exception();
+			}
+		}));
+	}
+
+	for (size_t w = 0; w < workers.size(); w++) {
+		workers[w].join();
+	}
+	for (size_t w = 0; w < errors.size(); w++) {
+		if (errors[w]) {
+			std::rethrow_exception(errors[w]);
+		}
+	}
+
+	// running total of the counts
+	m_checkpoints.reserve(pages);
+	for (size_t p = 0; p < pages; p++) {
+		Checkpoint checkpoint;
+		checkpoint.offset = static_cast<std::uint64_t>(p) * PAGE_SIZE;
+		checkpoint.ordinal = m_words;
+		m_checkpoints.push_back(checkpoint);
+
+		m_words += counts[p];
+	}
+}
+
+// count word starts: a word starts at a non-delimiter that follows a delimiter or the start of the file
+void PagedReader::countPages(size_t first, size_t last, std::vector<std::uint64_t>& counts) const {
+	if (first >= last) {
+		return;
+	}
+
+	std::ifstream input(m_path.c_str(), std::ios::in | std::ios::binary);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + m_path);
+	}
+
+	// the character before the first page decides if it starts inside a word
+	bool inWord = false;
+	std::uint64_t offset = static_cast<std::uint64_t>(first) * PAGE_SIZE;
+	if (offset > 0) {
+		input.seekg(static_cast<std::streamoff>(offset - 1));
+		char previous;
+		input.get(previous);
+		inWord = !WordTokenizer::isDelimiter(previous);
+	}
+
+	std::vector<char> page(PAGE_SIZE);
+	const WordKernels& kernels = WordKernels::select();
+
+	for (size_t p = first; p < last; p++) {
+		input.read(page.data(), page.size());
+		size_t length = static_cast<size_t>(input.gcount());
+
+		counts[p] = kernels.countWordStarts(page.data(), length, inWord);
+		if (length > 0) {
+			inWord = !WordTokenizer::isDelimiter(page[length - 1]);
+		}
+	}
+}
+
+// FNV-1a hash of the first SAMPLE_SIZE bytes of every page and the last SAMPLE_SIZE bytes of the file
+std::uint64_t PagedReader::sampleHash(std::istream& input) const {
+	std::uint64_t hash = 14695981039346656037ULL;
+	std::vector<std::uint64_t> offsets;
+	for (std::uint64_t offset = 0; offset < m_size; offset += PAGE_SIZE) {
+		offsets.push_back(offset);
+	}
+	offsets.push_back(m_size > SAMPLE_SIZE ? m_size - SAMPLE_SIZE : 0);
+
+	char sample[SAMPLE_SIZE];
+	for (size_t i = 0; i < offsets.size(); i++) {
+		input.clear();
+		input.seekg(static_cast<std::streamoff>(offsets[i]));
+		input.read(sample, sizeof(sample));
+		size_t length = static_cast<size_t>(input.gcount());
+
+		for (size_t b = 0; b < length; b++) {
+			hash = (hash ^ static_cast<unsigned char>(sample[b])) * 1099511628211ULL;
+		}
+	}
+	return hash;
+}
+
+// a saved index is used only if it was saved for a file of the same size, modification time and sampled bytes
+bool PagedReader::loadIndex(const std::string& indexPath) {
+	std::ifstream input(indexPath.c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(INDEX_MAGIC)];
+	if (!input.read(magic, sizeof(magic)) || memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0) {
+		return false;
+	}
+
+	std::uint64_t pageSize, size, modified, hash, words, pages;
+	if (!getLittleEndian(input, pageSize) || !getLittleEndian(input, size) || !getLittleEndian(input, modified)
+		|| !getLittleEndian(input, hash) || !getLittleEndian(input, words) || !getLittleEndian(input, pages)) {
+		return false;
+	}
+	if (pageSize != PAGE_SIZE || size != m_size || modified != m_modified || hash != m_sampleHash
+		|| pages != (m_size + PAGE_SIZE - 1) / PAGE_SIZE) {
+		return false;
+	}
+
+	std::vector<Checkpoint> checkpoints(static_cast<size_t>(pages));
+	for (size_t p = 0; p < checkpoints.size(); p++) {
+		checkpoints[p].offset = static_cast<std::uint64_t>(p) * PAGE_SIZE;
+		if (!getLittleEndian(input, checkpoints[p].ordinal)) {
+			return false;
+		}
+	}
+
+	m_words = words;
+	m_checkpoints.swap(checkpoints);
+	return true;
+}
+
+// header, then the first word of each page
+void PagedReader::saveIndex(const std::string& indexPath) const {
+	std::string index(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	putLittleEndian(index, PAGE_SIZE);
+	putLittleEndian(index, m_size);
+	putLittleEndian(index, m_modified);
+	putLittleEndian(index, m_sampleHash);
+	putLittleEndian(index, m_words);
+	putLittleEndian(index, m_checkpoints.size());
+	for (size_t p = 0; p < m_checkpoints.size(); p++) {
+		putLittleEndian(index, m_checkpoints[p].ordinal);
+	}
+
+	std::ofstream output(indexPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	output.write(index.data(), static_cast<std::streamsize>(index.size()));
+	if (!output) {
+		throw std::runtime_error("Unable to save index " + indexPath);
+	}
+}
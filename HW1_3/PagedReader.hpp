@@ -0,0 +1,86 @@
+/**
+* File:		PagedReader.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a PagedReader class, that gives random access by word number to
+*			a large uncompressed input file without parsing all of it. The file is split into fixed size pages
+*			and the words starting in each page are counted in parallel, giving a sparse checkpoint index from
+*			byte offset to word number. A range of words is then read by seeking to the page holding its first
+*			word and tokenizing from there, so "words M through N" and "the last K words" cost about one page
+*			plus the words themselves, whatever the size of the file.
+*
+*			Building the index reads the whole file once, so without a saved index every open costs a pass over
+*			the file. Given an index path, the index is saved there after it is built and loaded from there on
+*			later opens, as long as the file has the same size, the same modification time (to the nanosecond,
+*			where the system records it) and the same bytes at the start of every page and at its end, so only
+*			the first open reads the whole file.
+*/
+
+#ifndef PAGED_READER_HPP
+#define PAGED_READER_HPP
+
+// includes
+#include <istream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class PagedReader {
+public:
+	// size of a page, the distance between checkpoints
+	static const size_t PAGE_SIZE = 1024 * 1024;
+
+	// word callback, called with each word of a range in order
+	typedef std::function<void(const std::string&)> WordHandler;
+
+	// open the file and build the checkpoint index, threads is the number of workers (0 for all cores)
+	// with an index path, a saved index of the unchanged file is loaded instead, and a new one is saved there
+	// throws std::runtime_error if the file cannot be read or the index cannot be saved
+	explicit PagedReader(const std::string& path, unsigned threads = 0, const std::string& indexPath = std::string());
+	virtual ~PagedReader();
+
+	// number of words in the file
+	std::uint64_t wordCount() const;
+	// size of the file in bytes
+	std::uint64_t fileSize() const;
+	// number of checkpoints in the index
+	size_t checkpointCount() const;
+	// true if the index was loaded from the index path rather than built
+	bool indexLoaded() const;
+
+	// call handler with words first through last - 1, in order, last is clamped to the word count
+	void readRange(std::uint64_t first, std::uint64_t last, const WordHandler& handler) const;
+	// call handler with the last count words, in order
+	void readTail(std::uint64_t count, const WordHandler& handler) const;
+
+private:
+	// a checkpoint: the first word starting at or after offset is word number ordinal
+	struct Checkpoint {
+		std::uint64_t offset;
+		std::uint64_t ordinal;
+	};
+
+	// count the words of every page in parallel and turn the counts into checkpoints
+	void buildIndex(unsigned threads);
+	// count the words starting in each page from first to last - 1, storing the counts in counts
+	void countPages(size_t first, size_t last, std::vector<std::uint64_t>& counts) const;
+	// load the index saved for this file at indexPath, false if there is none or it is for another file
+	bool loadIndex(const std::string& indexPath);
+	// hash of the bytes sampled from the file, read through input, stored with a saved index
+	std::uint64_t sampleHash(std::istream& input) const;
+	// save the index to indexPath
+	void saveIndex(const std::string& indexPath) const;
+
+	std::string m_path;
+	std::uint64_t m_size;
+	std::uint64_t m_modified;
+	std::uint64_t m_sampleHash;
+	std::uint64_t m_words;
+	std::vector<Checkpoint> m_checkpoints;
+	bool m_loaded;
+}; // end class PagedReader
+
+#endif
@@ -0,0 +1,417 @@
+/**
+* File:		PatternFilter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a PatternFilter class, that selects the words a print mode prints.
+*/
+
+// includes
+#include "PatternFilter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PATTERN_FILTER_SSE2
+#endif
+
+// constructor, matches every word
+PatternFilter::PatternFilter() :
+	m_kind(ALL),
+	m_minimumLength(0),
+	m_repeating(0),
+	m_skippable(0),
+	m_positions(0),
+	m_anchoredStart(false),
+	m_anchoredEnd(false) {
+
+}
+
+// destructor
+PatternFilter::~PatternFilter() {
+	// empty
+}
+
+// words containing text
+PatternFilter PatternFilter::literal(const std::string& text) {
+	PatternFilter filter;
+	filter.m_kind = LITERAL;
+	filter.m_literal = text;
+	filter.m_minimumLength = text.size();
+	return filter;
+}
+
+// words starting with text
+PatternFilter PatternFilter::prefix(const std::string& text) {
+	PatternFilter filter;
+	filter.m_kind = PREFIX;
+	filter.m_literal = text;
+	filter.m_minimumLength = text.size();
+	return filter;
+}
+
+// words containing any of the literals
+PatternFilter PatternFilter::anyOf(const std::vector<std::string>& literals) {
+	if (literals.empty()) {
+		throw std::invalid_argument("A filter needs at least one literal");
+	}
+
+	PatternFilter filter;
+	filter.m_kind = ANY_OF;
+	filter.buildAutomaton(literals);
+	return filter;
+}
+
+// words matching the regular expression
+PatternFilter PatternFilter::regex(const std::string& pattern) {
+	PatternFilter filter;
+	filter.m_kind = REGEX;
+	filter.compileRegex(pattern);
+	return filter;
+}
+
+// kind of filter
+PatternFilter::Kind PatternFilter::kind() const {
+	return m_kind;
+}
+
+// true unless every word matches
+bool PatternFilter::active() const {
+	return m_kind != ALL;
+}
+
+// true if the word matches
+bool PatternFilter::matches(const char* word, size_t length) const {
+	if (length < m_minimumLength) {
+		return false;
+	}
+
+	switch (m_kind) {
+	case LITERAL:
+		return matchLiteral(word, length);
+	case PREFIX:
+		return std::memcmp(word, m_literal.data(), m_literal.size()) == 0;
+	case ANY_OF:
+		return matchAnyOf(word, length);
+	case REGEX:
+		return matchRegex(word, length);
+	default:
+		return true;
+	}
+}
+
+// true if the std::string matches
+bool PatternFilter::matches(const std::string& word) const {
+	return matches(word.data(), word.size());
+}
+
+// filter a batch, the length test runs over the whole batch first and needs no word's characters
+void PatternFilter::select(const char* const* words, std::uint32_t* lengths, size_t count) const {
+	if (m_kind == ALL) {
+		return;
+	}
+
+	std::uint32_t minimum = static_cast<std::uint32_t>(std::min<size_t>(m_minimumLength, UINT32_MAX));
+	for (size_t i = 0; i < count; i++) {
+		lengths[i] = lengths[i] >= minimum ? lengths[i] : 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (lengths[i] > 0 && !matches(words[i], lengths[i])) {
+			lengths[i] = 0;
+		}
+	}
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// substring search, long words compare the first and last byte of the literal at 16 positions at once,
+// only positions where both match are compared in full
+bool PatternFilter::matchLiteral(const char* word, size_t length) const {
+	size_t size = m_literal.size();
+	if (size == 0) {
+		return true;
+	}
+
+	const char* literal = m_literal.data();
+	size_t i = 0;
+
+#ifdef PATTERN_FILTER_SSE2
+	const __m128i first = _mm_set1_epi8(literal[0]);
+	const __m128i last = _mm_set1_epi8(literal[size - 1]);
+
+	// both loads stay inside the word while i + 16 + size - 1 <= length
+	for (; i + 16 + size - 1 <= length; i += 16) {
+		__m128i front = _mm_loadu_si128(reinterpret_cast<const __m128i*>(word + i));
+		__m128i back = _mm_loadu_si128(reinterpret_cast<const __m128i*>(word + i + size - 1));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(front, first), _mm_cmpeq_epi8(back, last))));
+
+		while (mask != 0) {
+			unsigned bit = 0;
+			while ((mask & (1u << bit)) == 0) {
+				bit++;
+			}
+			if (std::memcmp(word + i + bit, literal, size) == 0) {
+				return true;
+			}
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	// the rest, and short words, a byte at a time from each occurrence of the first byte
+	while (i + size <= length) {
+		const void* found = std::memchr(word + i, literal[0], length - size + 1 - i);
+		if (found == nullptr) {
+			return false;
+		}
+
+		i = static_cast<size_t>(static_cast<const char*>(found) - word);
+		if (std::memcmp(word + i, literal, size) == 0) {
+			return true;
+		}
+		i++;
+	}
+	return false;
+}
+
+// one table lookup per character, accepting states include every literal ending there
+bool PatternFilter::matchAnyOf(const char* word, size_t length) const {
+	if (m_accepting[0]) {
+		return true;
+	}
+
+	std::uint32_t state = 0;
+	for (size_t i = 0; i < length; i++) {
+		state = m_transitions[state * 256 + static_cast<unsigned char>(word[i])];
+		if (m_accepting[state]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// all positions the pattern could be at are tracked together, bit i for position i
+bool PatternFilter::matchRegex(const char* word, size_t length) const {
+	const std::uint64_t matched = std::uint64_t(1) << m_positions;
+
+	// add the positions reached by skipping optional ones
+	auto close = [this](std::uint64_t set) {
+		std::uint64_t next = set | ((set & m_skippable) << 1);
+		while (next != set) {
+			set = next;
+			next = set | ((set & m_skippable) << 1);
+		}
+		return set;
+	};
+
+	std::uint64_t set = close(1);
+	if (!m_anchoredEnd && (set & matched) != 0) {
+		return true;
+	}
+
+	for (size_t i = 0; i < length; i++) {
+		std::uint64_t accepted = set & m_accepts[static_cast<unsigned char>(word[i])];
+
+		// repeating positions stay, the others move on
+		set = (accepted & m_repeating) | ((accepted & ~m_repeating) << 1);
+		if (!m_anchoredStart) {
+			set |= 1;
+		}
+		set = close(set);
+
+		if (!m_anchoredEnd && (set & matched) != 0) {
+			return true;
+		}
+		if (set == 0) {
+			return false;
+		}
+	}
+	return (set & matched) != 0;
+}
+
+// trie of the literals, then failure links breadth first, folded into the transitions so matching never backs up
+void PatternFilter::buildAutomaton(const std::vector<std::string>& literals) {
+	std::vector<std::int64_t> edges(256, -1);
+	m_accepting.assign(1, false);
+	m_minimumLength = literals[0].size();
+
+	for (const std::string& literal : literals) {
+		size_t state = 0;
+		for (char c : literal) {
+			std::int64_t& edge = edges[state * 256 + static_cast<unsigned char>(c)];
+			if (edge < 0) {
+				edge = static_cast<std::int64_t>(m_accepting.size());
+				m_accepting.push_back(false);
+				edges.resize(edges.size() + 256, -1);
+			}
+			state = static_cast<size_t>(edges[state * 256 + static_cast<unsigned char>(c)]);
+		}
+		m_accepting[state] = true;
+		m_minimumLength = std::min(m_minimumLength, literal.size());
+	}
+
+	size_t states = m_accepting.size();
+	m_transitions.assign(states * 256, 0);
+	std::vector<std::uint32_t> failure(states, 0);
+	std::deque<std::uint32_t> queue;
+
+	for (size_t c = 0; c < 256; c++) {
+		if (edges[c] >= 0) {
+			m_transitions[c] = static_cast<std::uint32_t>(edges[c]);
+			queue.push_back(m_transitions[c]);
+		}
+	}
+
+	while (!queue.empty()) {
+		std::uint32_t state = queue.front();
+		queue.pop_front();
+
+		// the failure state is shallower, so it is already complete
+		if (m_accepting[failure[state]]) {
+			m_accepting[state] = true;
+		}
+
+		for (size_t c = 0; c < 256; c++) {
+			std::int64_t edge = edges[state * 256 + c];
+			std::uint32_t fallback = m_transitions[failure[state] * 256 + c];
+			if (edge < 0) {
+				m_transitions[state * 256 + c] = fallback;
+			}
+			else {
+				m_transitions[state * 256 + c] = static_cast<std::uint32_t>(edge);
+				failure[static_cast<size_t>(edge)] = fallback;
+				queue.push_back(static_cast<std::uint32_t>(edge));
+			}
+		}
+	}
+}
+
+// parse the pattern into positions, each a set of accepted characters that occurs once, optionally, or repeats
+void PatternFilter::compileRegex(const std::string& pattern) {
+	m_accepts.assign(256, 0);
+	size_t i = 0;
+	size_t end = pattern.size();
+
+	if (end > 0 && pattern[0] == '^') {
+		m_anchoredStart = true;
+		i = 1;
+	}
+
+	// a trailing $ anchors unless it is escaped
+	if (end > i && pattern[end - 1] == '$') {
+		size_t backslashes = 0;
+		while (end - 1 - backslashes > i && pattern[end - 2 - backslashes] == '\\') {
+			backslashes++;
+		}
+		if (backslashes % 2 == 0) {
+			m_anchoredEnd = true;
+			end--;
+		}
+	}
+
+	while (i < end) {
+		// the characters of this position
+		bool accepted[256] = { false };
+		char c = pattern[i++];
+
+		if (c == '*' || c == '+' || c == '?') {
+			throw std::invalid_argument("Nothing to repeat in regular expression " + pattern);
+		}
+		else if (c == '.') {
+			std::fill(accepted, accepted + 256, true);
+		}
+		else if (c == '\\') {
+			if (i == end) {
+				throw std::invalid_argument("Trailing backslash in regular expression " + pattern);
+			}
+			accepted[static_cast<unsigned char>(pattern[i++])] = true;
+		}
+		else if (c == '[') {
+			bool negated = i < end && pattern[i] == '^';
+			if (negated) {
+				i++;
+			}
+
+			// a ] first is a character of the class
+			bool first = true;
+			while (i < end && (pattern[i] != ']' || first)) {
+				first = false;
+				unsigned char low = static_cast<unsigned char>(pattern[i++]);
+				if (low == '\\' && i < end) {
+					low = static_cast<unsigned char>(pattern[i++]);
+				}
+
+				unsigned char high = low;
+				if (i + 1 < end && pattern[i] == '-' && pattern[i + 1] != ']') {
+					high = static_cast<unsigned char>(pattern[i + 1]);
+					i += 2;
+					if (high == '\\' && i < end) {
+						high = static_cast<unsigned char>(pattern[i++]);
+					}
+					if (high < low) {
+						throw std::invalid_argument("Invalid range in regular expression " + pattern);
+					}
+				}
+
+				for (unsigned character = low; character <= high; character++) {
+					accepted[character] = true;
+				}
+			}
+
+			if (i == end) {
+				throw std::invalid_argument("Unterminated [ in regular expression " + pattern);
+			}
+			i++;
+
+			if (negated) {
+				for (bool& character : accepted) {
+					character = !character;
+				}
+			}
+		}
+		else {
+			accepted[static_cast<unsigned char>(c)] = true;
+		}
+
+		// the repeat, a+ is a followed by a*
+		char repeat = i < end ? pattern[i] : '\0';
+		if (repeat == '*' || repeat == '+' || repeat == '?') {
+			i++;
+			if (i < end && (pattern[i] == '*' || pattern[i] == '+' || pattern[i] == '?')) {
+				throw std::invalid_argument("Repeated repeat in regular expression " + pattern);
+			}
+		}
+
+		size_t copies = repeat == '+' ? 2 : 1;
+		for (size_t copy = 0; copy < copies; copy++) {
+			if (m_positions == MAX_REGEX_POSITIONS) {
+				throw std::invalid_argument("Regular expression is too long: " + pattern);
+			}
+
+			std::uint64_t bit = std::uint64_t(1) << m_positions;
+			for (size_t character = 0; character < 256; character++) {
+				if (accepted[character]) {
+					m_accepts[character] |= bit;
+				}
+			}
+
+			bool last = copy + 1 == copies;
+			if (last && (repeat == '*' || repeat == '+')) {
+				m_repeating |= bit;
+				m_skippable |= bit;
+			}
+			else if (last && repeat == '?') {
+				m_skippable |= bit;
+			}
+			else {
+				m_minimumLength++;
+			}
+			m_positions++;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+/**
+* File:		PatternFilter.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a PatternFilter class, that selects the words a print mode
+*			prints. A filter matches words containing a literal, words starting with a prefix, words containing any
+*			of several literals (an Aho-Corasick automaton, so the cost per character does not grow with the number
+*			of literals), or words matching a small regular expression. The default filter matches every word.
+*
+*			Filters are applied by the WordEmitter to a batch of queued words at a time, before any word is copied
+*			to the output: words too short to match are dropped across the whole batch first, and the rejected
+*			words are given a length of zero, which the emitter already skips. Words in a transformed mode (odd
+*			words reversed, alternating) are tested as stored, before they are transformed.
+*
+*			The regular expressions support literal characters, ., [abc], [a-z], [^...], the * + and ? repeats,
+*			\ escapes, and ^ and $ anchors. There is no grouping or alternation, so a pattern compiles to at most
+*			63 positions that are all tracked at once in one integer, and matching is linear in the word length.
+*/
+
+#ifndef PATTERN_FILTER_HPP
+#define PATTERN_FILTER_HPP
+
+// includes
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class PatternFilter {
+public:
+	// how words are matched
+	enum Kind {
+		ALL, LITERAL, PREFIX, ANY_OF, REGEX
+	};
+
+	// most positions in a regular expression, one bit each
+	static const size_t MAX_REGEX_POSITIONS = 63;
+
+	// constructor/destructor, the default filter matches every word
+	PatternFilter();
+	virtual ~PatternFilter();
+
+	// words containing text
+	static PatternFilter literal(const std::string& text);
+	// words starting with text
+	static PatternFilter prefix(const std::string& text);
+	// words containing any of the literals
+	static PatternFilter anyOf(const std::vector<std::string>& literals);
+	// words matching the regular expression, anywhere unless anchored, throws invalid_argument if malformed
+	static PatternFilter regex(const std::string& pattern);
+
+	// kind of filter
+	Kind kind() const;
+	// true unless the filter matches every word
+	bool active() const;
+
+	// true if the word matches
+	bool matches(const char* word, size_t length) const;
+	bool matches(const std::string& word) const;
+
+	// give the words of the batch that do not match a length of zero
+	void select(const char* const* words, std::uint32_t* lengths, size_t count) const;
+
+private:
+	// words containing m_literal
+	bool matchLiteral(const char* word, size_t length) const;
+	// words the automaton accepts
+	bool matchAnyOf(const char* word, size_t length) const;
+	// words the position sets reach the end of the pattern on
+	bool matchRegex(const char* word, size_t length) const;
+
+	// build the Aho-Corasick automaton for the literals
+	void buildAutomaton(const std::vector<std::string>& literals);
+	// compile the regular expression into position masks
+	void compileRegex(const std::string& pattern);
+
+	Kind m_kind;
+	// shortest word that can match
+	size_t m_minimumLength;
+
+	// literal or prefix
+	std::string m_literal;
+
+	// Aho-Corasick automaton, 256 transitions per state, failure links already folded in
+	std::vector<std::uint32_t> m_transitions;
+	std::vector<bool> m_accepting;
+
+	// regular expression, bit i of m_accepts[c] is set if position i accepts character c
+	std::vector<std::uint64_t> m_accepts;
+	// positions that repeat (*), and positions that may be skipped (* and ?)
+	std::uint64_t m_repeating;
+	std::uint64_t m_skippable;
+	// number of positions, the bit past the last one is the match
+	size_t m_positions;
+	bool m_anchoredStart;
+	bool m_anchoredEnd;
+}; // end class PatternFilter
+
+#endif
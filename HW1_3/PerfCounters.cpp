@@ -0,0 +1,263 @@
+/**
+* File:		PerfCounters.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a PerfCounters class, that measures phases of the program with the
+*			hardware performance counters, or with the timers when there are none.
+*/
+
+// includes
+#include "PerfCounters.hpp"
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+	// counter names, in Counter order
+	const char* const COUNTER_NAMES[PerfCounters::COUNTER_COUNT] = {
+		"cycles", "instructions", "L1D misses", "LLC misses", "branch misses", "page faults"
+	};
+
+#ifdef __linux__
+	// open one counting event for this process and the threads it starts, disabled until start
+	int openCounter(std::uint32_t type, std::uint64_t config) {
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = type;
+		attributes.config = config;
+		attributes.disabled = 1;
+		attributes.inherit = 1;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+	}
+
+	// a cache event's configuration, cache id, operation and result
+	std::uint64_t cacheEvent(std::uint64_t cache, std::uint64_t operation, std::uint64_t result) {
+		return cache | (operation << 8) | (result << 16);
+	}
+#endif
+
+} // end anonymous namespace
+
+// constructor, opens every counter it can
+PerfCounters::PerfCounters() : m_start(), m_startTime() {
+	for (int& descriptor : m_descriptors) {
+		descriptor = -1;
+	}
+
+#ifdef __linux__
+	m_descriptors[CYCLES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	m_descriptors[INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	m_descriptors[L1D_MISSES] = openCounter(PERF_TYPE_HW_CACHE,
+		cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+	m_descriptors[LLC_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	m_descriptors[BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+}
+
+// closes the counters
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+	for (int descriptor : m_descriptors) {
+		if (descriptor >= 0) {
+			close(descriptor);
+		}
+	}
+#endif
+}
+
+// name of a counter
+const char* PerfCounters::name(Counter counter) {
+	return COUNTER_NAMES[counter];
+}
+
+// page faults come from getrusage, the rest from their counters
+bool PerfCounters::available(Counter counter) const {
+#ifndef _WIN32
+	if (counter == PAGE_FAULTS) {
+		return true;
+	}
+#endif
+	return m_descriptors[counter] >= 0;
+}
+
+// true if any hardware counter is open
+bool PerfCounters::hardware() const {
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		if (counter != PAGE_FAULTS && m_descriptors[counter] >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// counters are reset and enabled, then the starting readings are taken
+void PerfCounters::start() {
+#ifdef __linux__
+	for (int descriptor : m_descriptors) {
+		if (descriptor >= 0) {
+			ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+			ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+
+	read(m_start);
+	m_startTime = std::chrono::steady_clock::now();
+}
+
+// the counters are disabled first, so reading them is not counted
+PerfCounters::Sample PerfCounters::stop() {
+	std::chrono::steady_clock::time_point stopTime = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+	for (int descriptor : m_descriptors) {
+		if (descriptor >= 0) {
+			ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+#endif
+
+	Sample sample;
+	read(sample);
+
+	sample.seconds = std::chrono::duration<double>(stopTime - m_startTime).count();
+	sample.cpuSeconds -= m_start.cpuSeconds;
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		sample.values[counter] -= m_start.values[counter];
+	}
+	return sample;
+}
+
+// write the phases as a table, unavailable counters shown as -
+void PerfCounters::writeTable(std::ostream& stream,
+	const std::string& backend,
+	const std::vector<std::pair<std::string, Sample> >& phases) {
+
+	if (phases.empty()) {
+		return;
+	}
+
+	// a total row, a counter is only totalled if every phase had it
+	Sample total = phases[0].second;
+	for (size_t p = 1; p < phases.size(); p++) {
+		const Sample& sample = phases[p].second;
+		total.seconds += sample.seconds;
+		total.cpuSeconds += sample.cpuSeconds;
+		for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+			total.values[counter] += sample.values[counter];
+			total.available[counter] = total.available[counter] && sample.available[counter];
+		}
+	}
+
+	bool hardware = false;
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		hardware = hardware || (counter != PAGE_FAULTS && total.available[counter]);
+	}
+
+	stream << "profile " << backend
+		<< (hardware ? "" : ", hardware counters unavailable, timers only") << std::endl;
+	stream << std::left << std::setw(36) << "phase" << std::right
+		<< std::setw(10) << "wall ms" << std::setw(10) << "cpu ms";
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		stream << std::setw(counter == INSTRUCTIONS ? 15 : 14) << COUNTER_NAMES[counter];
+		if (counter == INSTRUCTIONS) {
+			stream << std::setw(7) << "IPC";
+		}
+	}
+	stream << std::endl;
+
+	std::vector<std::pair<std::string, Sample> > rows = phases;
+	rows.push_back(std::make_pair(std::string("total"), total));
+
+	for (const std::pair<std::string, Sample>& row : rows) {
+		const Sample& sample = row.second;
+		stream << std::left << std::setw(36) << row.first.substr(0, 35) << std::right << std::fixed
+			<< std::setprecision(2) << std::setw(10) << sample.seconds * 1000
+			<< std::setw(10) << sample.cpuSeconds * 1000;
+
+		for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+			int width = counter == INSTRUCTIONS ? 15 : 14;
+			if (sample.available[counter]) {
+				stream << std::setw(width) << sample.values[counter];
+			}
+			else {
+				stream << std::setw(width) << "-";
+			}
+
+			// instructions per cycle
+			if (counter == INSTRUCTIONS) {
+				if (sample.available[CYCLES] && sample.available[INSTRUCTIONS] && sample.values[CYCLES] > 0) {
+					stream << std::setw(7) << static_cast<double>(sample.values[INSTRUCTIONS]) / sample.values[CYCLES];
+				}
+				else {
+					stream << std::setw(7) << "-";
+				}
+			}
+		}
+		stream << std::endl;
+	}
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// read every counter and the process's CPU time and page faults
+void PerfCounters::read(Sample& sample) const {
+	sample.seconds = 0;
+
+#ifndef _WIN32
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	sample.cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+		+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#else
+	sample.cpuSeconds = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		sample.values[counter] = 0;
+		sample.available[counter] = available(static_cast<Counter>(counter));
+	}
+
+#ifndef _WIN32
+	sample.values[PAGE_FAULTS] = static_cast<std::uint64_t>(usage.ru_minflt + usage.ru_majflt);
+#endif
+
+#ifdef __linux__
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		if (m_descriptors[counter] < 0) {
+			continue;
+		}
+
+		// value, time enabled, time running, scaled up if the counter was multiplexed with others
+		std::uint64_t reading[3] = { 0, 0, 0 };
+		if (::read(m_descriptors[counter], reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading))) {
+			sample.available[counter] = false;
+		}
+		else if (reading[2] > 0 && reading[2] < reading[1]) {
+			sample.values[counter] = static_cast<std::uint64_t>(
+				static_cast<double>(reading[0]) * reading[1] / reading[2]);
+		}
+		else {
+			sample.values[counter] = reading[0];
+		}
+	}
+#endif
+}
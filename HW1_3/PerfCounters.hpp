@@ -0,0 +1,80 @@
+/**
+* File:		PerfCounters.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a PerfCounters class, that measures a phase of the program with
+*			the hardware performance counters: cycles, instructions, L1 data and last level cache misses, branch
+*			misses and page faults, counted in user space for this process and the threads it starts.
+*
+*			On Linux the counters are opened with perf_event_open, each on its own, so one the processor or the
+*			kernel does not offer (virtual machines and containers often offer none) leaves the others working.
+*			Counters that cannot be opened are reported as unavailable, and the phase is still measured with the
+*			timers: wall time, CPU time and page faults always come from the clock and getrusage. Elsewhere only
+*			the timers are used.
+*/
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+// includes
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// class definition
+class PerfCounters {
+public:
+	// the counters, in the order they are reported
+	enum Counter {
+		CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, PAGE_FAULTS, COUNTER_COUNT
+	};
+
+	// one measured phase, a counter's value is only meaningful if it was available
+	struct Sample {
+		double seconds;
+		double cpuSeconds;
+		std::uint64_t values[COUNTER_COUNT];
+		bool available[COUNTER_COUNT];
+	};
+
+	// constructor/destructor, the counters are opened once and closed by the destructor
+	PerfCounters();
+	virtual ~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// name of a counter, as reported
+	static const char* name(Counter counter);
+
+	// true if the counter could be opened, page faults are always available
+	bool available(Counter counter) const;
+	// true if any hardware counter could be opened
+	bool hardware() const;
+
+	// start measuring a phase
+	void start();
+	// stop measuring, return what the phase counted
+	Sample stop();
+
+	// write a table of the phases to stream, one row each, labelled with the backend
+	static void writeTable(std::ostream& stream,
+		const std::string& backend,
+		const std::vector<std::pair<std::string, Sample> >& phases);
+
+private:
+	// read the counters and the timers now
+	void read(Sample& sample) const;
+
+	// counter descriptors, -1 where a counter could not be opened
+	int m_descriptors[COUNTER_COUNT];
+
+	// readings at start
+	Sample m_start;
+	std::chrono::steady_clock::time_point m_startTime;
+}; // end class PerfCounters
+
+#endif
@@ -0,0 +1,108 @@
+/**
+* File:		ReverseReader.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a ReverseReader class, that tokenizes a file from its end.
+*/
+
+#include "ReverseReader.hpp"
+#include "WordTokenizer.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+// open the file to find its size
+ReverseReader::ReverseReader(const std::string& path) : m_path(path), m_size(0) {
+	std::ifstream input(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + path);
+	}
+	m_size = static_cast<std::uint64_t>(input.tellg());
+}
+
+// empty
+ReverseReader::~ReverseReader() {
+
+}
+
+// size of the file
+std::uint64_t ReverseReader::fileSize() const {
+	return m_size;
+}
+
+// read blocks from the last to the first, scanning each from its end
+// a word reaching the start of a block is carried into the previous block, where it is completed
+void ReverseReader::read(const WordHandler& handler) const {
+	if (m_size == 0) {
+		return;
+	}
+
+	std::ifstream input(m_path.c_str(), std::ios::in | std::ios::binary);
+	if (!input) {
+		throw std::runtime_error("Unable to open " + m_path);
+	}
+
+	std::vector<char> block(BLOCK_SIZE);
+	// end of a word started in a later block
+	std::string carry;
+
+	// the last block is the partial one, the rest are aligned
+	std::uint64_t blockStart = (m_size - 1) / BLOCK_SIZE * BLOCK_SIZE;
+	std::uint64_t blockEnd = m_size;
+
+	while (true) {
+		size_t length = static_cast<size_t>(blockEnd - blockStart);
+
+		input.seekg(static_cast<std::streamoff>(blockStart));
+		input.read(block.data(), length);
+		if (static_cast<size_t>(input.gcount()) != length) {
+			throw std::runtime_error("Unable to read " + m_path);
+		}
+
+		const char* data = block.data();
+		size_t i = length;
+
+		while (i > 0) {
+			// characters of the word ending here
+			size_t end = i;
+			while (i > 0 && !WordTokenizer::isDelimiter(data[i - 1])) {
+				i--;
+			}
+
+			// the word may begin in the previous block
+			if (i == 0) {
+				carry.insert(0, data, end);
+				break;
+			}
+
+			// a delimiter precedes the word, so it is complete
+			if (carry.empty()) {
+				if (end > i) {
+					handler(data + i, end - i);
+				}
+			}
+			else {
+				carry.insert(0, data + i, end - i);
+				handler(carry.data(), carry.size());
+				carry.clear();
+			}
+
+			// skip the delimiters before it
+			while (i > 0 && WordTokenizer::isDelimiter(data[i - 1])) {
+				i--;
+			}
+		}
+
+		if (blockStart == 0) {
+			break;
+		}
+
+		blockEnd = blockStart;
+		blockStart -= BLOCK_SIZE;
+	}
+
+	// the first word of the file
+	if (!carry.empty()) {
+		handler(carry.data(), carry.size());
+	}
+}
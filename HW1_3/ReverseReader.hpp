@@ -0,0 +1,45 @@
+/**
+* File:		ReverseReader.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a ReverseReader class, that reads an uncompressed file backward
+*			from its end, in blocks aligned to the block size, and tokenizes it in reverse. Words come out last to
+*			first, the order of the backward print modes, as soon as the last block is read. Only one block and
+*			the word being assembled are held in memory, whatever the size of the file.
+*/
+
+#ifndef REVERSE_READER_HPP
+#define REVERSE_READER_HPP
+
+// includes
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class ReverseReader {
+public:
+	// size of a block, blocks start at multiples of this size
+	static const size_t BLOCK_SIZE = 256 * 1024;
+
+	// word callback, called with the characters and length of each word, last word first
+	// the characters are only valid during the call
+	typedef std::function<void(const char*, size_t)> WordHandler;
+
+	// open the file, throws std::runtime_error if the file cannot be read
+	explicit ReverseReader(const std::string& path);
+	virtual ~ReverseReader();
+
+	// size of the file in bytes
+	std::uint64_t fileSize() const;
+
+	// call handler with every word of the file, last to first
+	void read(const WordHandler& handler) const;
+
+private:
+	std::string m_path;
+	std::uint64_t m_size;
+}; // end class ReverseReader
+
+#endif
@@ -0,0 +1,243 @@
+/**
+* File:		SectionRouter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a SectionRouter class, that maps sections of the FileFactory
+*			report to files and file descriptors.
+*/
+
+#include "SectionRouter.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	// prefix of a file descriptor target
+	const std::string DESCRIPTOR_PREFIX = "fd:";
+
+	// stream buffer writing to a file descriptor it does not own, a write that fails sets badbit on the stream
+	class DescriptorStreamBuf : public std::streambuf {
+	public:
+		explicit DescriptorStreamBuf(int fd) : m_fd(fd), m_buffer(64 * 1024) {
+			setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+		}
+
+		virtual ~DescriptorStreamBuf() {
+			flush();
+		}
+
+	protected:
+		// buffer full, write it out
+		int_type overflow(int_type ch) {
+			if (!flush()) {
+				return traits_type::eof();
+			}
+
+			if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(ch);
+				pbump(1);
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		// write out what is buffered
+		int sync() {
+			return flush() ? 0 : -1;
+		}
+
+	private:
+		// write the whole buffer, retrying short and interrupted writes
+		bool flush() {
+			const char* data = pbase();
+			size_t length = static_cast<size_t>(pptr() - pbase());
+
+			while (length > 0) {
+#ifdef _WIN32
+				long written = _write(m_fd, data, static_cast<unsigned>(length));
+#else
+				long written = static_cast<long>(::write(m_fd, data, length));
+#endif
+				if (written < 0 && errno == EINTR) {
+					continue;
+				}
+				if (written <= 0) {
+					return false;
+				}
+				data += written;
+				length -= static_cast<size_t>(written);
+			}
+
+			setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+			return true;
+		}
+
+		int m_fd;
+		std::vector<char> m_buffer;
+	}; // end class DescriptorStreamBuf
+
+	// an output stream over a descriptor, owning its buffer
+	class DescriptorStream : public std::ostream {
+	public:
+		explicit DescriptorStream(int fd) : std::ostream(nullptr), m_buffer(fd) {
+			rdbuf(&m_buffer);
+		}
+
+	private:
+		DescriptorStreamBuf m_buffer;
+	}; // end class DescriptorStream
+
+} // end anonymous namespace
+
+// empty
+SectionRouter::SectionRouter() {
+
+}
+
+// empty
+SectionRouter::~SectionRouter() {
+
+}
+
+// route one section, every output takes one section only
+void SectionRouter::route(size_t section, const std::string& target) {
+	if (section >= FileReport::SECTION_COUNT) {
+		throw std::out_of_range("No such report section");
+	}
+	if (target.empty()) {
+		throw std::invalid_argument("A section needs somewhere to go");
+	}
+	if (!m_targets[section].empty()) {
+		throw std::invalid_argument("Section " + std::to_string(section) + " is already routed");
+	}
+
+	for (size_t other = 0; other < FileReport::SECTION_COUNT; other++) {
+		if (m_targets[other] == target) {
+			throw std::invalid_argument("Sections " + std::to_string(other) + " and " + std::to_string(section)
+				+ " are both routed to " + target);
+		}
+	}
+
+	m_targets[section] = target;
+}
+
+// N=TARGET
+void SectionRouter::route(const std::string& specification) {
+	size_t equals = specification.find('=');
+	if (equals == 0 || equals == std::string::npos) {
+		throw std::invalid_argument("A route is N=TARGET: " + specification);
+	}
+
+	std::string number = specification.substr(0, equals);
+	char* end;
+	unsigned long section = std::strtoul(number.c_str(), &end, 10);
+	if (*end != '\0') {
+		throw std::invalid_argument("No such report section: " + number);
+	}
+
+	route(static_cast<size_t>(section), specification.substr(equals + 1));
+}
+
+// every section left over gets a file in the directory
+void SectionRouter::routeAll(const std::string& directory) {
+#ifdef _WIN32
+	int made = _mkdir(directory.c_str());
+#else
+	int made = mkdir(directory.c_str(), 0777);
+#endif
+	if (made != 0 && errno != EEXIST) {
+		throw std::runtime_error("Unable to create " + directory);
+	}
+
+	std::string prefix = directory;
+	if (!prefix.empty() && prefix[prefix.size() - 1] != '/') {
+		prefix += '/';
+	}
+
+	for (size_t section = 0; section < FileReport::SECTION_COUNT; section++) {
+		if (m_targets[section].empty()) {
+			route(section, prefix + fileName(section));
+		}
+	}
+}
+
+// true if routed
+bool SectionRouter::routed(size_t section) const {
+	return !target(section).empty();
+}
+
+// true if any section is routed
+bool SectionRouter::active() const {
+	for (const std::string& target : m_targets) {
+		if (!target.empty()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// target of the section
+const std::string& SectionRouter::target(size_t section) const {
+	if (section >= FileReport::SECTION_COUNT) {
+		throw std::out_of_range("No such report section");
+	}
+
+	return m_targets[section];
+}
+
+// a descriptor is written to as it is, a file is created or truncated
+std::unique_ptr<std::ostream> SectionRouter::open(size_t section) const {
+	const std::string& path = target(section);
+	if (path.empty()) {
+		throw std::invalid_argument("Section " + std::to_string(section) + " is not routed");
+	}
+
+	if (path.compare(0, DESCRIPTOR_PREFIX.size(), DESCRIPTOR_PREFIX) == 0) {
+		std::string number = path.substr(DESCRIPTOR_PREFIX.size());
+		char* end;
+		long fd = std::strtol(number.c_str(), &end, 10);
+		if (number.empty() || *end != '\0' || fd < 0) {
+			throw std::invalid_argument("No such file descriptor: " + path);
+		}
+		return std::unique_ptr<std::ostream>(new DescriptorStream(static_cast<int>(fd)));
+	}
+
+	std::unique_ptr<std::ostream> file(new std::ofstream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc));
+	if (!*file) {
+		throw std::runtime_error("Unable to open " + path);
+	}
+	return file;
+}
+
+// number, then the title in lower case with a hyphen for each run of other characters
+std::string SectionRouter::fileName(size_t section) {
+	std::string name = section < 10 ? "0" : "";
+	name += std::to_string(section);
+
+	bool inWord = false;
+	for (const char* c = FileReport::title(section); *c != '\0'; ++c) {
+		if (std::isalnum(static_cast<unsigned char>(*c))) {
+			if (!inWord) {
+				name += '-';
+				inWord = true;
+			}
+			name += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+		}
+		else {
+			inWord = false;
+		}
+	}
+	return name + ".txt";
+}
@@ -0,0 +1,62 @@
+/**
+* File:		SectionRouter.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a SectionRouter class, that maps sections of the FileFactory
+*			report to outputs of their own: a file, or a file descriptor that is already open (fd:N). A routed
+*			output holds only the words of its section, without the title line, so nothing downstream has to
+*			split the report apart again. Sections that are not routed stay in the report, in order.
+*
+*			FileReport::writeRouted writes the routed sections concurrently, one worker per output at a time,
+*			all sharing the read-only File and its C-string array, while the calling thread writes the rest of
+*			the report. Each output can only take one section, so no two workers ever write to the same one.
+*			Routing a section to fd:1 mixes it into the rest of the report on std::cout, so it only makes sense
+*			when every other section is routed too.
+*/
+
+#ifndef SECTION_ROUTER_HPP
+#define SECTION_ROUTER_HPP
+
+// includes
+#include "FileReport.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+// class definition
+class SectionRouter {
+public:
+	// constructor/destructor, no section is routed
+	SectionRouter();
+	virtual ~SectionRouter();
+
+	// send the section to target, a path or fd:N
+	// throws out_of_range for a section that does not exist, invalid_argument if the section or the target is
+	// already routed
+	void route(size_t section, const std::string& target);
+	// route as given on the command line, N=TARGET
+	void route(const std::string& specification);
+	// send every section not routed yet to a file of its own in directory, named by fileName, the directory
+	// is created if it does not exist
+	void routeAll(const std::string& directory);
+
+	// true if the section is routed
+	bool routed(size_t section) const;
+	// true if any section is routed
+	bool active() const;
+	// target of the section, empty if it is not routed
+	const std::string& target(size_t section) const;
+
+	// open the section's output, throws runtime_error if it cannot be opened
+	std::unique_ptr<std::ostream> open(size_t section) const;
+
+	// file name of the section's output, its number and its title, as in 03-backward-normal-iterator.txt
+	static std::string fileName(size_t section);
+
+private:
+	// target of each section, empty when it stays in the report
+	std::string m_targets[FileReport::SECTION_COUNT];
+}; // end class SectionRouter
+
+#endif
@@ -0,0 +1,77 @@
+/**
+* File:		SharedFile.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a SharedFile class, a File shared by many threads through
+*			immutable snapshots.
+*/
+
+#include "SharedFile.hpp"
+
+// empty file
+SharedFile::SharedFile() : m_current(std::make_shared<const File>()), m_version(0) {
+
+}
+
+// take over the file
+SharedFile::SharedFile(File file) : m_current(std::make_shared<const File>(std::move(file))), m_version(0) {
+
+}
+
+// empty
+SharedFile::~SharedFile() {
+
+}
+
+// load the current version, the reference taken keeps it alive after a writer replaces it
+SharedFile::Snapshot SharedFile::snapshot() const {
+#ifdef FILEFACTORY_HAVE_ATOMIC_SHARED_PTR
+	return m_current.load();
+#else
+	return std::atomic_load(&m_current);
+#endif
+}
+
+// number of versions published
+std::uint64_t SharedFile::version() const {
+	return m_version.load();
+}
+
+// append one word
+void SharedFile::append(const std::string& word) {
+	append(std::vector<std::string>(1, word));
+}
+
+// copy the current version, append to the copy, and publish it
+void SharedFile::append(const std::vector<std::string>& words) {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	Snapshot current = snapshot();
+
+	// the copy goes on the heap even if the writer has an arena, it outlives the call
+#if CONTAINER == ARRAY
+	File copy(*current);
+#else
+	File copy(*current, ArenaAllocator<std::string>(nullptr));
+#endif
+	FileFactory::appendWords(copy, words);
+
+	store(std::make_shared<const File>(std::move(copy)));
+}
+
+// replace the current version
+void SharedFile::publish(File file) {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	store(std::make_shared<const File>(std::move(file)));
+}
+
+// publish the version, the writer holds the write mutex
+void SharedFile::store(Snapshot next) {
+#ifdef FILEFACTORY_HAVE_ATOMIC_SHARED_PTR
+	m_current.store(std::move(next));
+#else
+	std::atomic_store(&m_current, std::move(next));
+#endif
+	m_version++;
+}
@@ -0,0 +1,83 @@
+/**
+* File:		SharedFile.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a SharedFile class, a File shared by many threads. Readers take a
+*			snapshot, an immutable reference-counted version of the File, and print it without holding any lock;
+*			the snapshot stays valid and unchanged for as long as it is held. Writers never modify a published
+*			version: they copy the current one, append to the copy, and publish it in its place (read-copy-update),
+*			and the old version is freed when its last reader lets go of it.
+*
+*			Taking a snapshot and publishing a version each lock the current pointer just long enough to copy or
+*			swap it, never while a File is copied or printed. With C++20's std::atomic<std::shared_ptr> that lock
+*			belongs to the SharedFile; before C++20 the atomic shared_ptr functions take one from a pool shared
+*			by the whole program (in libstdc++ and libc++), so unrelated SharedFiles may briefly wait on each
+*			other. Neither is lock-free.
+*
+*			Appending copies the File, so writers should append words in batches. Writers are serialized with
+*			each other, and hold up readers only while the pointer is swapped.
+*/
+
+#ifndef SHARED_FILE_HPP
+#define SHARED_FILE_HPP
+
+// includes
+#include "FileFactory.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// std::atomic<std::shared_ptr>, where the library has it (C++20)
+#if defined(__cpp_lib_atomic_shared_ptr)
+#define FILEFACTORY_HAVE_ATOMIC_SHARED_PTR
+#endif
+
+// class definition
+class SharedFile {
+public:
+	// an immutable version of the File
+	typedef std::shared_ptr<const File> Snapshot;
+
+	// constructor/destructor, starts with an empty File, or with file
+	// an arena allocated file must not outlive its arena, versions made by append are always on the heap
+	SharedFile();
+	explicit SharedFile(File file);
+	virtual ~SharedFile();
+
+	// the current version, waits at most for a pointer swap, never for a writer's copy
+	Snapshot snapshot() const;
+	// number of versions published after the first
+	std::uint64_t version() const;
+
+	// publish a version with the words appended, readers see the previous version until it is published
+	// ARRAY files throw length_error when the words do not fit, and the current version is kept
+	void append(const std::string& word);
+	void append(const std::vector<std::string>& words);
+
+	// publish file as the new version
+	void publish(File file);
+
+private:
+	// not copyable
+	SharedFile(const SharedFile&);
+	SharedFile& operator=(const SharedFile&);
+
+	// publish next as the current version and count it
+	void store(Snapshot next);
+
+	// the current version
+#ifdef FILEFACTORY_HAVE_ATOMIC_SHARED_PTR
+	std::atomic<Snapshot> m_current;
+#else
+	// read and replaced with the atomic shared_ptr functions
+	Snapshot m_current;
+#endif
+	std::atomic<std::uint64_t> m_version;
+	// serializes writers
+	std::mutex m_writeMutex;
+}; // end class SharedFile
+
+#endif
@@ -0,0 +1,347 @@
+/**
+* File:		TransformPipeline.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file defines a framework of word transforms that are composed into pipelines at compile time.
+*
+*			A pipeline is TransformPipeline<Order, Stages...>. The order is a sequence level operator that decides
+*			which word is printed at each output position, and the stages are word level operators applied to
+*			each of those words, first to last. Every word level stage is a permutation of the characters of the
+*			word plus a mapping of each character, so a chain of stages collapses to a single source index and a
+*			single character map per output character. Each word is written out in one pass, with no
+*			intermediate strings, no matter how many stages there are.
+*
+*			New operators are registered by writing a struct with the same static members as the ones below.
+*			Word level stages derive from PipelineStage and hide the members they change:
+*				active(k)		true if the stage applies to the word at output position k
+*				source(i, n)	index of the source character for output character i of a word of length n
+*				map(c)			character mapping
+*				keep(word, n)	filter, false drops the word (filters test the words as stored)
+*			Sequence level operators provide:
+*				count(n)		number of output positions for n words
+*				position(k, n)	index of the word printed at output position k
+*
+*			The existing FileFactory modes are expressed this way at the end of this file. tools/PipelineCheck.cpp
+*			compares them with FileFactory on every File representation, and the differential tester runs it.
+*/
+
+#ifndef TRANSFORM_PIPELINE_HPP
+#define TRANSFORM_PIPELINE_HPP
+
+// includes
+#include "FileFactory.hpp"
+#include <algorithm>
+#include <vector>
+#include <string>
+
+// view of a word, characters and length
+struct WordView {
+	const char* data;
+	size_t length;
+};
+
+
+/// WORD LEVEL STAGES ///
+
+// base of all word level stages, the identity transform that keeps every word
+struct PipelineStage {
+	static bool active(size_t) { return true; }
+	static size_t source(size_t i, size_t) { return i; }
+	static char map(char c) { return c; }
+	static bool keep(const char*, size_t) { return true; }
+};
+
+// reverse the characters of the word
+struct ReverseStage : PipelineStage {
+	static size_t source(size_t i, size_t n) { return n - 1 - i; }
+};
+
+// alternate the characters of the word, first, last, second, next-to-last, etc.
+struct AlternateStage : PipelineStage {
+	static size_t source(size_t i, size_t n) { return i % 2 == 0 ? i / 2 : n - 1 - i / 2; }
+};
+
+// fold ASCII letters to lower case
+struct LowerCaseStage : PipelineStage {
+	static char map(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+};
+
+// fold ASCII letters to upper case
+struct UpperCaseStage : PipelineStage {
+	static char map(char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c; }
+};
+
+// apply a stage to odd words only, counting words from 1 in output order
+template <class Stage>
+struct OddWordsStage : Stage {
+	static bool active(size_t k) { return k % 2 == 0 && Stage::active(k); }
+};
+
+// apply a stage to even words only, counting words from 1 in output order
+template <class Stage>
+struct EvenWordsStage : Stage {
+	static bool active(size_t k) { return k % 2 == 1 && Stage::active(k); }
+};
+
+// keep words of at least Minimum characters
+template <size_t Minimum>
+struct MinLengthFilter : PipelineStage {
+	static bool keep(const char*, size_t n) { return n >= Minimum; }
+};
+
+// keep words of at most Maximum characters
+template <size_t Maximum>
+struct MaxLengthFilter : PipelineStage {
+	static bool keep(const char*, size_t n) { return n <= Maximum; }
+};
+
+// keep words made of ASCII letters only
+struct AlphabeticFilter : PipelineStage {
+	static bool keep(const char* word, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			char c = word[i];
+			if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+
+/// SEQUENCE LEVEL OPERATORS ///
+
+// words first to last
+struct ForwardOrder {
+	static size_t count(size_t n) { return n; }
+	static size_t position(size_t k, size_t) { return k; }
+};
+
+// words last to first
+struct BackwardOrder {
+	static size_t count(size_t n) { return n; }
+	static size_t position(size_t k, size_t n) { return n - 1 - k; }
+};
+
+// words first, last, second, next-to-last, etc., meeting in the middle
+struct AlternatingOrder {
+	static size_t count(size_t n) { return n; }
+	static size_t position(size_t k, size_t n) { return k % 2 == 0 ? k / 2 : n - 1 - k / 2; }
+};
+
+// every Step-th word, starting at Offset
+template <size_t Step, size_t Offset = 0>
+struct EveryNthOrder {
+	static size_t count(size_t n) { return n > Offset ? (n - Offset + Step - 1) / Step : 0; }
+	static size_t position(size_t k, size_t) { return Offset + k * Step; }
+};
+
+// apply Second to the output of First
+template <class First, class Second>
+struct ThenOrder {
+	static size_t count(size_t n) { return Second::count(First::count(n)); }
+	static size_t position(size_t k, size_t n) { return First::position(Second::position(k, First::count(n)), n); }
+};
+
+
+/// STAGE COMPOSITION ///
+
+// a chain of stages, fused into one source index function, one character map and one filter
+template <class... Stages>
+struct StageChain;
+
+// empty chain, the identity
+template <>
+struct StageChain<> {
+	static bool keep(const char*, size_t) { return true; }
+	static size_t source(size_t i, size_t, size_t) { return i; }
+	static char map(char c, size_t) { return c; }
+};
+
+// First is applied before the rest, so its source index is looked up last and its map applied first
+template <class First, class... Rest>
+struct StageChain<First, Rest...> {
+	static bool keep(const char* word, size_t n) {
+		return First::keep(word, n) && StageChain<Rest...>::keep(word, n);
+	}
+
+	static size_t source(size_t i, size_t n, size_t k) {
+		size_t j = StageChain<Rest...>::source(i, n, k);
+		return First::active(k) ? First::source(j, n) : j;
+	}
+
+	static char map(char c, size_t k) {
+		return StageChain<Rest...>::map(First::active(k) ? First::map(c) : c, k);
+	}
+};
+
+
+/// WORD SOURCES ///
+
+// words of a File, indexed directly for random access containers, through a pointer index for lists
+// the words of an ARRAY file fill its slots from the front, so the orders see only the filled slots
+class FileWordSource {
+public:
+	explicit FileWordSource(const File& file) : m_file(file) {
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+		for (File::const_iterator itr = file.cbegin(); itr != file.cend(); ++itr) {
+			m_words.push_back(&*itr);
+		}
+#elif CONTAINER == ARRAY
+		m_size = static_cast<size_t>(FileFactory::filledEnd(file) - file.cbegin());
+#endif
+	}
+
+	size_t size() const {
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+		return m_words.size();
+#elif CONTAINER == ARRAY
+		return m_size;
+#else
+		return m_file.size();
+#endif
+	}
+
+	WordView view(size_t index) const {
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+		const std::string& word = *m_words[index];
+#else
+		const std::string& word = m_file[index];
+#endif
+		WordView result = { word.data(), word.length() };
+		return result;
+	}
+
+private:
+	const File& m_file;
+#if CONTAINER == LIST || CONTAINER == FORWARD_LIST
+	std::vector<const std::string*> m_words;
+#elif CONTAINER == ARRAY
+	size_t m_size;
+#endif
+}; // end class FileWordSource
+
+// words of an InternedFile
+class InternedWordSource {
+public:
+	explicit InternedWordSource(const InternedFile& file) : m_file(file) {
+	}
+
+	size_t size() const {
+		return m_file.size();
+	}
+
+	WordView view(size_t index) const {
+		const std::string& word = m_file[index];
+		WordView result = { word.data(), word.length() };
+		return result;
+	}
+
+private:
+	const InternedFile& m_file;
+}; // end class InternedWordSource
+
+// words of a PackedFile
+class PackedWordSource {
+public:
+	explicit PackedWordSource(const PackedFile& file) : m_file(file) {
+	}
+
+	size_t size() const {
+		return m_file.size();
+	}
+
+	WordView view(size_t index) const {
+		WordView result = { m_file.data(index), m_file.length(index) };
+		return result;
+	}
+
+private:
+	const PackedFile& m_file;
+}; // end class PackedWordSource
+
+// words of a C-string array
+class CStringWordSource {
+public:
+	CStringWordSource(char** fileArray, size_t size) : m_array(fileArray), m_size(size) {
+	}
+
+	size_t size() const {
+		return m_size;
+	}
+
+	WordView view(size_t index) const {
+		WordView result = { m_array[index], strlen(m_array[index]) };
+		return result;
+	}
+
+private:
+	char** m_array;
+	size_t m_size;
+}; // end class CStringWordSource
+
+
+/// PIPELINE ///
+
+// a sequence level operator followed by word level stages, fused at compile time
+template <class Order, class... Stages>
+class TransformPipeline {
+public:
+	typedef StageChain<Stages...> Chain;
+
+	// print every word produced by the pipeline on its own line, empty words are skipped
+	template <class Source>
+	static void run(const Source& source, std::ostream& stream) {
+		WordEmitter emitter(stream);
+		std::string buffer;
+		size_t n = source.size();
+		size_t count = Order::count(n);
+
+		for (size_t k = 0; k < count; k++) {
+			WordView word = source.view(Order::position(k, n));
+
+			if (word.length == 0 || !Chain::keep(word.data, word.length)) {
+				continue;
+			}
+
+			// one pass over the output characters, reading each from its fused source index
+			buffer.resize(word.length);
+			for (size_t i = 0; i < word.length; i++) {
+				buffer[i] = Chain::map(word.data[Chain::source(i, word.length, k)], k);
+			}
+
+			emitter.addCopy(buffer);
+		}
+	}
+
+	// convenience overloads for each File representation
+	static void run(const File& file, std::ostream& stream) {
+		run(FileWordSource(file), stream);
+	}
+
+	static void run(const InternedFile& file, std::ostream& stream) {
+		run(InternedWordSource(file), stream);
+	}
+
+	static void run(const PackedFile& file, std::ostream& stream) {
+		run(PackedWordSource(file), stream);
+	}
+
+	static void run(char** fileArray, size_t size, std::ostream& stream) {
+		run(CStringWordSource(fileArray, size), stream);
+	}
+}; // end class TransformPipeline
+
+
+/// THE FILEFACTORY MODES AS PIPELINES ///
+
+// FileFactory::printFileConst, FORWARD
+typedef TransformPipeline<ForwardOrder> ForwardPipeline;
+// FileFactory::printFileConst, BACKWARD
+typedef TransformPipeline<BackwardOrder> BackwardPipeline;
+// FileFactory::printOddWordsReverse
+typedef TransformPipeline<ForwardOrder, OddWordsStage<ReverseStage> > OddWordsReversePipeline;
+// FileFactory::printAlternatingWords
+typedef TransformPipeline<AlternatingOrder, AlternateStage> AlternatingWordsPipeline;
+
+#endif
@@ -0,0 +1,149 @@
+/**
+* File:		WordEmitter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a WordEmitter class, that writes words to a stream in batches.
+*/
+
+#include "WordEmitter.hpp"
+#include "WordKernels.hpp"
+#include "Budget.hpp"
+#include <cstring>
+
+// copy a word and its newline, return the position after them
+static inline char* copyWord(char* output, const char* word, size_t length) {
+	memcpy(output, word, length);
+	output[length] = '\n';
+	return output + length + 1;
+}
+
+// output buffer allocated once
+WordEmitter::WordEmitter(std::ostream& stream, const PatternFilter* filter) :
+	m_stream(stream), m_filter(filter != nullptr && filter->active() ? filter : nullptr), m_count(0), m_pending(0), m_buffer(BUFFER_SIZE), m_used(0) {
+
+}
+
+// write out anything left
+WordEmitter::~WordEmitter() {
+	flush();
+}
+
+// queue a word, emitting the batch first if it is full or the buffer could not hold the word
+void WordEmitter::add(const char* word, size_t length) {
+	if (length == 0) {
+		// nothing is printed for an empty word, but it still goes through the batch like any other
+		if (m_count == BATCH_SIZE) {
+			Budget::checkpoint();
+			emitBatch();
+		}
+		m_words[m_count] = word;
+		m_lengths[m_count] = 0;
+		m_count++;
+		return;
+	}
+
+	// words that cannot share the buffer are written directly
+	if (length + 1 > BUFFER_SIZE) {
+		if (m_filter != nullptr && !m_filter->matches(word, length)) {
+			return;
+		}
+		flush();
+		m_stream.write(word, length).put('\n');
+		return;
+	}
+
+	// the budget is checked once a batch, not in flush, which the destructor calls
+	if (m_count == BATCH_SIZE || m_pending + length + 1 > BUFFER_SIZE) {
+		Budget::checkpoint();
+		emitBatch();
+	}
+
+	m_words[m_count] = word;
+	m_lengths[m_count] = static_cast<std::uint32_t>(length);
+	m_count++;
+	m_pending += length + 1;
+}
+
+// queue a std::string
+void WordEmitter::add(const std::string& word) {
+	add(word.data(), word.length());
+}
+
+// queue a C-string, an empty string is seen without scanning it
+void WordEmitter::add(const char* word) {
+	add(word, word[0] == '\0' ? 0 : strlen(word));
+}
+
+// emit the queued words first to keep the order, then copy the word
+void WordEmitter::addCopy(const char* word, size_t length) {
+	if (length == 0) {
+		return;
+	}
+
+	emitBatch();
+
+	if (length + 1 > BUFFER_SIZE) {
+		flush();
+		m_stream.write(word, length).put('\n');
+		return;
+	}
+
+	// copied words are checked once a buffer
+	if (m_used + length + 1 > m_buffer.size()) {
+		Budget::checkpoint();
+	}
+	reserve(length + 1);
+	copyWord(&m_buffer[m_used], word, length);
+	m_used += length + 1;
+}
+
+// copy a std::string
+void WordEmitter::addCopy(const std::string& word) {
+	addCopy(word.data(), word.length());
+}
+
+// emit the batch and write the buffer
+void WordEmitter::flush() {
+	emitBatch();
+
+	if (m_used > 0) {
+		m_stream.write(m_buffer.data(), m_used);
+		m_used = 0;
+	}
+}
+
+// the kernel of the widest instruction set available skips empty words a vector of lengths at a time
+size_t WordEmitter::emit(const char* const* words, const std::uint32_t* lengths, size_t count, char* output) {
+	return WordKernels::select().emitWords(words, lengths, count, output);
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// emit the queued words into the buffer
+void WordEmitter::emitBatch() {
+	if (m_count == 0) {
+		return;
+	}
+
+	// rejected words get a length of zero, which emit skips, so the pending bytes are still enough room
+	if (m_filter != nullptr && m_pending > 0) {
+		m_filter->select(m_words, m_lengths, m_count);
+	}
+
+	if (m_pending > 0) {
+		reserve(m_pending);
+		m_used += emit(m_words, m_lengths, m_count, &m_buffer[m_used]);
+	}
+
+	m_count = 0;
+	m_pending = 0;
+}
+
+// write the buffer to the stream if the bytes do not fit behind what is already there
+void WordEmitter::reserve(size_t bytes) {
+	if (m_used + bytes > m_buffer.size()) {
+		m_stream.write(m_buffer.data(), m_used);
+		m_used = 0;
+	}
+}
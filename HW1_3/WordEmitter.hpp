@@ -0,0 +1,78 @@
+/**
+* File:		WordEmitter.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a WordEmitter class, the output backend of every print mode.
+*			Words are queued as pointer and length pairs and written out a batch at a time: empty words (most of
+*			the ARRAY backend's slots) are skipped a vector of lengths per SIMD compare, and the rest are copied, each
+*			followed by a newline, into one output buffer that is handed to the stream with a single write.
+*
+*			An emitter given an active PatternFilter runs it over each batch before the copy, so rejected words
+*			cost no output work. Words added with addCopy are not filtered, their caller tests them.
+*
+*			The current Budget is checked once a batch (once a buffer for copied words), so every print mode
+*			stops soon after its job is cancelled or out of time. Flushing never checks, the destructor flushes.
+*/
+
+#ifndef WORD_EMITTER_HPP
+#define WORD_EMITTER_HPP
+
+// includes
+#include "PatternFilter.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class WordEmitter {
+public:
+	// number of words queued before a batch is emitted
+	static const size_t BATCH_SIZE = 256;
+	// size of the output buffer, written to the stream when full
+	static const size_t BUFFER_SIZE = 64 * 1024;
+
+	// constructor/destructor, the destructor flushes, only words matching filter are written
+	explicit WordEmitter(std::ostream& stream, const PatternFilter* filter = nullptr);
+	virtual ~WordEmitter();
+
+	// queue a word, its characters must stay valid until the next flush
+	void add(const char* word, size_t length);
+	void add(const std::string& word);
+	void add(const char* word);
+
+	// copy a word to the output now, for words held in temporaries
+	void addCopy(const char* word, size_t length);
+	void addCopy(const std::string& word);
+
+	// emit the queued words and write the output buffer to the stream
+	void flush();
+
+	// write each non-empty word of the run followed by a newline to output, return the number of bytes written
+	// output must have room for the sum of the lengths plus one byte per word
+	static size_t emit(const char* const* words, const std::uint32_t* lengths, size_t count, char* output);
+
+private:
+	// emit the queued words into the output buffer
+	void emitBatch();
+	// make room for bytes in the output buffer
+	void reserve(size_t bytes);
+
+	std::ostream& m_stream;
+	// null unless the filter is active
+	const PatternFilter* m_filter;
+
+	// queued words
+	const char* m_words[BATCH_SIZE];
+	std::uint32_t m_lengths[BATCH_SIZE];
+	size_t m_count;
+	// bytes the queued words will take in the output
+	size_t m_pending;
+
+	// output buffer
+	std::vector<char> m_buffer;
+	size_t m_used;
+}; // end class WordEmitter
+
+#endif
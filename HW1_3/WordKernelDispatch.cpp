@@ -0,0 +1,86 @@
+/**
+* File:		WordKernelDispatch.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file chooses the WordKernels table at run time. The baseline table is always built, the AVX2 and
+*			AVX-512 tables are built when FILEFACTORY_HAVE_AVX2 and FILEFACTORY_HAVE_AVX512 are defined, and are
+*			only chosen on a processor that supports them.
+*/
+
+#include "WordKernels.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// the tables, one per compiled copy of WordKernels.cpp
+extern const WordKernels baselineKernels;
+#ifdef FILEFACTORY_HAVE_AVX2
+extern const WordKernels avx2Kernels;
+#endif
+#ifdef FILEFACTORY_HAVE_AVX512
+extern const WordKernels avx512Kernels;
+#endif
+
+// true if the processor runs the named table
+static bool supported(const char* name) {
+	if (strcmp(name, "baseline") == 0) {
+		return true;
+	}
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (strcmp(name, "avx2") == 0) {
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+	}
+	if (strcmp(name, "avx512") == 0) {
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt");
+	}
+#endif
+	return false;
+}
+
+// widest table, unless the environment asks for another
+static const WordKernels& choose() {
+	const char* requested = std::getenv("FILEFACTORY_ISA");
+	if (requested != NULL) {
+		const WordKernels* kernels = WordKernels::find(requested);
+		if (kernels != NULL) {
+			return *kernels;
+		}
+	}
+
+	const char* preference[] = { "avx512", "avx2" };
+	for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+		const WordKernels* kernels = WordKernels::find(preference[i]);
+		if (kernels != NULL) {
+			return *kernels;
+		}
+	}
+
+	return baselineKernels;
+}
+
+// chosen once, the first time it is needed
+const WordKernels& WordKernels::select() {
+	static const WordKernels& kernels = choose();
+	return kernels;
+}
+
+// look the table up among the ones built
+const WordKernels* WordKernels::find(const char* name) {
+	const WordKernels* tables[] = {
+		&baselineKernels,
+#ifdef FILEFACTORY_HAVE_AVX2
+		&avx2Kernels,
+#endif
+#ifdef FILEFACTORY_HAVE_AVX512
+		&avx512Kernels,
+#endif
+	};
+
+	for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+		if (strcmp(tables[i]->name, name) == 0) {
+			return supported(name) ? tables[i] : NULL;
+		}
+	}
+
+	return NULL;
+}
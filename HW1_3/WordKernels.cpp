@@ -0,0 +1,293 @@
+/**
+* File:		WordKernels.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation of one WordKernels table. It is compiled once per instruction set, the
+*			compiler's own macros (__AVX512BW__, __AVX2__, __SSE2__) choose the vector width, and the build names
+*			the table with WORD_KERNELS_TABLE and WORD_KERNELS_NAME. Without them this is the baseline table.
+*			Everything but the table has internal linkage, so the copies never clash.
+*/
+
+#include "WordKernels.hpp"
+#include <cstring>
+
+#if defined(__AVX512BW__) || defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifndef WORD_KERNELS_TABLE
+#define WORD_KERNELS_TABLE baselineKernels
+#define WORD_KERNELS_NAME "baseline"
+#endif
+
+namespace {
+
+	// one bit per character or word of a vector
+	typedef std::uint64_t Mask;
+
+	// same classification as WordTokenizer::isDelimiter, repeated so no inline function of the program is built here
+	inline bool isDelimiter(char c) {
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+
+	// index of the lowest set bit of a non-zero mask
+	inline unsigned lowestBit(Mask mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return static_cast<unsigned>(index);
+#else
+		return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+	}
+
+	// number of set bits
+	inline unsigned bitCount(Mask mask) {
+#ifdef _MSC_VER
+		mask = mask - ((mask >> 1) & 0x5555555555555555ull);
+		mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+		mask = (mask + (mask >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return static_cast<unsigned>((mask * 0x0101010101010101ull) >> 56);
+#else
+		return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+	}
+
+	// copy a word and its newline, return the position after them
+	inline char* copyWord(char* output, const char* word, size_t length) {
+		memcpy(output, word, length);
+		output[length] = '\n';
+		return output + length + 1;
+	}
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+	// delimiters among 16 characters, delimiters are ' ' and '\t' to '\r', the second range is one unsigned
+	// compare after subtracting '\t'
+	inline Mask delimiterMask16(const char* data) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		__m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+		__m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+		__m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, space)));
+	}
+
+#endif
+
+#if defined(__AVX512BW__)
+
+	// 64 characters or words per vector
+	const size_t WIDTH = 64;
+	const Mask FULL = ~static_cast<Mask>(0);
+
+	// delimiters are ' ' and '\t' to '\r', the second range is one unsigned compare after subtracting '\t'
+	inline Mask delimiterMask(const char* data) {
+		__m512i bytes = _mm512_loadu_si512(data);
+		__m512i shifted = _mm512_sub_epi8(bytes, _mm512_set1_epi8('\t'));
+		return _mm512_cmple_epu8_mask(shifted, _mm512_set1_epi8(4)) | _mm512_cmpeq_epi8_mask(bytes, _mm512_set1_epi8(' '));
+	}
+
+	// one bit per non-empty word
+	inline Mask nonEmptyMask(const std::uint32_t* lengths) {
+		Mask mask = 0;
+		for (unsigned part = 0; part < 4; part++) {
+			__m512i block = _mm512_loadu_si512(lengths + part * 16);
+			mask |= static_cast<Mask>(_mm512_test_epi32_mask(block, block)) << (part * 16);
+		}
+		return mask;
+	}
+
+#elif defined(__AVX2__)
+
+	// 32 characters or words per vector
+	const size_t WIDTH = 32;
+	const Mask FULL = 0xffffffffull;
+
+	// delimiters are ' ' and '\t' to '\r', the second range is one unsigned compare after subtracting '\t'
+	inline Mask delimiterMask(const char* data) {
+		__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		__m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+		__m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+		__m256i space = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+		return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, space)));
+	}
+
+	// one bit per non-empty word
+	inline Mask nonEmptyMask(const std::uint32_t* lengths) {
+		const __m256i zero = _mm256_setzero_si256();
+		Mask empty = 0;
+		for (unsigned part = 0; part < 4; part++) {
+			__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lengths + part * 8));
+			__m256 equal = _mm256_castsi256_ps(_mm256_cmpeq_epi32(block, zero));
+			empty |= static_cast<Mask>(_mm256_movemask_ps(equal)) << (part * 8);
+		}
+		return ~empty & FULL;
+	}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+	// 16 characters or words per vector
+	const size_t WIDTH = 16;
+	const Mask FULL = 0xffffull;
+
+	inline Mask delimiterMask(const char* data) {
+		return delimiterMask16(data);
+	}
+
+	// one bit per non-empty word, sixteen lengths narrowed to bytes by saturating packs that keep non-zero non-zero
+	inline Mask nonEmptyMask(const std::uint32_t* lengths) {
+		const __m128i* block = reinterpret_cast<const __m128i*>(lengths);
+		__m128i low = _mm_packs_epi32(_mm_loadu_si128(block), _mm_loadu_si128(block + 1));
+		__m128i high = _mm_packs_epi32(_mm_loadu_si128(block + 2), _mm_loadu_si128(block + 3));
+		__m128i bytes = _mm_packs_epi16(low, high);
+		return ~static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()))) & FULL;
+	}
+
+#else
+
+	// no vector unit, one character or word at a time
+	const size_t WIDTH = 1;
+	const Mask FULL = 1;
+
+	inline Mask delimiterMask(const char* data) {
+		return isDelimiter(*data) ? 1 : 0;
+	}
+
+	inline Mask nonEmptyMask(const std::uint32_t* lengths) {
+		return *lengths != 0 ? 1 : 0;
+	}
+
+#endif
+
+	// a word starts at a non-delimiter whose previous character is a delimiter
+	// the previous character's bit of each vector comes from shifting its mask, the first one is carried in
+	std::uint64_t countWordStarts(const char* data, size_t length, bool inWord) {
+		std::uint64_t count = 0;
+		Mask carry = inWord ? 0 : 1;
+		size_t i = 0;
+
+		for (; i + WIDTH <= length; i += WIDTH) {
+			Mask delimiters = delimiterMask(data + i);
+			Mask previous = ((delimiters << 1) | carry) & FULL;
+			count += bitCount(~delimiters & previous & FULL);
+			carry = (delimiters >> (WIDTH - 1)) & 1;
+		}
+
+		bool previousDelimiter = carry != 0;
+		for (; i < length; i++) {
+			bool delimiter = isDelimiter(data[i]);
+			if (!delimiter && previousDelimiter) {
+				count++;
+			}
+			previousDelimiter = delimiter;
+		}
+
+		return count;
+	}
+
+	// first delimiter
+	// most words are shorter than 16 characters, so the wider sets look at the first 16 before going wide
+	const char* findDelimiter(const char* begin, const char* end) {
+#if defined(__AVX2__) || defined(__AVX512BW__)
+		if (end - begin >= 16) {
+			Mask delimiters = delimiterMask16(begin);
+			if (delimiters != 0) {
+				return begin + lowestBit(delimiters);
+			}
+			begin += 16;
+		}
+#endif
+
+		while (static_cast<size_t>(end - begin) >= WIDTH) {
+			Mask delimiters = delimiterMask(begin);
+			if (delimiters != 0) {
+				return begin + lowestBit(delimiters);
+			}
+			begin += WIDTH;
+		}
+
+		while (begin != end && !isDelimiter(*begin)) {
+			++begin;
+		}
+		return begin;
+	}
+
+	// first non-delimiter, delimiters come one at a time in most text, so the wider sets start narrow here too
+	const char* skipDelimiters(const char* begin, const char* end) {
+#if defined(__AVX2__) || defined(__AVX512BW__)
+		if (end - begin >= 16) {
+			Mask others = ~delimiterMask16(begin) & 0xffff;
+			if (others != 0) {
+				return begin + lowestBit(others);
+			}
+			begin += 16;
+		}
+#endif
+
+		while (static_cast<size_t>(end - begin) >= WIDTH) {
+			Mask others = ~delimiterMask(begin) & FULL;
+			if (others != 0) {
+				return begin + lowestBit(others);
+			}
+			begin += WIDTH;
+		}
+
+		while (begin != end && isDelimiter(*begin)) {
+			++begin;
+		}
+		return begin;
+	}
+
+	// a vector of lengths is compared with zero at once, a run of empty words costs one compare
+	size_t emitWords(const char* const* words, const std::uint32_t* lengths, size_t count, char* output) {
+		char* position = output;
+		size_t i = 0;
+
+		for (; i + WIDTH <= count; i += WIDTH) {
+			Mask mask = nonEmptyMask(lengths + i);
+
+			while (mask != 0) {
+				unsigned k = lowestBit(mask);
+				position = copyWord(position, words[i + k], lengths[i + k]);
+				mask &= mask - 1;
+			}
+		}
+
+		for (; i < count; i++) {
+			if (lengths[i] != 0) {
+				position = copyWord(position, words[i], lengths[i]);
+			}
+		}
+
+		return static_cast<size_t>(position - output);
+	}
+
+	// the AVX2 and AVX-512 sets include SSSE3 and its byte shuffle, the baseline permutes a byte at a time
+	void shuffleSlot(const char* slot, const unsigned char* mask, char* output) {
+#if defined(__SSSE3__)
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slot));
+		__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(bytes, shuffle));
+#else
+		for (size_t i = 0; i < 16; i++) {
+			output[i] = (mask[i] & 0x80) ? '\0' : slot[mask[i] & 0x0f];
+		}
+#endif
+	}
+
+} // end anonymous namespace
+
+// the table of this instruction set
+extern const WordKernels WORD_KERNELS_TABLE;
+const WordKernels WORD_KERNELS_TABLE = {
+	WORD_KERNELS_NAME,
+	&countWordStarts,
+	&findDelimiter,
+	&skipDelimiters,
+	&emitWords,
+	&shuffleSlot
+};
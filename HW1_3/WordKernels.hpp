@@ -0,0 +1,47 @@
+/**
+* File:		WordKernels.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file defines the WordKernels table, the character and word loops that are worth vectorizing.
+*			WordKernels.cpp is compiled once per instruction set (baseline SSE2, AVX2 and AVX-512 when the build
+*			enables them), each copy filling in its own table, and select() picks the best table the processor
+*			supports the first time it is called. WordKernels.cpp must only include headers without inline
+*			functions of the program's own, so no code built for a wider instruction set can be shared with the
+*			baseline code.
+*/
+
+#ifndef WORD_KERNELS_HPP
+#define WORD_KERNELS_HPP
+
+// includes
+#include <cstdint>
+#include <cstddef>
+
+// table of the kernels of one instruction set
+struct WordKernels {
+	// name of the instruction set, "baseline", "avx2" or "avx512"
+	const char* name;
+
+	// number of words starting in the characters, inWord is true if the character before them is part of a word
+	std::uint64_t (*countWordStarts)(const char* data, size_t length, bool inWord);
+
+	// first delimiter in [begin, end), end if there is none
+	const char* (*findDelimiter)(const char* begin, const char* end);
+	// first character in [begin, end) that is not a delimiter, end if there is none
+	const char* (*skipDelimiters)(const char* begin, const char* end);
+
+	// write each non-empty word of the run followed by a newline to output, return the number of bytes written
+	size_t (*emitWords)(const char* const* words, const std::uint32_t* lengths, size_t count, char* output);
+
+	// permute the 16 bytes of a PackedFile slot into output, output byte i is slot[mask[i]], or zero where mask[i]
+	// has its high bit set, one byte shuffle where the instruction set has one
+	void (*shuffleSlot)(const char* slot, const unsigned char* mask, char* output);
+
+	// kernels for the widest instruction set this build and processor support, chosen on first use
+	// the FILEFACTORY_ISA environment variable ("baseline", "avx2" or "avx512") selects a narrower set
+	static const WordKernels& select();
+	// kernels of the named instruction set, null if the build does not have them or the processor lacks them
+	static const WordKernels* find(const char* name);
+};
+
+#endif
@@ -0,0 +1,308 @@
+/**
+* File:		WordSorter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a WordSorter class, that sorts words by sample sort over keys with
+*			cached prefixes, each bucket by MSD radix sort on the prefix bytes.
+*/
+
+// includes
+#include "WordSorter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// buckets per thread, more buckets than threads balance the load when the splitters are uneven
+static const size_t BUCKETS_PER_THREAD = 8;
+// sample keys per bucket, the splitters are every this many sorted samples
+static const size_t OVERSAMPLING = 32;
+// ranges this small are sorted by comparison, a radix pass costs more than it saves
+static const size_t RADIX_CUTOFF = 64;
+
+// definition of the class constant, std::min takes it by reference
+const unsigned WordSorter::MAX_THREADS;
+
+// comparisons as function objects, so std::sort inlines them
+struct LexicographicOrder {
+	bool operator()(const WordSorter::Key& a, const WordSorter::Key& b) const {
+		return WordSorter::lessLexicographic(a, b);
+	}
+};
+
+// constructor
+WordSorter::WordSorter() {
+	// empty
+}
+
+// destructor
+WordSorter::~WordSorter() {
+	// empty
+}
+
+// key for a word, the first eight bytes big-endian so integer order is byte order, padded with zeros
+WordSorter::Key WordSorter::key(const char* data, size_t length) {
+	std::uint64_t prefix = 0;
+	size_t count = std::min<size_t>(length, 8);
+	for (size_t i = 0; i < count; i++) {
+		prefix |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (56 - 8 * i);
+	}
+
+	Key result = { prefix, data, length };
+	return result;
+}
+
+// bytes as unsigned, a word before the longer words it begins
+// equal prefixes mean the first min(length, 8) bytes are equal, since the padding of the shorter word is zeros
+// that the longer one must match, so only the bytes past the prefix and the lengths are left to compare
+bool WordSorter::lessLexicographic(const Key& a, const Key& b) {
+	if (a.prefix != b.prefix) {
+		return a.prefix < b.prefix;
+	}
+
+	size_t common = std::min(a.length, b.length);
+	if (common > 8) {
+		int order = std::memcmp(a.data + 8, b.data + 8, common - 8);
+		if (order != 0) {
+			return order < 0;
+		}
+	}
+	return a.length < b.length;
+}
+
+// shortest first, then bytes as unsigned
+bool WordSorter::lessLength(const Key& a, const Key& b) {
+	if (a.length != b.length) {
+		return a.length < b.length;
+	}
+	return lessLexicographic(a, b);
+}
+
+// the same word
+bool WordSorter::equal(const Key& a, const Key& b) {
+	return a.prefix == b.prefix && a.length == b.length
+		&& (a.length <= 8 || std::memcmp(a.data + 8, b.data + 8, a.length - 8) == 0);
+}
+
+// sort the keys
+void WordSorter::sort(std::vector<Key>& keys, Order order, bool unique, unsigned threads) {
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+
+	threads = std::min(threads, MAX_THREADS);
+
+	if (threads == 1 || keys.size() < PARALLEL_THRESHOLD) {
+		keys.resize(sortRange(keys.data(), keys.data() + keys.size(), order, unique));
+		return;
+	}
+
+	sampleSort(keys, order, unique, threads);
+}
+
+
+/// PRIVATE FUNCTIONS AREA ///
+
+// sort and deduplicate a range
+size_t WordSorter::sortRange(Key* first, Key* last, Order order, bool unique) {
+	radixSort(first, last, 0);
+	if (order == LENGTH) {
+		sortByLength(first, last);
+	}
+
+	if (unique) {
+		last = std::unique(first, last, equal);
+	}
+	return static_cast<size_t>(last - first);
+}
+
+// MSD radix sort on the prefix bytes, in place (American flag sort), byte depth of the prefix first
+// words whose prefixes are all equal are left to the comparison, which looks past the prefix
+void WordSorter::radixSort(Key* first, Key* last, size_t depth) {
+	size_t count = static_cast<size_t>(last - first);
+	if (count < RADIX_CUTOFF || depth == 8) {
+		compareSort(first, last);
+		return;
+	}
+
+	unsigned shift = static_cast<unsigned>(56 - 8 * depth);
+	size_t counts[256] = { 0 };
+	for (Key* itr = first; itr != last; ++itr) {
+		counts[(itr->prefix >> shift) & 0xff]++;
+	}
+
+	// one bucket holds them all, a shared prefix, go on to the next byte
+	if (counts[(first->prefix >> shift) & 0xff] == count) {
+		// unless every word has ended, then only their lengths can differ, and repeated words are all one length
+		bool ended = ((first->prefix >> shift) & 0xff) == 0;
+		for (Key* itr = first; ended && itr != last; ++itr) {
+			ended = itr->length <= depth;
+		}
+
+		if (ended) {
+			compareSort(first, last);
+		}
+		else {
+			radixSort(first, last, depth + 1);
+		}
+		return;
+	}
+
+	size_t next[256];
+	size_t end[256];
+	size_t position = 0;
+	for (size_t b = 0; b < 256; b++) {
+		next[b] = position;
+		position += counts[b];
+		end[b] = position;
+	}
+
+	// swap each key into its bucket, each swap places one key for good
+	for (size_t b = 0; b < 256; b++) {
+		while (next[b] < end[b]) {
+			Key key = first[next[b]];
+			size_t target = (key.prefix >> shift) & 0xff;
+			while (target != b) {
+				std::swap(key, first[next[target]++]);
+				target = (key.prefix >> shift) & 0xff;
+			}
+			first[next[b]++] = key;
+		}
+	}
+
+	for (size_t b = 0, start = 0; b < 256; start += counts[b], b++) {
+		if (counts[b] > 1) {
+			radixSort(first + start, first + start + counts[b], depth + 1);
+		}
+	}
+}
+
+// sort by comparison, a range of one repeated word is already sorted
+void WordSorter::compareSort(Key* first, Key* last) {
+	if (std::adjacent_find(first, last, [](const Key& a, const Key& b) { return !equal(a, b); }) != last) {
+		std::sort(first, last, LexicographicOrder());
+	}
+}
+
+// stable counting sort by length, words of a length keep the byte order they were sorted in
+void WordSorter::sortByLength(Key* first, Key* last) {
+	size_t longest = 0;
+	for (Key* itr = first; itr != last; ++itr) {
+		longest = std::max(longest, itr->length);
+	}
+
+	std::vector<size_t> position(longest + 1, 0);
+	for (Key* itr = first; itr != last; ++itr) {
+		position[itr->length]++;
+	}
+	size_t offset = 0;
+	for (size_t& length : position) {
+		size_t words = length;
+		length = offset;
+		offset += words;
+	}
+
+	std::vector<Key> sorted(static_cast<size_t>(last - first));
+	for (Key* itr = first; itr != last; ++itr) {
+		sorted[position[itr->length]++] = *itr;
+	}
+	std::copy(sorted.cbegin(), sorted.cend(), first);
+}
+
+// sample sort, equal words always land in the same bucket, so each bucket is deduplicated on its own
+void WordSorter::sampleSort(std::vector<Key>& keys, Order order, bool unique, unsigned threads) {
+	bool (*less)(const Key&, const Key&) = order == LENGTH ? lessLength : lessLexicographic;
+	size_t count = keys.size();
+	size_t buckets = threads * BUCKETS_PER_THREAD;
+
+	// evenly spaced samples, sorted, give the splitters between the buckets
+	std::vector<Key> samples;
+	size_t sampleCount = buckets * OVERSAMPLING;
+	for (size_t i = 0; i < sampleCount; i++) {
+		samples.push_back(keys[i * (count / sampleCount)]);
+	}
+	std::sort(samples.begin(), samples.end(), less);
+
+	std::vector<Key> splitters;
+	for (size_t b = 1; b < buckets; b++) {
+		splitters.push_back(samples[b * OVERSAMPLING]);
+	}
+
+	// each thread classifies a slice of the keys and counts its keys per bucket
+	std::vector<std::uint16_t> bucketOf(count);
+	std::vector<size_t> counts(threads * buckets, 0);
+	size_t slice = (count + threads - 1) / threads;
+
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&, t]() {
+			size_t end = std::min(count, (t + 1) * slice);
+			for (size_t i = t * slice; i < end; i++) {
+				size_t bucket = std::upper_bound(splitters.cbegin(), splitters.cend(), keys[i], less) - splitters.cbegin();
+				bucketOf[i] = static_cast<std::uint16_t>(bucket);
+				counts[t * buckets + bucket]++;
+			}
+		}));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	// bucket by bucket, then slice by slice, the position each thread writes its first key of a bucket
+	std::vector<size_t> offsets(threads * buckets);
+	std::vector<size_t> bucketStart(buckets + 1);
+	size_t position = 0;
+	for (size_t b = 0; b < buckets; b++) {
+		bucketStart[b] = position;
+		for (unsigned t = 0; t < threads; t++) {
+			offsets[t * buckets + b] = position;
+			position += counts[t * buckets + b];
+		}
+	}
+	bucketStart[buckets] = position;
+
+	// distribute, then sort the buckets, threads take the next unsorted bucket
+	std::vector<Key> sorted(count);
+	std::vector<size_t> kept(buckets);
+	std::atomic<size_t> next(0);
+
+	for (unsigned t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&, t]() {
+			size_t* offset = &offsets[t * buckets];
+			size_t end = std::min(count, (t + 1) * slice);
+			for (size_t i = t * slice; i < end; i++) {
+				sorted[offset[bucketOf[i]]++] = keys[i];
+			}
+		}));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	for (unsigned t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&]() {
+			for (size_t b = next++; b < buckets; b = next++) {
+				kept[b] = sortRange(sorted.data() + bucketStart[b], sorted.data() + bucketStart[b + 1], order, unique);
+			}
+		}));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// close the gaps left by the duplicates
+	size_t used = 0;
+	for (size_t b = 0; b < buckets; b++) {
+		if (used != bucketStart[b]) {
+			std::copy(sorted.begin() + bucketStart[b], sorted.begin() + bucketStart[b] + kept[b], sorted.begin() + used);
+		}
+		used += kept[b];
+	}
+	sorted.resize(used);
+	keys.swap(sorted);
+}
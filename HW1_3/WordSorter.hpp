@@ -0,0 +1,71 @@
+/**
+* File:		WordSorter.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a WordSorter class, that sorts words in place of piping the
+*			report through sort(1). Words are sorted as keys that point at their characters, with the first eight
+*			bytes cached big-endian in an integer, so most comparisons are one integer compare and never touch the
+*			characters. Keys are MSD radix sorted on the prefix bytes, and only keys with equal prefixes, or too few
+*			to be worth a radix pass, are compared. Large inputs are sample sorted first: a sorted sample picks
+*			splitters, the keys are distributed into buckets between them, and the buckets are radix sorted and
+*			deduplicated on all threads at once. Shortest first order is a stable counting sort by length after.
+*/
+
+#ifndef WORD_SORTER_HPP
+#define WORD_SORTER_HPP
+
+// includes
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// class definition
+class WordSorter {
+public:
+	// sort order, bytes compared as unsigned (the C locale), or shortest first with ties compared as bytes
+	enum Order {
+		LEXICOGRAPHIC, LENGTH
+	};
+
+	// a word to sort, its characters are not copied and must outlive the key
+	struct Key {
+		std::uint64_t prefix;
+		const char* data;
+		size_t length;
+	};
+
+	// fewest keys sorted on more than one thread
+	static const size_t PARALLEL_THRESHOLD = 1 << 16;
+	// most threads used, which keeps the sample within the fewest keys sorted in parallel
+	static const unsigned MAX_THREADS = 256;
+
+	// constructor/destructor
+	WordSorter();
+	virtual ~WordSorter();
+
+	// key for a word
+	static Key key(const char* data, size_t length);
+
+	// sort the keys, keeping one of each word if unique, threads is 0 for all cores
+	static void sort(std::vector<Key>& keys, Order order, bool unique, unsigned threads = 0);
+
+	// true if a sorts before b
+	static bool lessLexicographic(const Key& a, const Key& b);
+	static bool lessLength(const Key& a, const Key& b);
+	// true if a and b are the same word
+	static bool equal(const Key& a, const Key& b);
+
+private:
+	// sort and deduplicate on one thread, return the number of keys kept
+	static size_t sortRange(Key* first, Key* last, Order order, bool unique);
+	// radix sort by the prefix bytes from depth on, then by comparison
+	static void radixSort(Key* first, Key* last, size_t depth);
+	// sort by comparison
+	static void compareSort(Key* first, Key* last);
+	// stable sort by length
+	static void sortByLength(Key* first, Key* last);
+	// sample sort on threads threads
+	static void sampleSort(std::vector<Key>& keys, Order order, bool unique, unsigned threads);
+}; // end class WordSorter
+
+#endif
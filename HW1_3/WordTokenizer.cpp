@@ -0,0 +1,19 @@
+/**
+* File:		WordTokenizer.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation for a WordTokenizer class, that splits raw blocks of characters into
+*			whitespace delimited words. The tokenizing functions are templates and live in the header.
+*/
+
+#include "WordTokenizer.hpp"
+
+// kernels are looked up once per tokenizer, not once per word
+WordTokenizer::WordTokenizer() : m_kernels(WordKernels::select()) {
+
+}
+
+// empty
+WordTokenizer::~WordTokenizer() {
+
+}
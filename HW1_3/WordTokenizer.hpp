@@ -0,0 +1,128 @@
+/**
+* File:		WordTokenizer.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the header definition for a WordTokenizer class, that splits raw blocks of characters into
+*			words using the same whitespace rules as operator>>. A word that straddles two blocks is carried over
+*			to the next call, so input can be tokenized as it arrives, without assembling it in one buffer first.
+*/
+
+#ifndef WORD_TOKENIZER_HPP
+#define WORD_TOKENIZER_HPP
+
+// includes
+#include "WordKernels.hpp"
+#include <string>
+#include <cstddef>
+
+// class definition
+class WordTokenizer {
+public:
+	// constructor/destructor
+	WordTokenizer();
+	virtual ~WordTokenizer();
+
+	// tokenize a block of characters, calling sink(const std::string&) for each complete word
+	// the last word of the block is held back until the next block or finish(), since it may continue
+	template <class Sink>
+	void feed(const char* data, size_t length, Sink& sink);
+
+	// tokenize as feed does, also calling newline() for each newline, after the words before it
+	template <class Sink, class Newline>
+	void feed(const char* data, size_t length, Sink& sink, Newline& newline);
+
+	// flush the word carried over from the last block, if any
+	template <class Sink>
+	void finish(Sink& sink);
+
+	// true if the character separates words (space, tab, newline, vertical tab, form feed, carriage return)
+	static bool isDelimiter(char c);
+
+private:
+	// newline callback of the plain feed, does nothing
+	struct IgnoreNewlines {
+		void operator()() const {
+		}
+	};
+
+	// word carried over from the previous block
+	std::string m_partial;
+	// delimiter searches for the widest instruction set available
+	const WordKernels& m_kernels;
+}; // end class WordTokenizer
+
+// whitespace as classified by the classic locale, which is what operator>> uses by default
+inline bool WordTokenizer::isDelimiter(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// tokenize a block, words are delimited by whitespace
+template <class Sink>
+void WordTokenizer::feed(const char* data, size_t length, Sink& sink) {
+	IgnoreNewlines newline;
+	feed(data, length, sink, newline);
+}
+
+// tokenize a block, every delimiter is passed over by exactly one skip, which is where newlines are counted
+template <class Sink, class Newline>
+void WordTokenizer::feed(const char* data, size_t length, Sink& sink, Newline& newline) {
+	const char* end = data + length;
+	const char* itr = data;
+
+	// finish the word carried over from the previous block
+	if (!m_partial.empty()) {
+		const char* stop = m_kernels.findDelimiter(itr, end);
+
+		m_partial.append(itr, stop);
+		itr = stop;
+
+		// the block ended inside the word, keep carrying it
+		if (itr == end) {
+			return;
+		}
+
+		sink(m_partial);
+		m_partial.clear();
+	}
+
+	std::string word;
+
+	while (itr != end) {
+		// skip delimiters, the runs are short, so the newlines are found with a plain scan
+		const char* skipped = itr;
+		itr = m_kernels.skipDelimiters(itr, end);
+		for (; skipped != itr; ++skipped) {
+			if (*skipped == '\n') {
+				newline();
+			}
+		}
+
+		if (itr == end) {
+			break;
+		}
+
+		// find the end of the word
+		const char* start = itr;
+		itr = m_kernels.findDelimiter(itr, end);
+
+		// a word running into the end of the block may continue in the next one
+		if (itr == end) {
+			m_partial.assign(start, itr);
+			break;
+		}
+
+		word.assign(start, itr);
+		sink(word);
+	}
+}
+
+// flush the carried over word
+template <class Sink>
+void WordTokenizer::finish(Sink& sink) {
+	if (!m_partial.empty()) {
+		sink(m_partial);
+		m_partial.clear();
+	}
+}
+
+#endif
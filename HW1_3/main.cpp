@@ -3,72 +3,657 @@
 * Author:	Ryan Johnson
 * Email:	johnsonrw82@cs.fullerton.edu
 * Purpose:	This file contains the main entry point for the FileFactory program for HW1. All printing operations
-*			are initiated from here.
+*			are initiated from here. Input is read from std::cin, or from a (possibly compressed) file named on the
+*			command line.
 */
 
 
 // includes
 #include "FileFactory.hpp"
+#include "FileReport.hpp"
+#include "CompressedWriter.hpp"
+#include "PagedReader.hpp"
+#include "ReverseReader.hpp"
+#include "FileServer.hpp"
+#include "PerfCounters.hpp"
+#include "LayoutPlanner.hpp"
+#include "PageAllocator.hpp"
+#include "SectionRouter.hpp"
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <limits>
+#include <stdexcept>
+
+// the running server, stopped by SIGINT and SIGTERM
+static FileServer* runningServer = nullptr;
+
+// stop the running server
+static void stopServer(int) {
+	if (runningServer != nullptr) {
+		runningServer->stop();
+	}
+}
+
+// the budget of the run, cancelled by SIGINT and SIGTERM
+static Budget* runningBudget = nullptr;
+
+// cancel the run, it stops at its next check
+static void cancelRun(int) {
+	if (runningBudget != nullptr) {
+		runningBudget->cancel();
+	}
+}
+
+// the longest deadline, a year of milliseconds, so the deadline never overflows the clock
+static const unsigned long long MAX_DEADLINE = 365ULL * 24 * 60 * 60 * 1000;
+
+// parse a whole unsigned decimal number of at most maximum, false if text is anything else
+static bool parseNumber(const char* text, unsigned long long& value,
+	unsigned long long maximum = std::numeric_limits<unsigned long long>::max()) {
+
+	char* end = nullptr;
+	errno = 0;
+	value = std::strtoull(text, &end, 10);
+	return text[0] >= '0' && text[0] <= '9' && *end == '\0' && errno == 0 && value <= maximum;
+}
+
+// print usage to the error stream
+static void usage(const char* program) {
+	std::cerr << "usage: " << program << " [--arena] [--huge-pages H] [--numa N] [--compress-output report.gz] [--layout L] [--grammar G]" << std::endl
+		<< "       " << std::string(std::strlen(program), ' ') << " [filter] [input-file]" << std::endl
+		<< "       " << program << " [--range M N | --tail K] [--index FILE] input-file" << std::endl
+		<< "       " << program << " --backward input-file" << std::endl
+		<< "       " << program << " [--lines forward|backward|reverse-words | --line N] [input-file]" << std::endl
+		<< "       " << program << " [--sort bytes|length] [--unique] [--threads N] [input-file]" << std::endl
+		<< "       " << program << " --profile [report, sort or range options] [input-file]" << std::endl
+		<< "       " << program << " [--split-output DIR] [--route N=TARGET]... [--threads N] [filter] [input-file]" << std::endl
+		<< "       " << program << " [--deadline MS] [--memory-budget MB] [report, sort or line options] [input-file]" << std::endl
+		<< "       " << program << " --extract-section N report.gz" << std::endl
+		<< "       " << program << " --serve socket [--threads N] [--cache N]" << std::endl
+		<< "An input file may be gzip or zstd compressed, std::cin is read when no input file is given." << std::endl
+		<< "Every N, M, K, MS and MB is a whole decimal number, anything else prints this message." << std::endl
+		<< "--arena places the File and all print temporaries in one arena, released at exit, all but the" << std::endl
+		<< "characters of words too long for std::string's small string buffer, which stay on the heap." << std::endl
+		<< "--huge-pages off|transparent|explicit maps the arena's blocks with 2 MB pages, explicit ones from the" << std::endl
+		<< "hugetlb pool falling back to transparent ones. --numa interleave spreads them over the NUMA nodes," << std::endl
+		<< "local (the default) leaves them on the node that first touches them. Either implies --arena, and" << std::endl
+		<< "compression workers then have mapped arenas of their own, one NUMA node each, see PageAllocator.hpp." << std::endl
+		<< "--layout stores the words of a named input as a File (file), each distinct word once (interned) or" << std::endl
+		<< "in 16-byte slots (packed). By default (auto) the first MB of the input is sampled to choose, see" << std::endl
+		<< "LayoutPlanner.hpp, --layout and --profile log the choice to std::cerr. Sorting needs a File." << std::endl
+		<< "--grammar splits the input into words at whitespace (the default), as CSV fields (csv: split at" << std::endl
+		<< "commas and newlines, \"quoted\" fields, spaces around fields dropped) or as prose (text: split at" << std::endl
+		<< "whitespace, punctuation around words dropped), see GrammarTokenizer.hpp. Not for line, range or" << std::endl
+		<< "backward modes." << std::endl
+		<< "A filter prints only the matching words in every section of the report: --contains TEXT, --prefix" << std::endl
+		<< "TEXT, --any-of A,B,C (words containing any of them) or --match REGEX (. [a-z] [^...] * + ? \\ ^ $)." << std::endl
+		<< "Odd words reversed and alternating words are matched before they are transformed." << std::endl
+		<< "--split-output writes each section of the report, without its title, to a file of its own in DIR" << std::endl
+		<< "(00-forward-normal-iterator.txt and so on). --route sends section N to TARGET, a path or fd:N for" << std::endl
+		<< "a descriptor already open, and may be repeated. Routed sections are written concurrently on N" << std::endl
+		<< "threads, the rest of the report still goes to std::cout, see SectionRouter.hpp." << std::endl
+		<< "--deadline stops the run after MS milliseconds, --memory-budget stops it before it holds more than" << std::endl
+		<< "MB of words and print copies, where the backward print modes of a forward list walk it in chunks" << std::endl
+		<< "rather than copy it. Either lets SIGINT and SIGTERM stop the run at its next check, see Budget.hpp." << std::endl
+		<< "--range and --tail report on words M to N - 1 (M no more than N), or the last K words, of an" << std::endl
+		<< "uncompressed input file without parsing the rest of it. Finding the words counts the words of the" << std::endl
+		<< "whole file once per run, unless --index saves that count to FILE, to be loaded by later runs while" << std::endl
+		<< "the input is unchanged." << std::endl
+		<< "--backward prints the words of an uncompressed input file last to first, reading it from the end" << std::endl
+		<< "in bounded memory." << std::endl
+		<< "--lines prints the input a line at a time, words separated by spaces: in order, last line first," << std::endl
+		<< "or with the words of each line reversed. --line prints line N only, counting from 1." << std::endl
+		<< "--sort prints the words sorted by byte value, as sort(1) does in the C locale, or shortest first," << std::endl
+		<< "on N threads (default all cores). --unique prints each distinct word once, sorted by bytes unless" << std::endl
+		<< "--sort length is given." << std::endl
+		<< "--profile measures reading and each section of the report (or the sort) with the hardware counters" << std::endl
+		<< "(cycles, instructions, cache and branch misses, page faults) and prints a table of them to std::cerr" << std::endl
+		<< "after the output, see PerfCounters.hpp. Without counters, as in most containers, the timers are used." << std::endl
+		<< "--serve answers PRINT and STATS requests on a Unix domain socket until interrupted, keeping the" << std::endl
+		<< "last N parsed files (default 64) in memory, see FileServer.hpp." << std::endl;
+}
+
+// command line options, see usage
+struct Options {
+	// input file, std::cin when empty
+	std::string inputPath;
+	// report outputs: a compressed file, a directory of sections, or sections routed one by one
+	std::string compressedPath;
+	std::string splitDirectory;
+	std::vector<std::string> routes;
+	// section of a compressed report to print, and the report
+	unsigned long long extractSection = 0;
+	std::string extractPath;
+	// socket to serve on, and the number of parsed files the server keeps
+	std::string socketPath;
+	unsigned long long cacheCapacity = 64;
+	// worker threads of the server, the report, the sort and the planned read, 0 for all cores
+	unsigned long long threads = 0;
+	// arena and the pages it maps
+	bool useArena = false;
+	PageAllocator::Policy pagePolicy;
+	// words M to N - 1 (rangeFirst and rangeLast), or the last K (rangeFirst), and the saved checkpoint index
+	bool useRange = false;
+	bool useTail = false;
+	unsigned long long rangeFirst = 0;
+	unsigned long long rangeLast = 0;
+	std::string indexPath;
+	// print modes in place of the report
+	bool backward = false;
+	std::string lineMode;
+	unsigned long long lineNumber = 0;
+	std::string sortOrder;
+	bool unique = false;
+	// measure each phase
+	bool profile = false;
+	// how the input is stored and split into words
+	std::string layoutName = "auto";
+	bool logLayout = false;
+	std::string grammarName = "whitespace";
+	// words the report prints
+	std::string filterKind;
+	std::string filterText;
+	// limits of the run, 0 for none
+	unsigned long long deadline = 0;
+	unsigned long long memoryBudget = 0;
+};
+
+// read the command line into options, false if it is not a valid one
+// a bad --huge-pages or --numa value throws std::invalid_argument, naming the values allowed
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--arena") {
+			options.useArena = true;
+		}
+		else if (arg == "--huge-pages" && hasValue) {
+			options.pagePolicy.pages = PageAllocator::parsePages(argv[++i]);
+			options.useArena = true;
+		}
+		else if (arg == "--numa" && hasValue) {
+			options.pagePolicy.placement = PageAllocator::parsePlacement(argv[++i]);
+			options.useArena = true;
+		}
+		else if (arg == "--compress-output" && hasValue) {
+			options.compressedPath = argv[++i];
+		}
+		else if (arg == "--split-output" && hasValue) {
+			options.splitDirectory = argv[++i];
+		}
+		else if (arg == "--route" && hasValue) {
+			options.routes.push_back(argv[++i]);
+		}
+		else if (arg == "--extract-section" && i + 2 < argc) {
+			if (!parseNumber(argv[++i], options.extractSection, 0xffff)) {
+				return false;
+			}
+			options.extractPath = argv[++i];
+		}
+		else if (arg == "--range" && i + 2 < argc) {
+			options.useRange = true;
+			if (!parseNumber(argv[++i], options.rangeFirst) || !parseNumber(argv[++i], options.rangeLast)
+				|| options.rangeFirst > options.rangeLast) {
+				return false;
+			}
+		}
+		else if (arg == "--tail" && hasValue) {
+			options.useTail = true;
+			if (!parseNumber(argv[++i], options.rangeFirst)) {
+				return false;
+			}
+		}
+		else if (arg == "--index" && hasValue) {
+			options.indexPath = argv[++i];
+		}
+		else if (arg == "--serve" && hasValue) {
+			options.socketPath = argv[++i];
+		}
+		else if (arg == "--threads" && hasValue) {
+			if (!parseNumber(argv[++i], options.threads, std::numeric_limits<unsigned>::max())) {
+				return false;
+			}
+		}
+		else if (arg == "--cache" && hasValue) {
+			if (!parseNumber(argv[++i], options.cacheCapacity, std::numeric_limits<size_t>::max())) {
+				return false;
+			}
+		}
+		else if (arg == "--layout" && hasValue) {
+			options.layoutName = argv[++i];
+			options.logLayout = true;
+		}
+		else if (arg == "--grammar" && hasValue) {
+			options.grammarName = argv[++i];
+		}
+		else if (arg == "--deadline" && hasValue) {
+			if (!parseNumber(argv[++i], options.deadline, MAX_DEADLINE)) {
+				return false;
+			}
+		}
+		else if (arg == "--memory-budget" && hasValue) {
+			if (!parseNumber(argv[++i], options.memoryBudget, std::numeric_limits<size_t>::max() / (1024 * 1024))) {
+				return false;
+			}
+		}
+		else if (arg == "--profile") {
+			options.profile = true;
+		}
+		else if (arg == "--backward") {
+			options.backward = true;
+		}
+		else if (arg == "--sort" && hasValue) {
+			options.sortOrder = argv[++i];
+		}
+		else if (arg == "--unique") {
+			options.unique = true;
+		}
+		else if ((arg == "--contains" || arg == "--prefix" || arg == "--any-of" || arg == "--match") && hasValue) {
+			options.filterKind = arg;
+			options.filterText = argv[++i];
+		}
+		else if (arg == "--lines" && hasValue) {
+			options.lineMode = argv[++i];
+		}
+		else if (arg == "--line" && hasValue) {
+			options.lineMode = "line";
+			if (!parseNumber(argv[++i], options.lineNumber) || options.lineNumber == 0) {
+				return false;
+			}
+		}
+		else if (arg.size() > 1 && arg[0] == '-') {
+			return false;
+		}
+		else {
+			options.inputPath = arg;
+		}
+	}
+
+	// the values of the modes
+	if ((!options.sortOrder.empty() && options.sortOrder != "bytes" && options.sortOrder != "length")
+		|| (!options.lineMode.empty() && options.lineMode != "forward" && options.lineMode != "backward"
+			&& options.lineMode != "reverse-words" && options.lineMode != "line")) {
+		return false;
+	}
+
+	// grammars other than whitespace are only read by the report and sort modes
+	if ((options.grammarName != "whitespace" && options.grammarName != "csv" && options.grammarName != "text")
+		|| (options.grammarName != "whitespace"
+			&& (options.backward || options.useRange || options.useTail || !options.lineMode.empty()))) {
+		return false;
+	}
+
+	// the range and backward modes read a named file, and a saved index is only for the range modes
+	if (((options.useRange || options.useTail || options.backward) && options.inputPath.empty())
+		|| (!options.indexPath.empty() && !options.useRange && !options.useTail)) {
+		return false;
+	}
+
+	// only the report has sections to route
+	if ((!options.splitDirectory.empty() || !options.routes.empty())
+		&& (!options.compressedPath.empty() || !options.sortOrder.empty() || options.unique || options.backward
+			|| !options.lineMode.empty())) {
+		return false;
+	}
+
+	// a server has no deadline or memory budget
+	return options.socketPath.empty() || (options.deadline == 0 && options.memoryBudget == 0);
+}
+
+// write the report of words to std::cout, or to compressed if it is open, or with its sections routed by router,
+// each phase measured if counters is set
+template <class Words>
+static void writeReport(const Words& words,
+	std::ofstream& compressed,
+	const SectionRouter& router,
+	unsigned threads,
+	const PatternFilter& filter,
+	PerfCounters* counters,
+	std::vector<std::pair<std::string, PerfCounters::Sample> >& phases) {
+
+	if (compressed.is_open()) {
+		if (counters != nullptr) {
+			counters->start();
+		}
+
+		FileReport::writeCompressed(words, compressed, threads, filter);
+
+		if (counters != nullptr) {
+			compressed.flush();
+			phases.push_back(std::make_pair(std::string("compressed report"), counters->stop()));
+		}
+	}
+	else if (router.active()) {
+		if (counters != nullptr) {
+			counters->start();
+		}
+
+		FileReport::writeRouted(words, router, std::cout, threads, filter);
+
+		if (counters != nullptr) {
+			phases.push_back(std::make_pair(std::string("routed report"), counters->stop()));
+		}
+	}
+	else if (counters != nullptr) {
+		FileReport::writeProfiled(words, std::cout, *counters, phases, filter);
+	}
+	else {
+		FileReport::write(words, std::cout, filter);
+	}
+}
+
+// read input to the planned layout, split into tokens by the grammar
+template <class Grammar>
+static void readWords(std::istream& input,
+	LayoutPlanner::Layout layout,
+	unsigned threads,
+	File& f,
+	InternedFile& interned,
+	PackedFile& packed) {
+
+	switch (layout) {
+	case LayoutPlanner::INTERNED:
+		interned = FileFactory::readInternedFileFromCompressedStream<Grammar>(input, threads);
+		break;
+	case LayoutPlanner::PACKED:
+		packed = FileFactory::readPackedFileFromCompressedStream<Grammar>(input, threads);
+		break;
+	default:
+		f = FileFactory::readFileFromCompressedStream<Grammar>(input, threads);
+		break;
+	}
+}
 
 // main entry point
-int main() {
-	// create a file using std::cin
-	File f = FileFactory::readFileFromStream(std::cin);
-
-	// print forward - const
-	std::cout << "Const - Forward - Normal Iterator" << std::endl;
-	FileFactory::printFileConst(f, std::cout, FileFactory::PrintDirection::FORWARD, FileFactory::IteratorType::NORMAL);
-
-	// print backward - const
-	std::cout << "\nConst - Backward - Normal Iterator" << std::endl;
-	FileFactory::printFileConst(f, std::cout, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::NORMAL);
-	
-	// print forward - non const
-	std::cout << "\nForward - Normal Iterator" << std::endl;
-	FileFactory::printFile(f, std::cout, FileFactory::PrintDirection::FORWARD, FileFactory::IteratorType::NORMAL);
-
-	// print backward - non const
-	std::cout << "\nBackward - Normal Iterator" << std::endl;
-	FileFactory::printFile(f, std::cout, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::NORMAL);
-
-	// print backward - reverse iteration - const
-	std::cout << "\nConst - Backward - Reverse Iterator" << std::endl;
-	FileFactory::printFileConst(f, std::cout, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::REVERSE);
-
-	// print backward - reverse iteration - non const
-	std::cout << "\nBackward - Reverse Iterator" << std::endl;
-	FileFactory::printFile(f, std::cout, FileFactory::PrintDirection::BACKWARD, FileFactory::IteratorType::REVERSE);
-
-	// print odd words in reverse
-	std::cout << "\nOdd words in reverse" << std::endl;
-	FileFactory::printOddWordsReverse(f, std::cout);
-
-	// print alternating words
-	std::cout << "\nAlternating words" << std::endl;
-	FileFactory::printAlternatingWords(f, std::cout);
-
-	// construct a c-string array from File
-	size_t size;
-	char** myFile = FileFactory::toCStringArray(f,size);
-	
-	// print c-string array foward - const
-	std::cout << "\nConst C-Strings - Forward" << std::endl;
-	FileFactory::printArrayConst(myFile, size, std::cout, FileFactory::PrintDirection::FORWARD);
-
-	// print c-string array backward - const
-	std::cout << "\nConst C-Strings - Backward" << std::endl;
-	FileFactory::printArrayConst(myFile, size, std::cout, FileFactory::PrintDirection::BACKWARD);
-
-	// print c-string array foward - non const
-	std::cout << "\nC-Strings - Forward" << std::endl;
-	FileFactory::printArray(myFile, size, std::cout, FileFactory::PrintDirection::FORWARD);
-
-	// print c-string array backward - non const
-	std::cout << "\nC-Strings - Backward" << std::endl;
-	FileFactory::printArray(myFile, size, std::cout, FileFactory::PrintDirection::BACKWARD);
-
-	// clean up
-	delete[] myFile;
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		if (!parseOptions(argc, argv, options)) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	catch (const std::invalid_argument& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	// the run stops when it is out of time or memory, or is cancelled, the budget outlives the arena it charges
+	Budget budget;
+	std::unique_ptr<BudgetScope> budgetScope;
+	if (options.deadline > 0 || options.memoryBudget > 0) {
+		if (options.deadline > 0) {
+			budget.setTimeout(std::chrono::milliseconds(options.deadline));
+		}
+		if (options.memoryBudget > 0) {
+			budget.setMemoryLimit(static_cast<size_t>(options.memoryBudget) * 1024 * 1024);
+		}
+
+		budgetScope.reset(new BudgetScope(&budget));
+		runningBudget = &budget;
+		std::signal(SIGINT, cancelRun);
+		std::signal(SIGTERM, cancelRun);
+	}
+
+	// all allocations of the run come from one arena when requested, released at once at exit
+	Arena arena(options.pagePolicy);
+	std::unique_ptr<ArenaScope> arenaScope;
+	if (options.useArena) {
+		arenaScope.reset(new ArenaScope(arena));
+	}
+
+	try {
+		// serve requests until interrupted
+		if (!options.socketPath.empty()) {
+			FileServer server(options.socketPath, static_cast<unsigned>(options.threads), static_cast<size_t>(options.cacheCapacity));
+			runningServer = &server;
+			std::signal(SIGINT, stopServer);
+			std::signal(SIGTERM, stopServer);
+
+			server.run();
+			runningServer = nullptr;
+			return 0;
+		}
+
+		// print one section of a compressed report
+		if (!options.extractPath.empty()) {
+			std::ifstream report(options.extractPath.c_str(), std::ios::in | std::ios::binary);
+			if (!report) {
+				usage(argv[0]);
+				return 1;
+			}
+
+			CompressedWriter::extractSection(report, static_cast<size_t>(options.extractSection), std::cout);
+			return 0;
+		}
+
+		// stream the words backward from the end of the file
+		if (options.backward) {
+			ReverseReader reader(options.inputPath);
+			FileFactory::printFileBackward(reader, std::cout);
+			return 0;
+		}
+
+		// print a line at a time, the line index is recorded while the words are read
+		if (!options.lineMode.empty()) {
+			std::ifstream input;
+			if (!options.inputPath.empty()) {
+				input.open(options.inputPath.c_str(), std::ios::in | std::ios::binary);
+				if (!input) {
+					std::cerr << "Unable to open " << options.inputPath << std::endl;
+					return 1;
+				}
+			}
+
+			LineIndex lines;
+			File f = FileFactory::readFileWithLines(options.inputPath.empty() ? std::cin : input, lines);
+
+			if (options.lineMode == "forward") {
+				FileFactory::printLines(f, lines, std::cout);
+			}
+			else if (options.lineMode == "backward") {
+				FileFactory::printLinesBackward(f, lines, std::cout);
+			}
+			else if (options.lineMode == "reverse-words") {
+				FileFactory::printLinesWordsReversed(f, lines, std::cout);
+			}
+			else if (options.lineNumber <= lines.lines()) {
+				FileFactory::printLines(f, lines, std::cout, options.lineNumber - 1, options.lineNumber);
+			}
+			else {
+				std::cerr << "There are only " << lines.lines() << " lines" << std::endl;
+				return 1;
+			}
+			return 0;
+		}
+
+		// words the report prints, a malformed pattern throws
+		PatternFilter filter;
+		if (options.filterKind == "--contains") {
+			filter = PatternFilter::literal(options.filterText);
+		}
+		else if (options.filterKind == "--prefix") {
+			filter = PatternFilter::prefix(options.filterText);
+		}
+		else if (options.filterKind == "--any-of") {
+			std::vector<std::string> literals;
+			std::istringstream list(options.filterText);
+			std::string literal;
+			while (std::getline(list, literal, ',')) {
+				literals.push_back(literal);
+			}
+			filter = PatternFilter::anyOf(literals);
+		}
+		else if (options.filterKind == "--match") {
+			filter = PatternFilter::regex(options.filterText);
+		}
+
+		// phases measured for --profile, reported after the output
+		std::unique_ptr<PerfCounters> counters;
+		std::vector<std::pair<std::string, PerfCounters::Sample> > phases;
+		if (options.profile) {
+			counters.reset(new PerfCounters());
+			counters->start();
+		}
+
+		// a named input is sampled to plan its layout, then read again from the start
+		bool sorted = !options.sortOrder.empty() || options.unique;
+		LayoutPlanner::Workload workload;
+		workload.needsFile = sorted || options.useRange || options.useTail;
+		workload.threads = static_cast<unsigned>(options.threads);
+
+		std::ifstream input;
+		std::string sample;
+		if (!options.useRange && !options.useTail && !options.inputPath.empty()) {
+			input.open(options.inputPath.c_str(), std::ios::in | std::ios::binary);
+			if (!input) {
+				std::cerr << "Unable to open " << options.inputPath << std::endl;
+				return 1;
+			}
+
+			input.seekg(0, std::ios::end);
+			std::streamoff size = input.tellg();
+			workload.inputBytes = size > 0 ? static_cast<std::uint64_t>(size) : 0;
+			input.seekg(0, std::ios::beg);
+
+			sample.resize(static_cast<size_t>(std::min<std::uint64_t>(LayoutPlanner::SAMPLE_SIZE, workload.inputBytes)));
+			input.read(&sample[0], static_cast<std::streamsize>(sample.size()));
+			sample.resize(static_cast<size_t>(input.gcount()));
+			input.clear();
+			input.seekg(0, std::ios::beg);
+
+			// gzip and zstd magic numbers
+			workload.compressed = sample.compare(0, 2, "\x1f\x8b") == 0 || sample.compare(0, 4, "\x28\xb5\x2f\xfd") == 0;
+		}
+
+		LayoutPlanner::Plan plan = LayoutPlanner::plan(LayoutPlanner::parse(options.layoutName),
+			input.is_open() ? sample.data() : nullptr, sample.size(), workload);
+		if (options.logLayout || options.profile) {
+			LayoutPlanner::describe(plan, std::cerr);
+		}
+
+		File f;
+		InternedFile interned;
+		PackedFile packed;
+
+		if (options.useRange || options.useTail) {
+			// create a file from part of the named input, through its checkpoint index
+			PagedReader reader(options.inputPath, 0, options.indexPath);
+			f = options.useTail ? FileFactory::readFileTail(reader, options.rangeFirst)
+				: FileFactory::readFileRange(reader, options.rangeFirst, options.rangeLast);
+		}
+		else if (options.grammarName == "csv") {
+			readWords<CsvGrammar>(options.inputPath.empty() ? std::cin : input, plan.layout, plan.threads, f, interned, packed);
+		}
+		else if (options.grammarName == "text") {
+			readWords<TextGrammar>(options.inputPath.empty() ? std::cin : input, plan.layout, plan.threads, f, interned, packed);
+		}
+		else if (!options.inputPath.empty()) {
+			// read the named input in the planned layout, decompressing if needed
+			switch (plan.layout) {
+			case LayoutPlanner::INTERNED:
+				interned = FileFactory::readInternedFileFromCompressedStream(input, plan.threads);
+				break;
+			case LayoutPlanner::PACKED:
+				packed = FileFactory::readPackedFileFromCompressedStream(input, plan.threads);
+				break;
+			default:
+				f = FileFactory::readFileFromCompressedStream(input, plan.threads);
+				break;
+			}
+		}
+		else {
+			// read std::cin in the planned layout, only --layout chooses one without a sample
+			switch (plan.layout) {
+			case LayoutPlanner::INTERNED:
+				interned = FileFactory::readInternedFileFromStream(std::cin);
+				break;
+			case LayoutPlanner::PACKED:
+				packed = FileFactory::readPackedFileFromStream(std::cin);
+				break;
+			default:
+				f = FileFactory::readFileFromStream(std::cin);
+				break;
+			}
+		}
+
+		if (options.profile) {
+			phases.push_back(std::make_pair(std::string("read"), counters->stop()));
+		}
+
+		if (sorted) {
+			// print the words sorted, in place of the report
+			WordSorter::Order order = options.sortOrder == "length" ? WordSorter::LENGTH : WordSorter::LEXICOGRAPHIC;
+			if (options.profile) {
+				counters->start();
+			}
+
+			FileFactory::printSorted(f, std::cout, order, options.unique, plan.threads);
+
+			if (options.profile) {
+				std::cout.flush();
+				phases.push_back(std::make_pair(std::string(options.unique ? "sort unique" : "sort"), counters->stop()));
+			}
+		}
+		else {
+			// the report goes to std::cout, or compressed to a file, one seekable member per section, or with
+			// sections routed to outputs of their own
+			SectionRouter router;
+			for (const std::string& route : options.routes) {
+				router.route(route);
+			}
+			if (!options.splitDirectory.empty()) {
+				router.routeAll(options.splitDirectory);
+			}
+
+			std::ofstream compressed;
+			if (!options.compressedPath.empty()) {
+				compressed.open(options.compressedPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+				if (!compressed) {
+					std::cerr << "Unable to open " << options.compressedPath << std::endl;
+					return 1;
+				}
+			}
+
+			if (plan.layout == LayoutPlanner::INTERNED) {
+				writeReport(interned, compressed, router, plan.threads, filter, counters.get(), phases);
+			}
+			else if (plan.layout == LayoutPlanner::PACKED) {
+				writeReport(packed, compressed, router, plan.threads, filter, counters.get(), phases);
+			}
+			else {
+				writeReport(f, compressed, router, plan.threads, filter, counters.get(), phases);
+			}
+		}
+
+		if (options.profile) {
+			PerfCounters::writeTable(std::cerr, FileFactory::containerName(), phases);
+			if (options.useArena) {
+				std::cerr << "arena " << arena.bytesReserved() / 1024 << " KB reserved, huge pages "
+					<< PageAllocator::name(options.pagePolicy.pages) << ", NUMA " << PageAllocator::name(options.pagePolicy.placement)
+					<< " over " << PageAllocator::nodes() << (PageAllocator::nodes() == 1 ? " node" : " nodes") << std::endl;
+			}
+			if (budgetScope) {
+				std::cerr << "budget " << budget.peakBytes() / 1024 << " KB at most";
+				if (budget.memoryLimit() != Budget::UNLIMITED) {
+					std::cerr << " of " << budget.memoryLimit() / 1024 << " KB";
+				}
+				std::cerr << std::endl;
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,11 @@
+// Compiles only where Generator.hpp finds C++20 coroutines, tried by CMakeLists.txt before it builds the
+// generator checks.
+#include "Generator.hpp"
+
+#ifndef FILEFACTORY_HAVE_COROUTINES
+#error "Generator.hpp found no coroutines"
+#endif
+
+int main() {
+	return 0;
+}
@@ -0,0 +1,13 @@
+# Merge Clang's raw profiles into the default.profdata read by FILEFACTORY_PGO=USE.
+# Invoked by the pgo-train target: cmake -DPROFDATA=... -DPROFILE_DIR=... -P MergeProfile.cmake
+
+file(GLOB raw "${PROFILE_DIR}/*.profraw")
+if(NOT raw)
+	message(FATAL_ERROR "No raw profiles in ${PROFILE_DIR}, build with FILEFACTORY_PGO=GENERATE first")
+endif()
+
+execute_process(COMMAND "${PROFDATA}" merge -output=${PROFILE_DIR}/default.profdata ${raw}
+	RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "llvm-profdata merge exited with ${result}")
+endif()
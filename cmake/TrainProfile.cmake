@@ -0,0 +1,42 @@
+# Run one FileFactory program over the training corpus, exercising the paths a production run takes.
+# Invoked by the pgo-train target: cmake -DPROGRAM=... -DARGUMENTS=... -DCORPUS=... -DWORK_DIR=... -P TrainProfile.cmake
+# ARGUMENTS are extra arguments for every run that reads the corpus, separated by commas
+
+get_filename_component(name "${PROGRAM}" NAME_WE)
+set(report "${WORK_DIR}/${name}.training.gz")
+
+# full report to a file, then compressed, one section extracted, and the backward stream
+# arguments of a run are separated by commas, so each run stays one list element
+set(runs
+	"${ARGUMENTS},${CORPUS}"
+	"--compress-output,${report},${ARGUMENTS},${CORPUS}"
+	"--extract-section,7,${report}"
+	"--backward,${CORPUS}")
+
+foreach(run IN LISTS runs)
+	string(REPLACE "," ";" run "${run}")
+	string(REPLACE ";" " " shown "${run}")
+	message(STATUS "${name} ${shown}")
+
+	execute_process(COMMAND "${PROGRAM}" ${run}
+		OUTPUT_FILE "${WORK_DIR}/${name}.training.out"
+		RESULT_VARIABLE result)
+
+	# compressed reports need zlib, a build without it is still trained on the rest
+	if(NOT result EQUAL 0)
+		message(WARNING "${name} ${shown} exited with ${result}")
+	endif()
+endforeach()
+
+# standard input, which the ARRAY backend cannot hold in full
+if(ARGUMENTS STREQUAL "")
+	execute_process(COMMAND "${PROGRAM}"
+		INPUT_FILE "${CORPUS}"
+		OUTPUT_FILE "${WORK_DIR}/${name}.training.out"
+		RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${name} < corpus exited with ${result}")
+	endif()
+endif()
+
+file(REMOVE "${WORK_DIR}/${name}.training.out" "${report}")
@@ -0,0 +1,100 @@
+/**
+* File:		AllocationCounter.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is a preloadable library that counts the heap allocations of a program. It replaces the
+*			global operator new and delete, so loaded with LD_PRELOAD (DYLD_INSERT_LIBRARIES on macOS) it sees
+*			every C++ allocation of an unmodified program. At exit it writes the number of allocations and the
+*			bytes requested to the file named by FILEFACTORY_ALLOCATION_LOG, as "allocations N" and "bytes N" lines.
+*/
+
+// includes
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+	std::atomic<unsigned long long> allocations(0);
+	std::atomic<unsigned long long> bytes(0);
+
+	// count, then allocate, throwing like the standard operator new
+	void* allocate(std::size_t size) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+
+		void* pointer = std::malloc(size > 0 ? size : 1);
+		if (pointer == nullptr) {
+			throw std::bad_alloc();
+		}
+		return pointer;
+	}
+
+	// writes the counts when the program exits
+	struct Report {
+		~Report() {
+			const char* path = std::getenv("FILEFACTORY_ALLOCATION_LOG");
+			if (path == nullptr) {
+				return;
+			}
+
+			std::FILE* log = std::fopen(path, "w");
+			if (log != nullptr) {
+				std::fprintf(log, "allocations %llu\nbytes %llu\n", allocations.load(), bytes.load());
+				std::fclose(log);
+			}
+		}
+	} report;
+
+} // end anonymous namespace
+
+void* operator new(std::size_t size) {
+	return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+	return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return allocate(size);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
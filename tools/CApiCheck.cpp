@@ -0,0 +1,171 @@
+/**
+* File:		CApiCheck.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is a check of the C interface of FileFactoryC.h against the C++ one. It reads the input file
+*			named on the command line through the shared library, from a buffer and from a file descriptor, and
+*			requires every print mode to print exactly what FileReport prints for a File read by FileFactory, a
+*			buffer too small for the output to be filled and measured, and bad arguments to be refused. It is
+*			built once per backend, and the differential tester runs it on every input it generates, see --check.
+*			Each mismatch is printed, the exit status is 0 only if everything matched.
+*/
+
+// includes
+#include "FileFactoryC.h"
+#include "FileFactory.hpp"
+#include "FileReport.hpp"
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+	// mismatches found
+	int mismatches = 0;
+
+	// print a mismatch, naming what was checked
+	void fail(const std::string& what, const std::string& found) {
+		std::cout << FileFactory::containerName() << " C interface " << what << ": " << found << std::endl;
+		mismatches++;
+	}
+
+	// compare output of the C interface with what FileFactory printed
+	void compare(const std::string& what, const std::string& expected, const std::string& actual) {
+		if (expected == actual) {
+			return;
+		}
+
+		size_t line = 1;
+		for (size_t i = 0; i < expected.size() && i < actual.size() && expected[i] == actual[i]; i++) {
+			if (expected[i] == '\n') {
+				line++;
+			}
+		}
+		fail(what, "differs at line " + std::to_string(line));
+	}
+
+	// print the file in the mode through the C interface, sizing the buffer with a first call
+	std::string print(const filefactory_file* file, filefactory_mode mode) {
+		size_t size = 0;
+		filefactory_status status = filefactory_print(file, mode, NULL, 0, &size);
+		if (status != FILEFACTORY_OK && status != FILEFACTORY_ERROR_BUFFER_TOO_SMALL) {
+			fail("mode " + std::to_string(mode), filefactory_last_error());
+			return "";
+		}
+
+		std::string output(size, '\0');
+		size_t written = 0;
+		status = filefactory_print(file, mode, size == 0 ? NULL : &output[0], size, &written);
+		if (status != FILEFACTORY_OK || written != size) {
+			fail("mode " + std::to_string(mode), "printed " + std::to_string(written) + " bytes of " + std::to_string(size));
+		}
+		return output;
+	}
+
+} // end anonymous namespace
+
+// main entry point
+int main(int argc, char* argv[]) {
+	if (argc != 2) {
+		std::cerr << "usage: " << argv[0] << " input-file" << std::endl
+			<< "Checks that the C interface prints what FileFactory prints, in every mode." << std::endl;
+		return 1;
+	}
+
+	try {
+		std::ifstream infile(argv[1], std::ios::in | std::ios::binary);
+		if (!infile) {
+			std::cerr << "Unable to open " << argv[1] << std::endl;
+			return 1;
+		}
+		std::string text((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+		infile.clear();
+		infile.seekg(0, std::ios::beg);
+
+		// what the C++ interface prints
+		File reference = FileFactory::readFileFromStream(infile);
+		size_t size;
+		char** fileArray = FileFactory::toCStringArray(reference, size);
+		std::ostringstream report;
+		FileReport::write(reference, report);
+
+		if (filefactory_version() != FILEFACTORY_C_VERSION) {
+			fail("version", std::to_string(filefactory_version()));
+		}
+
+		filefactory_file* file = NULL;
+		if (filefactory_create_from_buffer(text.data(), text.size(), &file) != FILEFACTORY_OK) {
+			fail("buffer", filefactory_last_error());
+			FileFactory::freeCStringArray(fileArray, size);
+			return 1;
+		}
+
+		// the C-string array of an ARRAY File has a slot for every word it holds, counted are the words
+		size_t words = 0;
+		for (File::const_iterator itr = reference.cbegin(); itr != reference.cend(); ++itr) {
+			words += itr->empty() ? 0 : 1;
+		}
+		if (filefactory_word_count(file) != words) {
+			fail("word count", std::to_string(filefactory_word_count(file)) + ", expected " + std::to_string(words));
+		}
+
+		// each section, then the whole report
+		for (size_t section = 0; section < FileReport::SECTION_COUNT; section++) {
+			std::ostringstream expected;
+			FileReport::printSection(reference, fileArray, size, section, expected);
+			compare(FileReport::title(section), expected.str(), print(file, static_cast<filefactory_mode>(section)));
+		}
+		std::string printed = print(file, FILEFACTORY_MODE_REPORT);
+		compare("report", report.str(), printed);
+
+		// a buffer one byte short is filled, and the whole size is returned
+		if (!printed.empty()) {
+			std::string truncated(printed.size() - 1, '\0');
+			size_t written = 0;
+			filefactory_status status = filefactory_print(file, FILEFACTORY_MODE_REPORT,
+				truncated.empty() ? NULL : &truncated[0], truncated.size(), &written);
+			if (status != FILEFACTORY_ERROR_BUFFER_TOO_SMALL || written != printed.size()
+				|| truncated != printed.substr(0, truncated.size())) {
+				fail("short buffer", "status " + std::to_string(status) + ", " + std::to_string(written) + " bytes");
+			}
+		}
+
+		// bad arguments are refused with a reason
+		size_t written = 0;
+		if (filefactory_print(NULL, FILEFACTORY_MODE_REPORT, NULL, 0, &written) != FILEFACTORY_ERROR_ARGUMENT
+			|| filefactory_print(file, static_cast<filefactory_mode>(FILEFACTORY_MODE_REPORT + 1), NULL, 0, &written)
+				!= FILEFACTORY_ERROR_ARGUMENT
+			|| filefactory_last_error()[0] == '\0') {
+			fail("bad arguments", "accepted");
+		}
+		filefactory_free(file);
+
+		// the same words read from a descriptor
+		int descriptor = open(argv[1], O_RDONLY);
+		file = NULL;
+		if (descriptor < 0 || filefactory_create_from_fd(descriptor, &file) != FILEFACTORY_OK) {
+			fail("descriptor", descriptor < 0 ? "unable to open" : filefactory_last_error());
+		}
+		else {
+			compare("report from a descriptor", report.str(), print(file, FILEFACTORY_MODE_REPORT));
+		}
+		filefactory_free(file);
+		if (descriptor >= 0) {
+			close(descriptor);
+		}
+
+		FileFactory::freeCStringArray(fileArray, size);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+/**
+* File:		CorpusGenerator.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is a generator of test input for FileFactory. It writes text of a chosen size drawn from a
+*			generated vocabulary, with Zipf word frequencies and controllable word lengths, line lengths, blank
+*			lines, tabs and share of UTF-8 words. The same seed and options always produce the same bytes: the
+*			random numbers come from splitmix64 and every draw is integer arithmetic done here, nothing is left to
+*			the standard library's distributions, which differ between implementations. The only floating point
+*			is the Zipf weights, rounded to integers once.
+*/
+
+// includes
+#include "Random.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	// generator options, see usage
+	struct Options {
+		std::uint64_t seed = 1;
+		std::uint64_t bytes = 1024 * 1024;
+		std::uint64_t words = 0;
+		std::uint32_t vocabulary = 20000;
+		double zipf = 1.0;
+		std::uint32_t minLength = 1;
+		std::uint32_t meanLength = 5;
+		std::uint32_t maxLength = 20;
+		std::uint32_t lineWords = 12;
+		std::uint32_t blankPercent = 2;
+		std::uint32_t tabPercent = 2;
+		std::uint32_t utf8Percent = 0;
+		std::string output;
+	};
+
+	// letters, and multibyte characters for UTF-8 words (two, three and four byte sequences)
+	const char LETTERS[] = "etaoinshrdlcumwfgypbvkjxqz";
+	const char* const MULTIBYTE[] = {
+		"\xc3\xa9", "\xc3\xbc", "\xc3\xb1", "\xc3\xb8", "\xd0\xb6", "\xd0\xbb", "\xce\xbb", "\xce\xa9",
+		"\xe4\xb8\xad", "\xe6\x96\x87", "\xe2\x9c\x93", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf0\x9f\x8c\x8d"
+	};
+
+	// length in characters, minLength plus a geometric count with the requested mean, capped at maxLength
+	std::uint32_t wordLength(Random& random, const Options& options) {
+		std::uint32_t length = options.minLength;
+		std::uint64_t extra = options.meanLength > options.minLength ? options.meanLength - options.minLength : 0;
+
+		// each step continues with chance extra / (extra + 1), which gives a mean of extra steps
+		while (length < options.maxLength && random.below(extra + 1) < extra) {
+			length++;
+		}
+		return length;
+	}
+
+	// one vocabulary word, mostly common letters, some capitalized, some with multibyte characters
+	std::string makeWord(Random& random, const Options& options) {
+		std::uint32_t length = wordLength(random, options);
+		bool utf8 = random.percent(options.utf8Percent);
+		std::string word;
+
+		for (std::uint32_t i = 0; i < length; i++) {
+			if (utf8 && random.below(3) == 0) {
+				word += MULTIBYTE[random.below(sizeof(MULTIBYTE) / sizeof(MULTIBYTE[0]))];
+			}
+			else {
+				// weighted toward the front of LETTERS, the common letters
+				std::uint64_t a = random.below(sizeof(LETTERS) - 1);
+				std::uint64_t b = random.below(sizeof(LETTERS) - 1);
+				word += LETTERS[a < b ? a : b];
+			}
+		}
+
+		if (random.below(8) == 0 && word[0] >= 'a' && word[0] <= 'z') {
+			word[0] = static_cast<char>(word[0] - 'a' + 'A');
+		}
+		return word;
+	}
+
+	// cumulative Zipf weights, rank r has weight 1 / r^s, scaled to integers so drawing is exact
+	std::vector<std::uint64_t> zipfTable(std::uint32_t size, double exponent) {
+		std::vector<std::uint64_t> cumulative(size);
+		std::uint64_t total = 0;
+
+		for (std::uint32_t rank = 1; rank <= size; rank++) {
+			double weight = std::pow(static_cast<double>(rank), -exponent);
+			total += static_cast<std::uint64_t>(weight * 4294967296.0) + 1;
+			cumulative[rank - 1] = total;
+		}
+		return cumulative;
+	}
+
+	// index of the first cumulative weight above the draw
+	std::uint32_t drawRank(Random& random, const std::vector<std::uint64_t>& cumulative) {
+		std::uint64_t target = random.below(cumulative.back());
+		size_t low = 0;
+		size_t high = cumulative.size() - 1;
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			if (cumulative[middle] > target) {
+				high = middle;
+			}
+			else {
+				low = middle + 1;
+			}
+		}
+		return static_cast<std::uint32_t>(low);
+	}
+
+	// print usage to the error stream
+	void usage(const char* program) {
+		std::cerr << "usage: " << program << " [options] [-o output]" << std::endl
+			<< "  --seed N          random seed (1)" << std::endl
+			<< "  --size BYTES      approximate output size, K, M and G suffixes allowed (1M)" << std::endl
+			<< "  --words N         exact number of words, instead of --size" << std::endl
+			<< "  --vocabulary N    number of distinct words (20000)" << std::endl
+			<< "  --zipf S          Zipf exponent of word frequencies, 0 for uniform (1.0)" << std::endl
+			<< "  --min-length N    shortest word, in characters (1)" << std::endl
+			<< "  --mean-length N   mean length of vocabulary words, in characters (5)" << std::endl
+			<< "  --max-length N    longest word, in characters (20)" << std::endl
+			<< "  --line-words N    mean words per line (12)" << std::endl
+			<< "  --blank-lines P   percent of lines followed by a blank line (2)" << std::endl
+			<< "  --tabs P          percent of separators that are tabs (2)" << std::endl
+			<< "  --utf8 P          percent of vocabulary words with multibyte characters (0)" << std::endl
+			<< "With --zipf above 0 a few frequent words make up much of the text, so the mean length of the" << std::endl
+			<< "text's words varies with the seed around the mean length of the vocabulary." << std::endl;
+	}
+
+	// a size with an optional K, M or G suffix
+	std::uint64_t parseSize(const char* text) {
+		char* end = nullptr;
+		std::uint64_t value = std::strtoull(text, &end, 10);
+		switch (*end) {
+		case 'K': case 'k': return value << 10;
+		case 'M': case 'm': return value << 20;
+		case 'G': case 'g': return value << 30;
+		default: return value;
+		}
+	}
+
+} // end anonymous namespace
+
+// main entry point
+int main(int argc, char* argv[]) {
+	Options options;
+
+	// parse arguments
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--seed" && hasValue) {
+			options.seed = std::strtoull(argv[++i], NULL, 10);
+		}
+		else if (arg == "--size" && hasValue) {
+			options.bytes = parseSize(argv[++i]);
+		}
+		else if (arg == "--words" && hasValue) {
+			options.words = std::strtoull(argv[++i], NULL, 10);
+		}
+		else if (arg == "--vocabulary" && hasValue) {
+			options.vocabulary = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--zipf" && hasValue) {
+			options.zipf = std::strtod(argv[++i], NULL);
+		}
+		else if (arg == "--min-length" && hasValue) {
+			options.minLength = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--mean-length" && hasValue) {
+			options.meanLength = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--max-length" && hasValue) {
+			options.maxLength = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--line-words" && hasValue) {
+			options.lineWords = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--blank-lines" && hasValue) {
+			options.blankPercent = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--tabs" && hasValue) {
+			options.tabPercent = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "--utf8" && hasValue) {
+			options.utf8Percent = static_cast<std::uint32_t>(std::strtoul(argv[++i], NULL, 10));
+		}
+		else if (arg == "-o" && hasValue) {
+			options.output = argv[++i];
+		}
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (options.vocabulary == 0 || options.minLength == 0 || options.maxLength < options.minLength
+		|| options.lineWords == 0 || options.zipf < 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::ofstream file;
+	if (!options.output.empty()) {
+		file.open(options.output.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file) {
+			std::cerr << "Unable to open " << options.output << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& output = options.output.empty() ? std::cout : file;
+
+	// the vocabulary and the frequencies come from their own streams, so changing the size keeps both
+	Random vocabularyRandom(options.seed);
+	Random textRandom(options.seed ^ 0x5bd1e9955bd1e995ull);
+
+	std::vector<std::string> vocabulary;
+	vocabulary.reserve(options.vocabulary);
+	for (std::uint32_t i = 0; i < options.vocabulary; i++) {
+		vocabulary.push_back(makeWord(vocabularyRandom, options));
+	}
+	std::vector<std::uint64_t> cumulative = zipfTable(options.vocabulary, options.zipf);
+
+	// write lines of words until the word count or the size is reached
+	std::string line;
+	std::uint64_t written = 0;
+	std::uint64_t words = 0;
+	bool done = false;
+
+	while (!done) {
+		// line lengths vary from 1 to twice the mean
+		std::uint64_t lineLength = 1 + textRandom.below(2 * options.lineWords);
+		line.clear();
+
+		for (std::uint64_t i = 0; i < lineLength; i++) {
+			if (i > 0) {
+				line += textRandom.percent(options.tabPercent) ? '\t' : ' ';
+			}
+			line += vocabulary[drawRank(textRandom, cumulative)];
+			words++;
+
+			done = options.words > 0 ? words >= options.words : written + line.size() >= options.bytes;
+			if (done) {
+				break;
+			}
+		}
+
+		line += '\n';
+		if (!done && textRandom.percent(options.blankPercent)) {
+			line += '\n';
+		}
+
+		output.write(line.data(), static_cast<std::streamsize>(line.size()));
+		written += line.size();
+	}
+
+	output.flush();
+	if (!output) {
+		std::cerr << "Unable to write the corpus" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,421 @@
+/**
+* File:		Differential.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is a differential tester for the FileFactory programs. It generates random inputs aimed at
+*			the edges of the backends (no words, one word, odd and even counts, the ARRAY capacity, long words,
+*			every delimiter and arbitrary bytes), runs every program on each one, and requires every report to
+*			be byte-identical to the reference program's. With --original, HW1 is run too, reading the input on
+*			standard input as it always has, and its report is compared section by section, except the sections
+*			where HW1_3 deliberately prints something else. A failing input is saved, so it can be run again by
+*			hand, and the first differing section and line are reported. With --check, a check program is also
+*			run on each input, given its path, and must exit with status 0: PipelineCheck, one per backend,
+*			compares the transform pipelines with the print modes they stand for, CApiCheck compares the C
+*			interface with the C++ one. With --options, each input is also run with one of the option sets given,
+*			in turn, and those reports are compared across the programs too, so the layouts, filters, grammars,
+*			sort, line, range and output modes are all covered. The exit status is 0 only if every report
+*			matched and every check passed.
+*
+*			POSIX only: programs are run by the Process class.
+*/
+
+// includes
+#include "Process.hpp"
+#include "Random.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+	// HW1 alternates word order only, HW1_3 also alternates the characters of each word
+	const char* const ORIGINAL_DIFFERS[] = { "Alternating words" };
+
+	// the most words the ARRAY backend holds
+	const std::uint64_t ARRAY_CAPACITY = 10000;
+
+	// stands for a file an option set writes, each program writes its own, which is compared as part of its report
+	const std::string OUTPUT_PLACEHOLDER = "{output}";
+
+	// the tokenizer's delimiters, space and newline drawn most often
+	const char SEPARATORS[] = "  \n\n\t\r\v\f";
+
+	// one generated input
+	struct Case {
+		std::string text;
+		bool hasNull = false;
+	};
+
+	// a program's report, or why there is none
+	struct Report {
+		Process::Result result;
+		std::string output;
+	};
+
+	// characters of the generated words
+	enum class Alphabet { LETTERS, PRINTABLE, BYTES };
+
+	// a non-delimiter character from the alphabet
+	char drawCharacter(Random& random, Alphabet alphabet) {
+		switch (alphabet) {
+		case Alphabet::LETTERS: {
+			char c = static_cast<char>('a' + random.below(26));
+			return random.below(8) == 0 ? static_cast<char>(c - 'a' + 'A') : c;
+		}
+		case Alphabet::PRINTABLE:
+			return static_cast<char>('!' + random.below('~' - '!' + 1));
+		default:
+			while (true) {
+				char c = static_cast<char>(random.below(256));
+				if (c != ' ' && (c < '\t' || c > '\r')) {
+					return c;
+				}
+			}
+		}
+	}
+
+	// a word count aimed at the edges: none, one, two or three, small, large and the ARRAY capacity
+	std::uint64_t drawWordCount(Random& random) {
+		switch (random.below(10)) {
+		case 0: return 0;
+		case 1: return 1;
+		case 2: return 2 + random.below(2);
+		case 3: case 4: case 5: return random.below(50);
+		case 6: case 7: case 8: return random.below(3000);
+		default: return ARRAY_CAPACITY - random.below(2);
+		}
+	}
+
+	// one random input
+	Case generate(Random& random) {
+		Case generated;
+		std::uint64_t words = drawWordCount(random);
+		Alphabet alphabet = static_cast<Alphabet>(random.below(3));
+
+		// long words make large reports, so only short inputs get them
+		bool longWords = words < 50 && random.percent(10);
+
+		if (random.percent(25)) {
+			generated.text += SEPARATORS[random.below(sizeof(SEPARATORS) - 1)];
+		}
+
+		for (std::uint64_t w = 0; w < words; w++) {
+			if (w > 0) {
+				std::uint64_t run = 1 + (random.percent(20) ? random.below(4) : 0);
+				for (std::uint64_t i = 0; i < run; i++) {
+					generated.text += SEPARATORS[random.below(sizeof(SEPARATORS) - 1)];
+				}
+			}
+
+			std::uint64_t length = longWords && random.percent(20) ? 65536 + random.below(4096) : 1 + random.below(12);
+			for (std::uint64_t i = 0; i < length; i++) {
+				char c = drawCharacter(random, alphabet);
+				generated.hasNull = generated.hasNull || c == '\0';
+				generated.text += c;
+			}
+		}
+
+		if (random.percent(50)) {
+			generated.text += '\n';
+		}
+
+		// a gzip or zstd magic number would be read as compressed input
+		unsigned char first = generated.text.empty() ? 0 : static_cast<unsigned char>(generated.text[0]);
+		if (first == 0x1f || first == 0x28) {
+			generated.text.insert(generated.text.begin(), '\n');
+		}
+		return generated;
+	}
+
+	// write text to path
+	bool writeFile(const std::string& path, const std::string& text) {
+		std::ofstream file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(text.data(), static_cast<std::streamsize>(text.size()));
+		return static_cast<bool>(file);
+	}
+
+	// run program, keeping its report
+	Report runProgram(const std::vector<std::string>& arguments, const std::string& inputPath,
+		const Process::Environment& environment = Process::Environment()) {
+
+		Report report;
+		report.result = Process::run(arguments, inputPath, environment,
+			[&report](const char* data, size_t size) {
+				report.output.append(data, size);
+			}, true);
+		return report;
+	}
+
+	// the arguments of an option set, separated by spaces
+	std::vector<std::string> splitArguments(const std::string& text) {
+		std::vector<std::string> arguments;
+		size_t start = 0;
+		while (start < text.size()) {
+			size_t end = text.find(' ', start);
+			if (end == std::string::npos) {
+				end = text.size();
+			}
+			if (end > start) {
+				arguments.push_back(text.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		return arguments;
+	}
+
+	// run program with an option set on the input, the file it writes to outputPath appended to its report
+	Report runWithOptions(const std::string& program, const std::vector<std::string>& options,
+		const std::string& inputPath, const std::string& outputPath) {
+
+		std::vector<std::string> arguments = { program };
+		bool writesOutput = false;
+		for (std::string option : options) {
+			size_t placeholder = option.find(OUTPUT_PLACEHOLDER);
+			if (placeholder != std::string::npos) {
+				option.replace(placeholder, OUTPUT_PLACEHOLDER.size(), outputPath);
+				writesOutput = true;
+			}
+			arguments.push_back(option);
+		}
+		arguments.push_back(inputPath);
+
+		unlink(outputPath.c_str());
+		Report report = runProgram(arguments, "");
+		if (writesOutput && report.result.ok) {
+			std::ifstream output(outputPath.c_str(), std::ios::in | std::ios::binary);
+			report.output.append(std::istreambuf_iterator<char>(output), std::istreambuf_iterator<char>());
+		}
+		unlink(outputPath.c_str());
+		return report;
+	}
+
+	// the sections of a report, separated by blank lines, each starting with its title
+	std::vector<std::string> splitSections(const std::string& report) {
+		std::vector<std::string> sections;
+		size_t start = 0;
+		while (start < report.size()) {
+			size_t end = report.find("\n\n", start);
+			if (end == std::string::npos) {
+				end = report.size();
+			}
+			sections.push_back(report.substr(start, end + 1 - start));
+			start = end + 2;
+		}
+		return sections;
+	}
+
+	// title of a section, its first line
+	std::string title(const std::string& section) {
+		return section.substr(0, section.find('\n'));
+	}
+
+	// where two sections first differ, as a line number within the section
+	size_t firstDifferentLine(const std::string& expected, const std::string& actual) {
+		size_t line = 1;
+		for (size_t i = 0; i < expected.size() && i < actual.size() && expected[i] == actual[i]; i++) {
+			if (expected[i] == '\n') {
+				line++;
+			}
+		}
+		return line;
+	}
+
+	// describes the first difference between two reports, empty if they match
+	std::string compareReports(const std::string& expected, const std::string& actual, bool skipOriginalSections) {
+		std::vector<std::string> expectedSections = splitSections(expected);
+		std::vector<std::string> actualSections = splitSections(actual);
+
+		for (size_t s = 0; s < expectedSections.size() && s < actualSections.size(); s++) {
+			const std::string& section = expectedSections[s];
+			if (section == actualSections[s]) {
+				continue;
+			}
+
+			bool skipped = false;
+			for (const char* name : ORIGINAL_DIFFERS) {
+				skipped = skipped || (skipOriginalSections && title(section) == name && title(actualSections[s]) == name);
+			}
+			if (!skipped) {
+				return "section \"" + title(section) + "\" line "
+					+ std::to_string(firstDifferentLine(section, actualSections[s]));
+			}
+		}
+
+		if (expectedSections.size() != actualSections.size()) {
+			return std::to_string(actualSections.size()) + " sections, expected " + std::to_string(expectedSections.size());
+		}
+		return "";
+	}
+
+	// final path component
+	std::string baseName(const std::string& path) {
+		size_t slash = path.find_last_of('/');
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+
+	// print usage to the error stream
+	void usage(const char* program) {
+		std::cerr << "usage: " << program << " [--iterations N] [--seed S] [--failures DIR] [--original HW1] [--check CHECK]..." << std::endl
+			<< "       [--options \"OPTIONS\"]... reference program..." << std::endl
+			<< "Runs every program on N random inputs (100) and checks that each report matches the reference's." << std::endl
+			<< "--failures saves each failing input to DIR, --original also compares HW1, reading standard input." << std::endl
+			<< "--check runs CHECK on the path of each input too, it passes when it exits with status 0." << std::endl
+			<< "--options gives a set of options, separated by spaces, each input is also run with one of the sets" << std::endl
+			<< "in turn. " << OUTPUT_PLACEHOLDER << " in an option is a file the program writes, compared after its report." << std::endl
+			<< "HW1 is not given inputs holding null bytes: a word starting with one is an empty C-string, which" << std::endl
+			<< "HW1 prints as a blank line and HW1_3 leaves out." << std::endl;
+	}
+
+} // end anonymous namespace
+
+// main entry point
+int main(int argc, char* argv[]) {
+	std::uint64_t iterations = 100;
+	std::uint64_t seed = 1;
+	std::string failures;
+	std::string original;
+	std::vector<std::string> checks;
+	std::vector<std::vector<std::string> > optionSets;
+	std::vector<std::string> programs;
+
+	// parse arguments
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--iterations" && hasValue) {
+			iterations = std::strtoull(argv[++i], NULL, 10);
+		}
+		else if (arg == "--seed" && hasValue) {
+			seed = std::strtoull(argv[++i], NULL, 10);
+		}
+		else if (arg == "--failures" && hasValue) {
+			failures = argv[++i];
+		}
+		else if (arg == "--original" && hasValue) {
+			original = argv[++i];
+		}
+		else if (arg == "--check" && hasValue) {
+			checks.push_back(argv[++i]);
+		}
+		else if (arg == "--options" && hasValue) {
+			optionSets.push_back(splitArguments(argv[++i]));
+		}
+		else if (arg.size() > 1 && arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		}
+		else {
+			programs.push_back(arg);
+		}
+	}
+
+	if (programs.empty()) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!failures.empty()) {
+		mkdir(failures.c_str(), 0755);
+	}
+
+	std::string inputPath = "/tmp/filefactory-differential-" + std::to_string(getpid()) + ".txt";
+	std::string outputPath = "/tmp/filefactory-differential-" + std::to_string(getpid()) + ".out";
+	Random random(seed);
+	std::uint64_t failed = 0;
+
+	for (std::uint64_t iteration = 0; iteration < iterations; iteration++) {
+		Case input = generate(random);
+		if (!writeFile(inputPath, input.text)) {
+			std::cerr << "Unable to write " << inputPath << std::endl;
+			return 1;
+		}
+
+		std::vector<std::string> problems;
+		Report reference = runProgram({ programs[0], inputPath }, "");
+		if (!reference.result.ok) {
+			problems.push_back(baseName(programs[0]) + ": " + reference.result.failure);
+		}
+
+		for (size_t p = 1; p < programs.size() && reference.result.ok; p++) {
+			Report report = runProgram({ programs[p], inputPath }, "");
+			std::string difference = report.result.ok ? compareReports(reference.output, report.output, false)
+				: report.result.failure;
+			if (!difference.empty()) {
+				problems.push_back(baseName(programs[p]) + ": " + difference);
+			}
+		}
+
+		if (!original.empty() && !input.hasNull && reference.result.ok) {
+			// HW1 never frees the words of its C-string array, which a sanitizer build would report
+			Report report = runProgram({ original }, inputPath, { std::make_pair("ASAN_OPTIONS", "detect_leaks=0") });
+			std::string difference = report.result.ok ? compareReports(reference.output, report.output, true)
+				: report.result.failure;
+			if (!difference.empty()) {
+				problems.push_back(baseName(original) + ": " + difference);
+			}
+		}
+
+		for (const std::string& check : checks) {
+			Report report = runProgram({ check, inputPath }, "");
+			if (!report.result.ok) {
+				// a check prints what it found first, on its first line
+				std::string found = report.output.substr(0, report.output.find('\n'));
+				problems.push_back(baseName(check) + ": " + (found.empty() ? report.result.failure : found));
+			}
+		}
+
+		if (!optionSets.empty()) {
+			// the option set of this input, in turn, compared with the reference's report with the same options
+			const std::vector<std::string>& options = optionSets[iteration % optionSets.size()];
+			std::string named;
+			for (const std::string& option : options) {
+				named += " " + option;
+			}
+
+			Report optionReference = runWithOptions(programs[0], options, inputPath, outputPath);
+			if (!optionReference.result.ok) {
+				problems.push_back(baseName(programs[0]) + named + ": " + optionReference.result.failure);
+			}
+
+			for (size_t p = 1; p < programs.size() && optionReference.result.ok; p++) {
+				Report report = runWithOptions(programs[p], options, inputPath, outputPath);
+				std::string difference = report.result.ok ? compareReports(optionReference.output, report.output, false)
+					: report.result.failure;
+				if (!difference.empty()) {
+					problems.push_back(baseName(programs[p]) + named + ": " + difference);
+				}
+			}
+		}
+
+		if (problems.empty()) {
+			continue;
+		}
+
+		failed++;
+		std::cout << "case " << iteration << " (" << input.text.size() << " bytes) failed" << std::endl;
+		for (const std::string& problem : problems) {
+			std::cout << "  " << problem << std::endl;
+		}
+
+		if (!failures.empty()) {
+			std::string saved = failures + "/case-" + std::to_string(seed) + "-" + std::to_string(iteration) + ".txt";
+			if (writeFile(saved, input.text)) {
+				std::cout << "  input saved to " << saved << std::endl;
+			}
+		}
+	}
+	unlink(inputPath.c_str());
+
+	std::cout << iterations << " inputs, " << programs.size() + (original.empty() ? 0 : 1) << " programs, "
+		<< checks.size() << " checks, " << optionSets.size() << " option sets, " << (failed == 0 ? "all reports match" : std::to_string(failed) + " FAILED") << std::endl;
+	return failed == 0 ? 0 : 1;
+}
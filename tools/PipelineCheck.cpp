@@ -0,0 +1,184 @@
+/**
+* File:		PipelineCheck.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is a check of the transform pipelines of TransformPipeline.hpp against the FileFactory print
+*			modes they stand for. It reads the input file named on the command line, builds each representation
+*			of it (File, InternedFile, PackedFile and a C-string array), and requires every pipeline to print
+*			exactly what its FileFactory mode prints, and every representation to print the same report as the
+*			File. With C++20, the word generators are checked against the print modes too; below C++20 the build
+*			adds a C++20 copy of the check for them, see pipeline-check-cxx20 in CMakeLists.txt. It is built once
+*			per backend, and the differential tester runs it on every input it generates, see --check. Each
+*			mismatch is printed, the exit status is 0 only if everything matched.
+*/
+
+// includes
+#include "FileFactory.hpp"
+#include "TransformPipeline.hpp"
+#include "FileReport.hpp"
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// the C++20 build of the check exists to test the generators, it must not quietly skip them
+#if defined(FILEFACTORY_CHECK_GENERATORS) && !defined(FILEFACTORY_HAVE_COROUTINES)
+#error "FILEFACTORY_CHECK_GENERATORS needs C++20 coroutines"
+#endif
+
+namespace {
+
+	// mismatches found
+	int mismatches = 0;
+
+	// print a mismatch, naming the representation and the mode
+	void compare(const std::string& representation, const std::string& mode, const std::string& expected,
+		const std::string& actual) {
+
+		if (expected == actual) {
+			return;
+		}
+
+		size_t line = 1;
+		for (size_t i = 0; i < expected.size() && i < actual.size() && expected[i] == actual[i]; i++) {
+			if (expected[i] == '\n') {
+				line++;
+			}
+		}
+
+		std::cout << FileFactory::containerName() << " " << representation << " " << mode << ": differs at line "
+			<< line << std::endl;
+		mismatches++;
+	}
+
+	// compare the four modes of a File, InternedFile or PackedFile with their pipelines
+	template <class Words>
+	void compareModes(const std::string& representation, const Words& words) {
+		std::ostringstream expected;
+		std::ostringstream actual;
+
+		FileFactory::printFileConst(words, expected, FileFactory::PrintDirection::FORWARD);
+		ForwardPipeline::run(words, actual);
+		compare(representation, "forward", expected.str(), actual.str());
+
+		expected.str("");
+		actual.str("");
+		FileFactory::printFileConst(words, expected, FileFactory::PrintDirection::BACKWARD);
+		BackwardPipeline::run(words, actual);
+		compare(representation, "backward", expected.str(), actual.str());
+
+		expected.str("");
+		actual.str("");
+		FileFactory::printOddWordsReverse(words, expected);
+		OddWordsReversePipeline::run(words, actual);
+		compare(representation, "odd words reversed", expected.str(), actual.str());
+
+		expected.str("");
+		actual.str("");
+		FileFactory::printAlternatingWords(words, expected);
+		AlternatingWordsPipeline::run(words, actual);
+		compare(representation, "alternating words", expected.str(), actual.str());
+	}
+
+#ifdef FILEFACTORY_HAVE_COROUTINES
+	// the words a generator yields, one to a line as the print modes print them
+	std::string printGenerated(Generator<std::string> words) {
+		std::string printed;
+		for (const std::string& word : words) {
+			printed += word;
+			printed += '\n';
+		}
+		return printed;
+	}
+
+	// compare the generators of a File with the print modes they follow
+	void compareGenerators(const File& file, std::istream& input) {
+		std::ostringstream expected;
+
+		FileFactory::printFileConst(file, expected, FileFactory::PrintDirection::FORWARD);
+		compare("File", "forward generator", expected.str(), printGenerated(FileFactory::generateForward(file)));
+		compare("stream", "word generator", expected.str(), printGenerated(FileFactory::generateWords(input)));
+
+		expected.str("");
+		FileFactory::printFileConst(file, expected, FileFactory::PrintDirection::BACKWARD);
+		compare("File", "backward generator", expected.str(), printGenerated(FileFactory::generateBackward(file)));
+
+		expected.str("");
+		FileFactory::printOddWordsReverse(file, expected);
+		compare("File", "odd words reversed generator", expected.str(),
+			printGenerated(FileFactory::generateOddWordsReverse(file)));
+
+		expected.str("");
+		FileFactory::printAlternatingWords(file, expected);
+		compare("File", "alternating words generator", expected.str(),
+			printGenerated(FileFactory::generateAlternatingWords(file)));
+	}
+#endif
+
+} // end anonymous namespace
+
+// main entry point
+int main(int argc, char* argv[]) {
+	if (argc != 2) {
+		std::cerr << "usage: " << argv[0] << " input-file" << std::endl
+			<< "Checks that every transform pipeline prints what its FileFactory mode prints, on every representation." << std::endl;
+		return 1;
+	}
+
+	try {
+		std::ifstream infile(argv[1], std::ios::in | std::ios::binary);
+		if (!infile) {
+			std::cerr << "Unable to open " << argv[1] << std::endl;
+			return 1;
+		}
+
+		File file = FileFactory::readFileFromStream(infile);
+		InternedFile interned = FileFactory::intern(file);
+		PackedFile packed = FileFactory::pack(file);
+		compareModes("File", file);
+		compareModes("InternedFile", interned);
+		compareModes("PackedFile", packed);
+
+		// every representation prints the report of the File
+		std::ostringstream report;
+		std::ostringstream layoutReport;
+		FileReport::write(file, report);
+		FileReport::write(interned, layoutReport);
+		compare("InternedFile", "report", report.str(), layoutReport.str());
+
+		layoutReport.str("");
+		FileReport::write(packed, layoutReport);
+		compare("PackedFile", "report", report.str(), layoutReport.str());
+
+#ifdef FILEFACTORY_HAVE_COROUTINES
+		infile.clear();
+		infile.seekg(0, std::ios::beg);
+		compareGenerators(file, infile);
+#endif
+
+		// C-string arrays print forward and backward only
+		size_t size;
+		char** fileArray = FileFactory::toCStringArray(file, size);
+		std::ostringstream expected;
+		std::ostringstream actual;
+
+		FileFactory::printArrayConst(fileArray, size, expected, FileFactory::PrintDirection::FORWARD);
+		ForwardPipeline::run(fileArray, size, actual);
+		compare("C-string array", "forward", expected.str(), actual.str());
+
+		expected.str("");
+		actual.str("");
+		FileFactory::printArrayConst(fileArray, size, expected, FileFactory::PrintDirection::BACKWARD);
+		BackwardPipeline::run(fileArray, size, actual);
+		compare("C-string array", "backward", expected.str(), actual.str());
+
+		FileFactory::freeCStringArray(fileArray, size);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return mismatches == 0 ? 0 : 1;
+}
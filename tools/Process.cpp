@@ -0,0 +1,128 @@
+/**
+* File:		Process.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the implementation of the Process class.
+*/
+
+// includes
+#include "Process.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// run arguments[0] with the arguments, standard input from inputPath (inherited when empty)
+Process::Result Process::run(const std::vector<std::string>& arguments, const std::string& inputPath,
+	const Environment& environment, const OutputHandler& output, bool discardErrors) {
+
+	Result result;
+	if (arguments.empty()) {
+		result.failure = "no program";
+		return result;
+	}
+
+	// everything the child needs is prepared before the fork
+	std::vector<char*> argv;
+	for (const std::string& argument : arguments) {
+		argv.push_back(const_cast<char*>(argument.c_str()));
+	}
+	argv.push_back(nullptr);
+
+	int pipes[2];
+	if (pipe(pipes) != 0) {
+		result.failure = "pipe failed";
+		return result;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pid_t child = fork();
+
+	if (child == 0) {
+		dup2(pipes[1], STDOUT_FILENO);
+		close(pipes[0]);
+		close(pipes[1]);
+
+		if (!inputPath.empty()) {
+			int input = open(inputPath.c_str(), O_RDONLY);
+			if (input < 0) {
+				_exit(126);
+			}
+			dup2(input, STDIN_FILENO);
+			close(input);
+		}
+
+		if (discardErrors) {
+			int null = open("/dev/null", O_WRONLY);
+			if (null >= 0) {
+				dup2(null, STDERR_FILENO);
+				close(null);
+			}
+		}
+
+		for (const std::pair<std::string, std::string>& variable : environment) {
+			setenv(variable.first.c_str(), variable.second.c_str(), 1);
+		}
+
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+	close(pipes[1]);
+
+	if (child < 0) {
+		close(pipes[0]);
+		result.failure = "fork failed";
+		return result;
+	}
+
+	// hand the output over as it arrives
+	std::vector<char> buffer(1 << 16);
+	ssize_t count;
+	while ((count = read(pipes[0], buffer.data(), buffer.size())) != 0) {
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (output) {
+			output(buffer.data(), static_cast<size_t>(count));
+		}
+		result.outputBytes += static_cast<std::uint64_t>(count);
+	}
+	close(pipes[0]);
+
+	int status = 0;
+	struct rusage usage;
+	while (wait4(child, &status, 0, &usage) < 0 && errno == EINTR) {
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	result.cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+		+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#ifdef __APPLE__
+	result.peakBytes = static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+	result.peakBytes = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+
+	if (WIFSIGNALED(status)) {
+		result.failure = std::string("killed by ") + strsignal(WTERMSIG(status));
+	}
+	else if (WEXITSTATUS(status) == 127) {
+		result.failure = "unable to run " + arguments[0];
+	}
+	else if (WEXITSTATUS(status) != 0) {
+		result.failure = "exit status " + std::to_string(WEXITSTATUS(status));
+	}
+	else {
+		result.ok = true;
+	}
+	return result;
+}
@@ -0,0 +1,51 @@
+/**
+* File:		Process.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the definition of a Process class, which runs a program for the tools and hands its
+*			standard output over as it arrives, then reports how the program ended and what it used. The tools
+*			run the FileFactory programs many times over, so the output is never gathered unless the caller does.
+*
+*			POSIX only: programs are run with fork and exec, and measured with wait4.
+*/
+
+#ifndef PROCESS_HPP
+#define PROCESS_HPP
+
+// includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// class definition
+class Process {
+public:
+	// how a run ended, failure is empty when ok
+	struct Result {
+		bool ok = false;
+		std::string failure;
+		double seconds = 0;
+		double cpuSeconds = 0;
+		std::uint64_t peakBytes = 0;
+		std::uint64_t outputBytes = 0;
+	};
+
+	// receives standard output, a block at a time
+	typedef std::function<void(const char*, size_t)> OutputHandler;
+
+	// extra environment variables, name and value
+	typedef std::vector<std::pair<std::string, std::string>> Environment;
+
+	// run arguments[0] with the arguments, standard input from inputPath (inherited when empty)
+	static Result run(const std::vector<std::string>& arguments, const std::string& inputPath,
+		const Environment& environment, const OutputHandler& output, bool discardErrors = false);
+
+private:
+	// not constructed
+	Process();
+}; // end class Process
+
+#endif
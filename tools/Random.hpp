@@ -0,0 +1,45 @@
+/**
+* File:		Random.hpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is the definition of a Random class, the splitmix64 generator shared by the tools. Its draws
+*			are plain integer arithmetic, so unlike the standard library's distributions they are the same with
+*			every compiler, and a seed always reproduces the same input.
+*/
+
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+// includes
+#include <cstdint>
+
+// class definition
+class Random {
+public:
+	// constructor
+	explicit Random(std::uint64_t seed) : m_state(seed) {
+	}
+
+	// next 64 random bits
+	std::uint64_t next() {
+		std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	// uniform in [0, bound)
+	std::uint64_t below(std::uint64_t bound) {
+		return bound > 0 ? next() % bound : 0;
+	}
+
+	// true with the given chance in percent
+	bool percent(std::uint32_t chance) {
+		return below(100) < chance;
+	}
+
+private:
+	std::uint64_t m_state;
+}; // end class Random
+
+#endif
@@ -0,0 +1,285 @@
+/**
+* File:		Throughput.cpp
+* Author:	Ryan Johnson
+* Email:	johnsonrw82@cs.fullerton.edu
+* Purpose:	This file is an end-to-end throughput harness for the FileFactory programs. Each program is run on the
+*			same input several times, printing its full report, and the harness records the best wall time, input
+*			MB/s and words/s, CPU time, peak resident memory and, with the allocation counter preloaded in one
+*			extra run, the number of heap allocations. The reports are hashed as they are read, and every
+*			program's report must be byte-identical to the first program's, so a performance change that breaks
+*			one backend shows up here too. The exit status is 0 only if every program ran and every report matched.
+*			With --profile, each program is run once more with its own --profile option, which prints the hardware
+*			counters of each phase (reading, and each section of the report) after the table, one table per backend.
+*
+*			POSIX only: programs are run by the Process class.
+*/
+
+// includes
+#include "Process.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+	// one run of a program
+	struct Run {
+		bool ok = false;
+		std::string failure;
+		double seconds = 0;
+		double cpuSeconds = 0;
+		std::uint64_t peakBytes = 0;
+		std::uint64_t outputBytes = 0;
+		std::uint64_t outputHash = 0;
+	};
+
+	// best of the runs of a program
+	struct Result {
+		std::string program;
+		Run best;
+		long long allocations = -1;
+		bool matches = true;
+	};
+
+	// FNV-1a, enough to tell reports apart
+	const std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+	const std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+	// words of the input, counted with the tokenizer's delimiters
+	std::uint64_t countWords(const std::string& path, std::uint64_t& bytes) {
+		std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+		if (!input) {
+			throw std::runtime_error("Unable to open " + path);
+		}
+
+		std::vector<char> buffer(1 << 16);
+		std::uint64_t words = 0;
+		bool inWord = false;
+		bytes = 0;
+
+		while (input) {
+			input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			std::streamsize count = input.gcount();
+			for (std::streamsize i = 0; i < count; i++) {
+				char c = buffer[static_cast<size_t>(i)];
+				bool delimiter = c == ' ' || (c >= '\t' && c <= '\r');
+				if (!delimiter && !inWord) {
+					words++;
+				}
+				inWord = !delimiter;
+			}
+			bytes += static_cast<std::uint64_t>(count);
+		}
+		return words;
+	}
+
+	// run program on the input, hashing its output, allocationLog set means preload the counter
+	Run runProgram(const std::string& program, const std::string& input,
+		const std::string& counter, const std::string& allocationLog) {
+
+		Process::Environment environment;
+		if (!allocationLog.empty()) {
+			environment.push_back(std::make_pair("LD_PRELOAD", counter));
+			environment.push_back(std::make_pair("DYLD_INSERT_LIBRARIES", counter));
+			environment.push_back(std::make_pair("DYLD_FORCE_FLAT_NAMESPACE", "1"));
+			environment.push_back(std::make_pair("FILEFACTORY_ALLOCATION_LOG", allocationLog));
+		}
+
+		// hash the report as it arrives
+		std::uint64_t hash = FNV_OFFSET;
+		Process::Result result = Process::run({ program, input }, "", environment,
+			[&hash](const char* data, size_t size) {
+				for (size_t i = 0; i < size; i++) {
+					hash = (hash ^ static_cast<unsigned char>(data[i])) * FNV_PRIME;
+				}
+			});
+
+		Run run;
+		run.ok = result.ok;
+		run.failure = result.failure;
+		run.seconds = result.seconds;
+		run.cpuSeconds = result.cpuSeconds;
+		run.peakBytes = result.peakBytes;
+		run.outputBytes = result.outputBytes;
+		run.outputHash = hash;
+		return run;
+	}
+
+	// the allocation count written by the counter, -1 if there is none
+	long long readAllocations(const std::string& path) {
+		std::ifstream log(path.c_str());
+		std::string name;
+		long long value;
+		while (log >> name >> value) {
+			if (name == "allocations") {
+				return value;
+			}
+		}
+		return -1;
+	}
+
+	// final path component
+	std::string baseName(const std::string& path) {
+		size_t slash = path.find_last_of('/');
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+
+	// print usage to the error stream
+	void usage(const char* program) {
+		std::cerr << "usage: " << program << " [--runs N] [--allocation-counter library] [--profile] input program..." << std::endl
+			<< "Runs each program on input, best of N runs (3), and checks that every report matches the first." << std::endl
+			<< "--allocation-counter preloads the library built from AllocationCounter.cpp for one more run." << std::endl
+			<< "--profile runs each program once more with --profile, printing its hardware counters per phase." << std::endl;
+	}
+
+} // end anonymous namespace
+
+// main entry point
+int main(int argc, char* argv[]) {
+	int runs = 3;
+	bool profile = false;
+	std::string counter;
+	std::vector<std::string> arguments;
+
+	// parse arguments
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--runs" && i + 1 < argc) {
+			runs = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--allocation-counter" && i + 1 < argc) {
+			counter = argv[++i];
+		}
+		else if (arg == "--profile") {
+			profile = true;
+		}
+		else if (arg.size() > 1 && arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		}
+		else {
+			arguments.push_back(arg);
+		}
+	}
+
+	if (arguments.size() < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::string input = arguments[0];
+	std::uint64_t inputBytes;
+	std::uint64_t words;
+	try {
+		words = countWords(input, inputBytes);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << "input " << input << ": " << std::fixed << std::setprecision(2)
+		<< inputBytes / 1e6 << " MB, " << words << " words, best of " << runs << " runs" << std::endl << std::endl;
+
+	std::vector<Result> results;
+	std::string allocationLog = "/tmp/filefactory-allocations-" + std::to_string(getpid());
+	bool passed = true;
+
+	for (size_t p = 1; p < arguments.size(); p++) {
+		Result result;
+		result.program = arguments[p];
+
+		for (int r = 0; r < runs; r++) {
+			Run run = runProgram(result.program, input, counter, "");
+			if (!run.ok) {
+				result.best = run;
+				break;
+			}
+			if (r == 0 || run.seconds < result.best.seconds) {
+				result.best = run;
+			}
+		}
+
+		if (result.best.ok && !counter.empty()) {
+			if (runProgram(result.program, input, counter, allocationLog).ok) {
+				result.allocations = readAllocations(allocationLog);
+			}
+			unlink(allocationLog.c_str());
+		}
+
+		// reports are compared with the first program that ran
+		for (const Result& earlier : results) {
+			if (earlier.best.ok && result.best.ok) {
+				result.matches = earlier.best.outputHash == result.best.outputHash
+					&& earlier.best.outputBytes == result.best.outputBytes;
+				break;
+			}
+		}
+
+		passed = passed && result.best.ok && result.matches;
+		results.push_back(result);
+	}
+
+	// results table
+	std::cout << std::left << std::setw(24) << "program" << std::right
+		<< std::setw(10) << "wall s" << std::setw(10) << "cpu s" << std::setw(10) << "MB/s"
+		<< std::setw(12) << "Mwords/s" << std::setw(12) << "peak MB" << std::setw(14) << "allocations"
+		<< std::setw(12) << "report MB" << "  report" << std::endl;
+
+	for (const Result& result : results) {
+		std::cout << std::left << std::setw(24) << baseName(result.program) << std::right;
+
+		if (!result.best.ok) {
+			std::cout << "  FAILED: " << result.best.failure << std::endl;
+			continue;
+		}
+
+		const Run& run = result.best;
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(10) << run.seconds
+			<< std::setw(10) << run.cpuSeconds
+			<< std::setprecision(1) << std::setw(10) << inputBytes / 1e6 / run.seconds
+			<< std::setprecision(2) << std::setw(12) << words / 1e6 / run.seconds
+			<< std::setprecision(1) << std::setw(12) << run.peakBytes / 1e6;
+
+		if (result.allocations >= 0) {
+			std::cout << std::setw(14) << result.allocations;
+		}
+		else {
+			std::cout << std::setw(14) << "-";
+		}
+
+		std::cout << std::setprecision(2) << std::setw(12) << run.outputBytes / 1e6
+			<< "  " << std::hex << std::setw(16) << std::setfill('0') << run.outputHash
+			<< std::dec << std::setfill(' ') << (result.matches ? "" : "  DIFFERS") << std::endl;
+	}
+
+	// the programs print their counters on their error stream, which is ours
+	for (size_t p = 0; profile && p < results.size(); p++) {
+		if (!results[p].best.ok) {
+			continue;
+		}
+
+		std::cout << std::endl;
+		std::cout.flush();
+		Process::Result result = Process::run({ results[p].program, "--profile", input }, "", Process::Environment(),
+			[](const char*, size_t) {
+			});
+		if (!result.ok) {
+			std::cout << baseName(results[p].program) << " --profile: " << result.failure << std::endl;
+		}
+	}
+
+	std::cout << std::endl << (passed ? "all reports match" : "FAILED") << std::endl;
+	return passed ? 0 : 1;
+}